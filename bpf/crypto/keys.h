@@ -10,9 +10,15 @@
 #include "srh.h"
 #include "tlv.h"
 #include "sid.h"
+#include "pot/latency.h"
 
 #define SEG6_KEY_LEN 32
+#if POT_CSID
+#define SEG6_MAX_KEYS 16 // C-SIDs of a path, see csid.h
+#else
 #define SEG6_MAX_KEYS SRH_MAX_ALLOWED_SEGMENTS
+#endif
+#define SEG6_MAX_TENANT_IFACES 4096
 
 struct pot_sid_key {
     __u8 key[SEG6_KEY_LEN];
@@ -26,86 +32,108 @@ struct {
     __uint(pinning, LIBBPF_PIN_BY_NAME);
 } seg6_pot_keys SEC(".maps");
 
-static __always_inline int compute_witness(struct in6_addr *ip6, struct pot_tlv *tlv)
-{
-    struct pot_sid_key *pot_sid_key = bpf_map_lookup_elem(&seg6_pot_keys, ip6->s6_addr);
-    if (!pot_sid_key) {
-        bpf_printk("[seg6_pot_tlv][-] Cannot retrieve key for SID %pI6", ip6->s6_addr);
-        return -1;
-    }
-
-    bpf_printk("[seg6_pot_tlv][*] Computing keyed-hash for SID %pI6", ip6->s6_addr);
-    compute_tlv(tlv, pot_sid_key->key);
+/*
+    The key set in use, seg6_pot_keys until seg6-pot-tlv --daemon swaps in a
+    new map holding a whole batch of updates. One lookup per packet pins the
+    set, so a packet never mixes keys of two batches.
+*/
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY_OF_MAPS);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+    __array(values, struct {
+        __uint(type, BPF_MAP_TYPE_HASH);
+        __uint(key_size, sizeof(struct in6_addr));
+        __uint(value_size, sizeof(struct pot_sid_key));
+        __uint(max_entries, SEG6_MAX_KEYS);
+    });
+} seg6_pot_keyset SEC(".maps") = {
+    .values = {[0] = (void *)&seg6_pot_keys},
+};
 
-    bpf_printk("[seg6_pot_tlv][*] keyed-hash calculated for witness");
-    return 0;
+/*
+    Key sets of the tenants by interface, set by seg6-pot-tlv --tenant. Each
+    tenant is its own map, sized on its own and swapped at once on every
+    interface it's bound to. Interfaces without a tenant use seg6_pot_keyset.
+    Ifindexes are namespace local, a tenant is bound in one namespace only.
+*/
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH_OF_MAPS);
+    __uint(max_entries, SEG6_MAX_TENANT_IFACES);
+    __type(key, __u32);
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+    __array(values, struct {
+        __uint(type, BPF_MAP_TYPE_HASH);
+        __uint(key_size, sizeof(struct in6_addr));
+        __uint(value_size, sizeof(struct pot_sid_key));
+        __uint(max_entries, SEG6_MAX_KEYS);
+    });
+} seg6_pot_tenants SEC(".maps");
+
+/* The tenant of the interface costs one lookup more than the default set, only when it has none */
+static __always_inline void *pot_keys_active(__u32 ifindex)
+{
+    void *keys = bpf_map_lookup_elem(&seg6_pot_tenants, &ifindex);
+    if (keys)
+        return keys;
+
+    __u32 zero = 0;
+    keys = bpf_map_lookup_elem(&seg6_pot_keyset, &zero);
+    if (!keys)
+        bpf_printk("[seg6_pot_tlv][-] No key set in use");
+    return keys;
 }
 
-#if ISADDR
-static __always_inline int compute_first_witness(struct ipv6hdr *ipv6, struct pot_tlv *tlv)
+static __always_inline void hash_witness(struct pot_tlv *tlv, const __u8 key[SEG6_KEY_LEN], __u32 lat_path)
 {
-    struct in6_addr sid;
-    __builtin_memcpy(&sid, &ipv6->saddr.in6_u, IPV6_LEN);
-
-    return compute_witness(&sid, tlv);
+    POT_LAT_START(hash_start);
+    compute_tlv(tlv, key);
+    POT_LAT_RECORD(lat_path, POT_LAT_HASH, hash_start);
 }
-#endif
 
-static __always_inline int compute_witness_once(struct pot_tlv *tlv, struct srh *srh, void *end)
+static __always_inline int compute_witness(struct in6_addr *ip6, __u32 ifindex, struct pot_tlv *tlv, __u32 lat_path)
 {
-    __u32 segment_size = srh_hdr_len(srh) / IPV6_LEN;
-    if ((void *)((__u8 *)srh + SRH_FIXED_HDR_LEN + (IPV6_LEN * segment_size)) > end) {
-        bpf_printk("[seg6_pot_tlv][-] SRH segments out-of-bounds");
-        return -1;
-    }
-
-    __u32 idx = srh->last_entry - srh->segments_left;
-    idx = srh->last_entry - idx;
-    if (idx < 0 || idx > segment_size)
+    POT_LAT_START(lookup_start);
+    void *keys = pot_keys_active(ifindex);
+    if (!keys)
         return -1;
 
-    __u32 segment_offset = SRH_FIXED_HDR_LEN + (IPV6_LEN * idx);
-    if ((void *)((__u8 *)srh + segment_offset + IPV6_LEN) > end) {
-        bpf_printk("[seg6_pot_tlv][-] SID %u extends beyond packet", idx);
+    struct pot_sid_key *pot_sid_key = bpf_map_lookup_elem(keys, ip6->s6_addr);
+    if (!pot_sid_key) {
+        bpf_printk("[seg6_pot_tlv][-] Cannot retrieve key for SID %pI6", ip6->s6_addr);
         return -1;
     }
+    POT_LAT_RECORD(lat_path, POT_LAT_KEY_LOOKUP, lookup_start);
 
-    struct in6_addr sid;
-    __builtin_memcpy(&sid, (__u8 *)srh + segment_offset, IPV6_LEN);
+    bpf_printk("[seg6_pot_tlv][*] Computing keyed-hash for SID %pI6", ip6->s6_addr);
+    hash_witness(tlv, pot_sid_key->key, lat_path);
 
-    return compute_witness(&sid, tlv);
+    bpf_printk("[seg6_pot_tlv][*] keyed-hash calculated for witness");
+    return 0;
 }
 
-static __always_inline int chain_keys(struct srh *srh, struct pot_tlv *tlv, void *end)
+/* Copies the key of a SID out of the key set returned by pot_keys_active, so a rotation can't change it halfway through one packet */
+static __always_inline int fetch_key(void *keys, const struct in6_addr *sid, struct pot_sid_key *dst)
 {
-    __u32 segment_size = srh_hdr_len(srh) / IPV6_LEN;
-    if ((void *)((__u8 *)srh + SRH_FIXED_HDR_LEN + (IPV6_LEN * segment_size)) > end) {
-        bpf_printk("[seg6_pot_tlv][-] SRH segments out-of-bounds");
+    struct pot_sid_key *pot_sid_key = bpf_map_lookup_elem(keys, sid->s6_addr);
+    if (!pot_sid_key) {
+        bpf_printk("[seg6_pot_tlv][-] Cannot retrieve key for SID %pI6", sid->s6_addr);
         return -1;
     }
 
-#pragma clang loop unroll(disable)
-    for (__s16 i = SEG6_MAX_KEYS; i >= 0; i--) {
-        if (i < 0) i = 0;
-        if ((__u32)i >= segment_size) continue;
-
-        __u32 segment_offset = SRH_FIXED_HDR_LEN + (IPV6_LEN * (__u32)i);
-        if ((void *)((__u8 *)srh + segment_offset + IPV6_LEN) > end) {
-            bpf_printk("[seg6_pot_tlv][-] SID %u extends beyond packet", i);
-            return -1;
-        }
-
-        struct in6_addr sid;
-        __builtin_memcpy(&sid, (__u8 *)srh + segment_offset, IPV6_LEN);
+    __builtin_memcpy(dst, pot_sid_key, sizeof(*dst));
+    return 0;
+}
 
-        if (compute_witness(&sid, tlv)) {
-            bpf_printk("[seg6_pot_tlv][-] Cannot compute witness for SID %pI6", sid.s6_addr);
-            return -1;
-        }
-    }
+#if ISADDR
+static __always_inline int compute_first_witness(struct ipv6hdr *ipv6, __u32 ifindex, struct pot_tlv *tlv, __u32 lat_path)
+{
+    struct in6_addr sid;
+    __builtin_memcpy(&sid, &ipv6->saddr.in6_u, IPV6_LEN);
 
-    bpf_printk("[seg6_pot_tlv][*] keyed-hash calculated to each SID successfully");
-    return 0;
+    return compute_witness(&sid, ifindex, tlv, lat_path);
 }
+#endif
 
 #endif /* __SEG6_KEYS_H */
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef __SEG6_CSID_H
+#define __SEG6_CSID_H
+
+#include <linux/in6.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+
+#include "hdr.h"
+
+/*
+            RFC 9800 - NEXT-C-SID container, F3216 format
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                     Locator Block (32 bits)                   |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |           C-SID 0             |           C-SID 1             |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |           C-SID 2             |           C-SID 3             |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |           C-SID 4             |           C-SID 5             |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+    Built with CSID=1, every SID of the SRH is a container of C-SIDs in path
+    order, the first zero one ends it. The active C-SID follows the block in
+    the destination address, End shifts the next one in and the last of a
+    container is followed by the next SRH segment. The SID of a node, the one
+    holding its key, is the block and its C-SID padded with zeros.
+*/
+#define CSID_LB_LEN 4 // Locator block length in bytes
+#define CSID_LEN 2 // C-SID length in bytes
+#define CSID_PER_CONTAINER ((IPV6_LEN - CSID_LB_LEN) / CSID_LEN)
+
+static __always_inline int csid_is_zero(const __u8 *csid)
+{
+    __u8 bits = 0;
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < CSID_LEN; i++)
+        bits |= csid[i];
+    return bits == 0;
+}
+
+/* C-SIDs of a container, which must be within the packet */
+static __always_inline __u32 csid_count(const __u8 *container)
+{
+    __u32 count = 0;
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < CSID_PER_CONTAINER; i++) {
+        if (csid_is_zero(container + CSID_LB_LEN + (CSID_LEN * i)))
+            break;
+        count++;
+    }
+    return count;
+}
+
+/* The destination address still carries C-SIDs after the active one */
+static __always_inline int csid_has_next(const struct in6_addr *daddr)
+{
+    return !csid_is_zero(daddr->s6_addr + CSID_LB_LEN + CSID_LEN);
+}
+
+/* SID of the C-SID idx of a container, as configured on its node */
+static __always_inline void csid_sid(const __u8 *container, __u32 idx, struct in6_addr *sid)
+{
+    __builtin_memset(sid, 0, IPV6_LEN);
+    if (idx >= CSID_PER_CONTAINER)
+        return;
+
+    __builtin_memcpy(sid->s6_addr, container, CSID_LB_LEN);
+    __builtin_memcpy(sid->s6_addr + CSID_LB_LEN, container + CSID_LB_LEN + (CSID_LEN * idx), CSID_LEN);
+}
+
+#endif /* __SEG6_CSID_H */
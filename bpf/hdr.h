@@ -16,15 +16,38 @@
 #define HDR_BYTE_SIZE 8
 #define MAX_PAYLOAD_SHIFT_LEN 1500 // TODO RFC2675
 
+#define VLAN_HDR_LEN 4 // 802.1Q/802.1ad tag length
+#define POT_MAX_VLAN_TAGS 2 // QinQ
+#define POT_MAX_EXT_HDRS 2 // Hop-by-Hop and Destination Options before the SRH
+#define POT_MAX_EXT_LEN 64 // Bytes of them accepted in front of the SRH
+
 #define ETH_HDR_OFFSET 0
 #define HDR_ADDING_OFFSET HDR_BYTE_SIZE
+// Untagged packets with the SRH right after the IPv6 header, the fast path offsets
 #define IPV6_HDR_OFFSET ETH_HDR_LEN
-#define SRH_HDR_OFFSET ETH_HDR_LEN + IPV6_HDR_LEN
-#define TLV_MNML_HDR_OFFSET SRH_HDR_OFFSET + SRH_FIXED_HDR_LEN
+#define SRH_HDR_OFFSET (ETH_HDR_LEN + IPV6_HDR_LEN)
+#define TLV_MNML_HDR_OFFSET (SRH_HDR_OFFSET + SRH_FIXED_HDR_LEN)
+
+#define POT_MAX_IPV6_OFFSET (ETH_HDR_LEN + (VLAN_HDR_LEN * POT_MAX_VLAN_TAGS))
+#define POT_MAX_SRH_OFFSET (POT_MAX_IPV6_OFFSET + IPV6_HDR_LEN + POT_MAX_EXT_LEN)
 
 #define ETH_HDR_PTR data
-#define IPV6_HDR_PTR data + IPV6_HDR_OFFSET
-#define SRH_HDR_PTR data + SRH_HDR_OFFSET
+
+/* Offsets from data of the headers of an SRv6 packet, set once by parse_srv6_hdrs */
+struct pot_hdrs {
+    __u32 ip6_offset;
+    __u32 srh_offset;
+};
+
+struct pot_vlan_hdr {
+    __be16 tci;
+    __be16 proto;
+};
+
+static __always_inline int pot_hdrs_fixed(const struct pot_hdrs *hdrs)
+{
+    return hdrs->ip6_offset == IPV6_HDR_OFFSET && hdrs->srh_offset == SRH_HDR_OFFSET;
+}
 
 static __always_inline int eth_hdr_cb(struct ethhdr *eth, void *end)
 {
@@ -40,6 +63,19 @@ static __always_inline int ip6_hdr_cb(struct ipv6hdr *ip6, void *end)
     return 0;
 }
 
+/* The offsets may come from the scratch map, the bound keeps data + offset tracked by the verifier */
+static __always_inline struct ipv6hdr *ip6_hdr_at(void *data, void *end, const struct pot_hdrs *hdrs)
+{
+    __u32 off = hdrs->ip6_offset;
+    if (off > POT_MAX_IPV6_OFFSET)
+        return NULL;
+
+    struct ipv6hdr *ip6 = data + off;
+    if (ip6_hdr_cb(ip6, end) < 0)
+        return NULL;
+    return ip6;
+}
+
 static __always_inline void inc_ip6_hdr_len(struct ipv6hdr *ip6, __u16 len)
 {
     ip6->payload_len = bpf_htons(bpf_ntohs(ip6->payload_len) + len);
@@ -12,27 +12,109 @@
 #include "crypto/keys.h"
 #include "tlv.h"
 #include "hdr.h"
+#include "pot/flow.h"
+#include "pot/hopts.h"
+#include "pot/latency.h"
+#include "pot/vlan.h"
 
-static __always_inline int add_pot_tlv(struct __sk_buff *skb)
+/*
+    GSO packets are segmented after tc egress, so every segment inherits the
+    TLV written here, nonce and witness included: the segments of one GSO
+    packet share its nonce. The witness doesn't cover the payload and still
+    validates per segment.
+
+    The TLV must also fit in each segment. The kernel shrinks gso_size by the
+    TLV length unless BPF_F_ADJ_ROOM_FIXED_GSO is given, which is only safe
+    when a full segment plus the TLV is still below the MTU, e.g. once the MSS
+    was clamped for it.
+*/
+static __always_inline __u64 gso_room_flags(struct __sk_buff *skb, struct ipv6hdr *ipv6, struct srh *srh, void *end)
+{
+    if (skb->gso_size == 0)
+        return 0;
+
+    struct ipv6hdr *inner = (void *)srh + srh_hdr_len(srh);
+    if (srh->next_hdr != POT_INNER_IPV6 || ip6_hdr_cb(inner, end) < 0 || inner->nexthdr != IPPROTO_TCP)
+        return 0;
+
+    struct tcphdr *tcp = (void *)inner + IPV6_HDR_LEN;
+    if ((void *)tcp + sizeof(*tcp) > end)
+        return 0;
+
+    __u32 mtu = 0;
+    if (bpf_check_mtu(skb, 0, &mtu, 0, 0) < 0 || mtu == 0)
+        return 0;
+
+    __u32 segment_len = (__u32)((void *)tcp - (void *)ipv6) + (__u32)tcp->doff * 4 + skb->gso_size;
+    if (segment_len + POT_TLV_WIRE_LEN > mtu)
+        return 0;
+
+    return BPF_F_ADJ_ROOM_FIXED_GSO;
+}
+
+#if POT_FLOWLABEL
+/*
+    Encapsulated flows between two SR nodes only differ after the SRH, which
+    NIC RSS and ECMP don't parse. Writing the inner flow hash into the outer
+    flow label lets every downstream PoT node spread them over its queues.
+*/
+static __always_inline int set_flow_label(struct __sk_buff *skb, const struct pot_hdrs *hdrs, __u32 hash)
+{
+    void *data = (void *)(long)skb->data;
+    void *end = (void *)(long)skb->data_end;
+
+    struct ipv6hdr *ipv6 = ip6_hdr_at(data, end, hdrs);
+    if (!ipv6)
+        return -1;
+
+    // Zero means no flow label, keep the version and traffic class bits
+    __u32 label = hash & 0x000FFFFF;
+    if (label == 0)
+        label = 1;
+
+    __be32 word = (*(__be32 *)ipv6 & bpf_htonl(0xFFF00000)) | bpf_htonl(label);
+
+    // The flow label isn't part of any checksum
+    if (bpf_skb_store_bytes(skb, hdrs->ip6_offset, &word, sizeof(word), 0) < 0)
+        return -1;
+    return 0;
+}
+#endif
+
+/*
+    bpf_skb_adjust_room opens the room right after the IPv6 header, the
+    extension headers in front of the SRH, its fixed header and the SID list
+    are written back there and the TLV goes in the room left after them.
+*/
+static __always_inline int insert_pot_tlv(struct __sk_buff *skb, const struct pot_hdrs *hdrs)
 {
     void *data = (void *)(long)skb->data;
     void *end = (void *)(long)skb->data_end;
 
-    struct ethhdr *eth = ETH_HDR_PTR;
-    struct ipv6hdr *ipv6 = IPV6_HDR_PTR;
-    struct srh *srh = SRH_HDR_PTR;
+    struct ipv6hdr *ipv6;
+    struct srh *srh;
 
-    eth = ETH_HDR_PTR;
-    if (eth_hdr_cb(eth, end) < 0)
+    POT_LAT_START(start);
+
+    ipv6 = ip6_hdr_at(data, end, hdrs);
+    if (!ipv6)
+        return -1;
+
+    srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
         return -1;
 
-    ipv6 = IPV6_HDR_PTR;
-    if (ip6_hdr_cb(ipv6, end) < 0)
+    __u32 ext_offset = hdrs->ip6_offset + IPV6_HDR_LEN;
+    __u32 srh_offset = hdrs->srh_offset;
+    if (srh_offset > POT_MAX_SRH_OFFSET || srh_offset < ext_offset || srh_offset - ext_offset > POT_MAX_EXT_LEN)
         return -1;
 
-    srh = SRH_HDR_PTR;
-    if (srh_hdr_cb(srh, end) < 0)
+    __u32 ext_len = srh_offset - ext_offset;
+    __u8 ext[POT_MAX_EXT_LEN];
+    if (ext_len > 0 && bpf_skb_load_bytes(skb, ext_offset, ext, ext_len) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] bpf_skb_load_bytes failed to read the extension headers");
         return -1;
+    }
 
     __u32 segment_size = calc_segment_size(srh, end);
     if (segment_size == 0) return -1;
@@ -62,13 +144,40 @@ static __always_inline int add_pot_tlv(struct __sk_buff *skb)
         bpf_printk("[seg6_pot_tlv][-] Failed to retrieve SID list");
         return -1;
     }
+#if POT_FLOWLABEL
+    __u32 flow_hash = pot_flow_hash(ipv6, srh, end);
+#endif
+    POT_LAT_RECORD(POT_LAT_ADD, POT_LAT_PARSE, start);
+
+    // The TLV only depends on the source address, build it before the packet is resized
+    struct pot_tlv tlv;
+    init_tlv(&tlv);
+#if POT_HOPTS
+    tlv.hop_ts[0] = pot_hop_now();
+#endif
+
+    __u64 room_flags = gso_room_flags(skb, ipv6, srh, end);
 
-    if (bpf_skb_adjust_room(skb, POT_TLV_WIRE_LEN, BPF_ADJ_ROOM_NET, 0) < 0) {
+#if ISADDR
+    // Forwarded packets take the tenant of the interface they came in from
+    if (compute_first_witness(ipv6, skb->ingress_ifindex, &tlv, POT_LAT_ADD) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to compute the first witness");
+        return -1;
+    }
+#endif
+
+    POT_LAT_START(rewrite_start);
+    if (bpf_skb_adjust_room(skb, POT_TLV_WIRE_LEN, BPF_ADJ_ROOM_NET, room_flags) < 0) {
         bpf_printk("[seg6_pot_tlv][-] Failed to adjust L3 room");
         return -1;
     }
 
-    if (bpf_skb_store_bytes(skb, SRH_HDR_OFFSET, &foresrh, SRH_FIXED_HDR_LEN, BPF_F_RECOMPUTE_CSUM) < 0) {
+    if (ext_len > 0 && bpf_skb_store_bytes(skb, ext_offset, ext, ext_len, 0) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] bpf_skb_store_bytes failed realocate extension headers");
+        return -1;
+    }
+
+    if (bpf_skb_store_bytes(skb, srh_offset, &foresrh, SRH_FIXED_HDR_LEN, BPF_F_RECOMPUTE_CSUM) < 0) {
         bpf_printk("[seg6_pot_tlv][-] bpf_skb_store_bytes failed realocate srh");
         return -1;
     }
@@ -82,7 +191,7 @@ static __always_inline int add_pot_tlv(struct __sk_buff *skb)
             return -1;
         }
 
-		if (bpf_skb_store_bytes(skb, SRH_HDR_OFFSET + segment_offset, &sidlist[i], IPV6_LEN, 0) < 0) {
+		if (bpf_skb_store_bytes(skb, srh_offset + segment_offset, &sidlist[i], IPV6_LEN, 0) < 0) {
             bpf_printk("[seg6_pot_tlv][-] bpf_skb_store_bytes failed realocate sid list");
 			return -1;
 		}
@@ -91,29 +200,11 @@ static __always_inline int add_pot_tlv(struct __sk_buff *skb)
     data = (void *)(long)skb->data;
     end = (void *)(long)skb->data_end;
 
-    eth = ETH_HDR_PTR;
-    if (eth_hdr_cb(eth, end) < 0)
-        return -1;
-
-    ipv6 = IPV6_HDR_PTR;
-    if (ip6_hdr_cb(ipv6, end) < 0)
+    srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
         return -1;
 
-    srh = SRH_HDR_PTR;
-    if (srh_hdr_cb(srh, end) < 0)
-        return -1;
-
-    struct pot_tlv tlv;
-    init_tlv(&tlv);
-
-#if ISADDR
-    if (compute_first_witness(ipv6, &tlv) < 0) {
-        bpf_printk("[seg6_pot_tlv][-] Failed to compute the first witness");
-        return -1;
-    }
-#endif
-
-    __u32 tlv_offset = SRH_HDR_OFFSET + SRH_FIXED_HDR_LEN + (IPV6_LEN * (__u32)segment_size);
+    __u32 tlv_offset = srh_offset + (__u32)SRH_HDR_LEN(segment_size);
     if ((void *)data + tlv_offset + POT_TLV_WIRE_LEN > end) {
         bpf_printk("[seg6_pot_tlv][-] not enough space in packet buffer for TLV");
         return -1;
@@ -124,17 +215,45 @@ static __always_inline int add_pot_tlv(struct __sk_buff *skb)
         return -1;
     }
 
-    if (recalc_skb_ip6_tlv_len(skb, POT_TLV_WIRE_LEN) < 0) {
+    if (recalc_skb_ip6_tlv_len(skb, hdrs, POT_TLV_WIRE_LEN) < 0) {
         bpf_printk("[seg6_pot_tlv][-] recalc_skb_ip6_tlv_len failed");
         return -1;
     }
 
-    if (recalc_skb_tlv_len(skb, POT_TLV_EXT_LEN) < 0) {
+    if (recalc_skb_tlv_len(skb, hdrs, POT_TLV_EXT_LEN) < 0) {
         bpf_printk("[seg6_pot_tlv][-] recalc_skb_tlv_len failed");
         return -1;
     }
 
+#if POT_FLOWLABEL
+    if (set_flow_label(skb, hdrs, flow_hash) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to set the flow label");
+        return -1;
+    }
+#endif
+
+    POT_LAT_RECORD(POT_LAT_ADD, POT_LAT_REWRITE, rewrite_start);
+    POT_LAT_RECORD(POT_LAT_ADD, POT_LAT_TOTAL, start);
     return 0;
 }
 
+/* Tags still in the frame are popped for the resize and pushed back after it */
+static __always_inline int add_pot_tlv(struct __sk_buff *skb, const struct pot_hdrs *hdrs)
+{
+    struct pot_hdrs untagged = *hdrs;
+    struct pot_vlan_stack tags;
+    if (pot_vlan_untag(skb, &untagged, &tags) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to pop the VLAN tags");
+        return -1;
+    }
+
+    int ret = insert_pot_tlv(skb, &untagged);
+
+    if (pot_vlan_retag(skb, &tags) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to push the VLAN tags back");
+        return -1;
+    }
+    return ret;
+}
+
 #endif /* __SEG6_TLV_ADD_H */
\ No newline at end of file
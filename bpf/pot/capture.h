@@ -0,0 +1,163 @@
+#ifndef __SEG6_TLV_CAPTURE_H
+#define __SEG6_TLV_CAPTURE_H
+
+#include <linux/bpf.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_helpers.h>
+
+#include "hdr.h"
+#include "tlv.h"
+#include "pot/limit.h"
+#include "pot/pipeline.h"
+
+#define POT_CAPTURE_WITNESS_LEN 32 // Largest DIGEST_LEN
+
+/* Why the egress snapshot was taken, mirrored by captureVerdicts of cmd/capture.go */
+enum pot_capture_verdict {
+    POT_CAP_PASS = 0, // Sampled valid packet
+    POT_CAP_WITNESS,  // Witness mismatch, possible path mismatch
+    POT_CAP_REJECT,   // Missing key or over the validation limit, never hashed
+};
+
+/*
+    Set by seg6-pot-tlv --capture while it runs, a zero snap_len disables the
+    snapshots. rate bounds the snapshots each CPU emits per second, so a
+    failure storm costs at most rate copies per CPU and second.
+*/
+struct pot_capture_cfg {
+    __u32 snap_len;    // Leading bytes copied out of each packet
+    __u32 sample_pass; // 1-in-N valid packets, 0 for failures only
+    __u32 rate;        // Snapshots per CPU and second
+    __u32 pad;
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct pot_capture_cfg);
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+} seg6_pot_capture SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERF_EVENT_ARRAY);
+    __uint(key_size, sizeof(__u32));
+    __uint(value_size, sizeof(__u32));
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+} seg6_pot_events SEC(".maps");
+
+struct pot_capture_budget {
+    __u64 window_ns;
+    __u32 count;
+    __u32 pad;
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct pot_capture_budget);
+} seg6_pot_capture_budget SEC(".maps");
+
+/* Sent ahead of the packet bytes, mirrored by captureMeta of cmd/capture.go */
+struct pot_capture_meta {
+    __u64 ts_ns; // bpf_ktime_get_boot_ns
+    __u32 verdict;
+    __u32 cpu;
+    __u32 ifindex;
+    __u32 pkt_len;
+    __u32 cap_len;
+    __u32 witness_len; // Zero when the packet was never hashed
+    __u8 expected[POT_CAPTURE_WITNESS_LEN];
+    __u8 received[POT_CAPTURE_WITNESS_LEN];
+};
+
+/* Returns the bytes to copy out of the packet, 0 when no snapshot is taken */
+static __always_inline __u32 pot_capture_len(struct pot_scratch *scratch, __u32 verdict, __u32 pkt_len)
+{
+    // Only egress packets whose SRH passed its checks are worth a look
+    if (scratch->path.role == POT_PATH_NONE)
+        return 0;
+
+    __u32 zero = 0;
+    struct pot_capture_cfg *cfg = bpf_map_lookup_elem(&seg6_pot_capture, &zero);
+    if (!cfg || cfg->snap_len == 0)
+        return 0;
+
+    if (verdict == POT_CAP_PASS && (cfg->sample_pass == 0 || bpf_get_prandom_u32() % cfg->sample_pass != 0))
+        return 0;
+
+    struct pot_capture_budget *budget = bpf_map_lookup_elem(&seg6_pot_capture_budget, &zero);
+    if (!budget)
+        return 0;
+
+    // Per-CPU values, no atomics needed
+    __u64 now = bpf_ktime_get_ns();
+    if (now - budget->window_ns >= POT_NSEC_PER_SEC) {
+        budget->window_ns = now;
+        budget->count = 0;
+    }
+    if (budget->count >= cfg->rate)
+        return 0;
+    budget->count++;
+
+    return cfg->snap_len < pkt_len ? cfg->snap_len : pkt_len;
+}
+
+static __always_inline void pot_capture_meta(struct pot_capture_meta *meta, void *data, void *end, struct pot_scratch *scratch, __u32 verdict)
+{
+    meta->ts_ns = bpf_ktime_get_boot_ns();
+    meta->verdict = verdict;
+    meta->cpu = bpf_get_smp_processor_id();
+
+    if (verdict == POT_CAP_REJECT)
+        return;
+
+    struct pot_tlv *tlv = pot_scratch_tlv(scratch, data, end);
+    if (!tlv)
+        return;
+
+    meta->witness_len = DIGEST_LEN;
+    __builtin_memcpy(meta->expected, scratch->recursive_tlv.witness, DIGEST_LEN);
+    __builtin_memcpy(meta->received, tlv->witness, DIGEST_LEN);
+}
+
+/* Copies the first snap_len bytes of an egress packet, as received, to seg6_pot_events */
+static __always_inline void pot_capture_xdp(struct xdp_md *ctx, struct pot_scratch *scratch, __u32 verdict)
+{
+    void *data = (void *)(long)ctx->data;
+    void *end = (void *)(long)ctx->data_end;
+
+    __u32 cap_len = pot_capture_len(scratch, verdict, (__u32)(end - data));
+    if (cap_len == 0)
+        return;
+
+    struct pot_capture_meta meta = {};
+    pot_capture_meta(&meta, data, end, scratch, verdict);
+    meta.ifindex = ctx->ingress_ifindex;
+    meta.pkt_len = (__u32)(end - data);
+    meta.cap_len = cap_len;
+
+    bpf_xdp_output(ctx, &seg6_pot_events, BPF_F_CURRENT_CPU | ((__u64)cap_len << 32), &meta, sizeof(meta));
+}
+
+static __always_inline void pot_capture_skb(struct __sk_buff *skb, struct pot_scratch *scratch, __u32 verdict)
+{
+    void *data = (void *)(long)skb->data;
+    void *end = (void *)(long)skb->data_end;
+
+    __u32 cap_len = pot_capture_len(scratch, verdict, skb->len);
+    if (cap_len == 0)
+        return;
+
+    struct pot_capture_meta meta = {};
+    pot_capture_meta(&meta, data, end, scratch, verdict);
+    meta.ifindex = skb->ingress_ifindex;
+    meta.pkt_len = skb->len;
+    meta.cap_len = cap_len;
+
+    bpf_skb_output(skb, &seg6_pot_events, BPF_F_CURRENT_CPU | ((__u64)cap_len << 32), &meta, sizeof(meta));
+}
+
+#endif /* __SEG6_TLV_CAPTURE_H */
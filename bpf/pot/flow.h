@@ -0,0 +1,112 @@
+#ifndef __SEG6_TLV_FLOW_H
+#define __SEG6_TLV_FLOW_H
+
+#include <linux/bpf.h>
+#include <linux/in.h>
+#include <linux/in6.h>
+#include <linux/ipv6.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+
+#include "hdr.h"
+#include "srh.h"
+
+#define POT_MAX_CPUS 128
+#define POT_INNER_IPV6 41 // IPv6 encapsulated after the SRH
+
+/*
+    Encapsulated traffic between two SR nodes shares the outer addresses, so
+    RSS puts it on a single queue. The steering program spreads it over
+    seg6_pot_cpus by the inner flow and the validation pipeline runs on the
+    target CPU as the cpumap program. Both maps hold program and CPU numbers of
+    this loader only, so they are never pinned.
+*/
+struct {
+    __uint(type, BPF_MAP_TYPE_CPUMAP);
+    __uint(max_entries, POT_MAX_CPUS);
+    __type(key, __u32);
+    __type(value, struct bpf_cpumap_val);
+} seg6_pot_cpumap SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, POT_MAX_CPUS);
+    __type(key, __u32);
+    __type(value, __u32);
+} seg6_pot_cpus SEC(".maps");
+
+/* Number of seg6_pot_cpus slots in use, set by the loader */
+const volatile __u32 pot_steer_cpus = 0;
+
+static __always_inline __u32 pot_hash_mix(__u32 h, __u32 v)
+{
+    h ^= v;
+    h *= 0x9E3779B1;
+    return h ^ (h >> 16);
+}
+
+static __always_inline __u32 pot_hash_addr(__u32 h, struct in6_addr *addr)
+{
+    h = pot_hash_mix(h, addr->in6_u.u6_addr32[0]);
+    h = pot_hash_mix(h, addr->in6_u.u6_addr32[1]);
+    h = pot_hash_mix(h, addr->in6_u.u6_addr32[2]);
+    return pot_hash_mix(h, addr->in6_u.u6_addr32[3]);
+}
+
+/*
+    Hashes the inner 5-tuple of an SRv6 encapsulated packet. Inline SRH packets,
+    or inner headers that don't fit, fall back to the outer addresses and flow
+    label so they still spread when the head-end sets it.
+*/
+static __always_inline __u32 pot_flow_hash(struct ipv6hdr *ipv6, struct srh *srh, void *end)
+{
+    struct ipv6hdr *inner = (void *)srh + srh_hdr_len(srh);
+
+    if (srh->next_hdr != POT_INNER_IPV6 || ip6_hdr_cb(inner, end) < 0) {
+        __u32 h = pot_hash_addr(0, &ipv6->saddr);
+        h = pot_hash_addr(h, &ipv6->daddr);
+        return pot_hash_mix(h, *(__be32 *)ipv6 & bpf_htonl(0x000FFFFF));
+    }
+
+    __u32 h = pot_hash_addr(0, &inner->saddr);
+    h = pot_hash_addr(h, &inner->daddr);
+    h = pot_hash_mix(h, inner->nexthdr);
+
+    // Ports only when the transport header directly follows the inner header
+    if (inner->nexthdr == IPPROTO_TCP || inner->nexthdr == IPPROTO_UDP) {
+        __u32 *ports = (void *)inner + IPV6_HDR_LEN;
+        if ((void *)ports + sizeof(*ports) <= end)
+            h = pot_hash_mix(h, *ports);
+    }
+
+    return h;
+}
+
+static __always_inline int pot_flow_cpu(struct xdp_md *ctx, const struct pot_hdrs *hdrs, __u32 *cpu)
+{
+    void *data = (void *)(long)ctx->data;
+    void *end = (void *)(long)ctx->data_end;
+
+    struct ipv6hdr *ipv6 = ip6_hdr_at(data, end, hdrs);
+    if (!ipv6)
+        return -1;
+
+    struct srh *srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
+        return -1;
+
+    if (pot_steer_cpus == 0)
+        return -1;
+
+    __u32 slot = pot_flow_hash(ipv6, srh, end) % pot_steer_cpus;
+    __u32 *target = bpf_map_lookup_elem(&seg6_pot_cpus, &slot);
+    if (!target)
+        return -1;
+
+    *cpu = *target;
+    return 0;
+}
+
+#endif /* __SEG6_TLV_FLOW_H */
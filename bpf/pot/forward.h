@@ -0,0 +1,227 @@
+#ifndef __SEG6_TLV_FORWARD_H
+#define __SEG6_TLV_FORWARD_H
+
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/in6.h>
+#include <linux/ipv6.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+
+#include "hdr.h"
+#include "sid.h"
+#include "srh.h"
+#if POT_CSID
+#include "csid.h"
+#endif
+
+#ifndef AF_INET6
+#define AF_INET6 10
+#endif
+
+#define SRH_NEXT_HEADER_IPV6 41 // IPv6 encapsulated by End.DT6 SIDs
+
+#define SEG6_MAX_LOCAL_SIDS 64
+#define SEG6_MAX_FWD_IFACES 64
+
+/* SRv6 behaviour executed in XDP for a local SID, anything else goes to the kernel */
+enum pot_sid_action {
+    POT_SID_PASS = 0,
+    POT_SID_END,
+    POT_SID_END_DT6,
+};
+
+struct pot_sid_cfg {
+    __u32 action;
+    __u32 table; // FIB table of the inner packet for End.DT6
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(key_size, sizeof(struct in6_addr));
+    __uint(value_size, sizeof(struct pot_sid_cfg));
+    __uint(max_entries, SEG6_MAX_LOCAL_SIDS);
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+} seg6_pot_sids SEC(".maps");
+
+/*
+    Egress interfaces allowed for XDP_REDIRECT, filled by the loader with the
+    interfaces of its own network namespace, so it is never pinned.
+*/
+struct {
+    __uint(type, BPF_MAP_TYPE_DEVMAP_HASH);
+    __uint(key_size, sizeof(__u32));
+    __uint(value_size, sizeof(__u32));
+    __uint(max_entries, SEG6_MAX_FWD_IFACES);
+} seg6_pot_devmap SEC(".maps");
+
+static __always_inline struct pot_sid_cfg *lookup_local_sid(struct ipv6hdr *ipv6)
+{
+    return bpf_map_lookup_elem(&seg6_pot_sids, &ipv6->daddr);
+}
+
+/*
+    RFC 8986 End behaviour followed by a FIB redirect. Every check and the FIB
+    lookup happen before the packet is touched, so any miss can still be handed
+    to the kernel with XDP_PASS and be processed as usual. VLAN tagged packets
+    are left to it too, the tags of the egress interface aren't known here.
+*/
+static __always_inline int end_forward(struct xdp_md *ctx, const struct pot_hdrs *hdrs)
+{
+    void *data = (void *)(long)ctx->data;
+    void *end = (void *)(long)ctx->data_end;
+
+    struct ethhdr *eth = ETH_HDR_PTR;
+    if (eth_hdr_cb(eth, end) < 0 || hdrs->ip6_offset != IPV6_HDR_OFFSET)
+        return XDP_PASS;
+
+    struct ipv6hdr *ipv6 = ip6_hdr_at(data, end, hdrs);
+    if (!ipv6)
+        return XDP_PASS;
+
+    struct srh *srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
+        return XDP_PASS;
+
+    struct pot_sid_cfg *cfg = lookup_local_sid(ipv6);
+    if (!cfg || cfg->action != POT_SID_END)
+        return XDP_PASS;
+
+    // Let the kernel answer with ICMPv6 time exceeded
+    if (ipv6->hop_limit <= 1)
+        return XDP_PASS;
+
+    if (srh->segments_left == 0 || srh->segments_left > srh->last_entry)
+        return XDP_PASS;
+
+#if POT_CSID
+    // Shifting in the next C-SID is left to the kernel End with the next-csid flavor
+    if (csid_has_next(&ipv6->daddr))
+        return XDP_PASS;
+#endif
+
+    __u32 next_idx = (__u32)srh->segments_left - 1;
+    if (next_idx >= SRH_MAX_ALLOWED_SEGMENTS)
+        return XDP_PASS;
+
+    struct in6_addr *next_sid = (void *)srh + SRH_FIXED_HDR_LEN + (IPV6_LEN * next_idx);
+    if ((void *)next_sid + IPV6_LEN > end)
+        return XDP_PASS;
+
+    struct bpf_fib_lookup fib = {};
+    fib.family = AF_INET6;
+    fib.flowinfo = *(__be32 *)ipv6 & bpf_htonl(0x0FFFFFFF);
+    fib.l4_protocol = ipv6->nexthdr;
+    fib.tot_len = (__u16)(bpf_ntohs(ipv6->payload_len) + IPV6_HDR_LEN);
+    fib.ifindex = ctx->ingress_ifindex;
+    __builtin_memcpy(fib.ipv6_src, &ipv6->saddr, IPV6_LEN);
+    __builtin_memcpy(fib.ipv6_dst, next_sid, IPV6_LEN);
+
+    long rc = bpf_fib_lookup(ctx, &fib, sizeof(fib), 0);
+    if (rc != BPF_FIB_LKUP_RET_SUCCESS)
+        return XDP_PASS;
+
+    if (!bpf_map_lookup_elem(&seg6_pot_devmap, &fib.ifindex))
+        return XDP_PASS;
+
+    // End: activate the next SID and forward it
+    srh->segments_left--;
+    __builtin_memcpy(&ipv6->daddr, next_sid, IPV6_LEN);
+    ipv6->hop_limit--;
+
+    __builtin_memcpy(eth->h_dest, fib.dmac, ETH_ALEN);
+    __builtin_memcpy(eth->h_source, fib.smac, ETH_ALEN);
+
+    return (int)bpf_redirect_map(&seg6_pot_devmap, fib.ifindex, XDP_PASS);
+}
+
+/*
+    RFC 8986 End.DT6 behaviour for a validated endpoint. The outer IPv6 header,
+    its extension headers, the SRH and the TLV inside it go away with one
+    bpf_xdp_adjust_head, so the TLV never has to be shifted out. srh_len is the
+    SRH length parse_pot_tlv read, the outer header ends there whatever the
+    stages did to hdr_ext_len. Returns -1 without touching the packet when the
+    SID or the inner route isn't handled here, or the packet is VLAN tagged,
+    otherwise the egress ifindex to redirect the inner packet to.
+*/
+static __always_inline int end_dt6_decap(struct xdp_md *ctx, const struct pot_hdrs *hdrs, __u32 srh_len, __u32 *ifindex)
+{
+    void *data = (void *)(long)ctx->data;
+    void *end = (void *)(long)ctx->data_end;
+
+    if (hdrs->ip6_offset != IPV6_HDR_OFFSET)
+        return -1;
+
+    struct ipv6hdr *ipv6 = ip6_hdr_at(data, end, hdrs);
+    if (!ipv6)
+        return -1;
+
+    struct srh *srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
+        return -1;
+
+    struct pot_sid_cfg *cfg = lookup_local_sid(ipv6);
+    if (!cfg || cfg->action != POT_SID_END_DT6)
+        return -1;
+
+    if (srh->segments_left != 0 || srh->next_hdr != SRH_NEXT_HEADER_IPV6)
+        return -1;
+
+    if (srh_len < SRH_FIXED_HDR_LEN || srh_len > SRH_FIXED_HDR_LEN + 255 * HDR_BYTE_SIZE)
+        return -1;
+
+    __u32 outer_len = hdrs->srh_offset - (__u32)IPV6_HDR_OFFSET + srh_len;
+    if (outer_len > IPV6_HDR_LEN + POT_MAX_EXT_LEN + SRH_FIXED_HDR_LEN + 255 * HDR_BYTE_SIZE)
+        return -1;
+
+    struct ipv6hdr *inner = (void *)ipv6 + outer_len;
+    if (ip6_hdr_cb(inner, end) < 0)
+        return -1;
+
+    // Let the kernel answer with ICMPv6 time exceeded
+    if (inner->hop_limit <= 1)
+        return -1;
+
+    struct bpf_fib_lookup fib = {};
+    fib.family = AF_INET6;
+    fib.flowinfo = *(__be32 *)inner & bpf_htonl(0x0FFFFFFF);
+    fib.l4_protocol = inner->nexthdr;
+    fib.tot_len = (__u16)(bpf_ntohs(inner->payload_len) + IPV6_HDR_LEN);
+    fib.ifindex = ctx->ingress_ifindex;
+    fib.tbid = cfg->table;
+    __builtin_memcpy(fib.ipv6_src, &inner->saddr, IPV6_LEN);
+    __builtin_memcpy(fib.ipv6_dst, &inner->daddr, IPV6_LEN);
+
+    long rc = bpf_fib_lookup(ctx, &fib, sizeof(fib), BPF_FIB_LOOKUP_DIRECT | BPF_FIB_LOOKUP_TBID);
+    if (rc != BPF_FIB_LKUP_RET_SUCCESS)
+        return -1;
+
+    if (!bpf_map_lookup_elem(&seg6_pot_devmap, &fib.ifindex))
+        return -1;
+
+    if (bpf_xdp_adjust_head(ctx, (int)outer_len) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] bpf_xdp_adjust_head failed");
+        return -1;
+    }
+
+    data = (void *)(long)ctx->data;
+    end = (void *)(long)ctx->data_end;
+
+    // The old SRH tail becomes the new Ethernet header
+    struct ethhdr *eth = ETH_HDR_PTR;
+    inner = data + IPV6_HDR_OFFSET;
+    if (eth_hdr_cb(eth, end) < 0 || ip6_hdr_cb(inner, end) < 0)
+        return -1;
+
+    inner->hop_limit--;
+    __builtin_memcpy(eth->h_dest, fib.dmac, ETH_ALEN);
+    __builtin_memcpy(eth->h_source, fib.smac, ETH_ALEN);
+    eth->h_proto = bpf_htons(ETH_P_IPV6);
+
+    *ifindex = fib.ifindex;
+    return 0;
+}
+
+#endif /* __SEG6_TLV_FORWARD_H */
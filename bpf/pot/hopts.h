@@ -0,0 +1,79 @@
+#ifndef __SEG6_TLV_HOPTS_H
+#define __SEG6_TLV_HOPTS_H
+
+#include <linux/bpf.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+
+#include "tlv.h"
+#include "pot/latency.h"
+
+/*
+    Per-hop timestamps, compiled in with -DPOT_HOPTS=1. Every node stamps its
+    slot of the TLV with one bpf_ktime_get_tai_ns, the TAI clock the nodes keep
+    in sync with PTP, and folds it into the witness before hashing, so the
+    egress only trusts timestamps of packets that validated.
+
+    The egress then records the delay of every hop since the previous one in a
+    per-CPU log2 histogram per segments left, key 0 being its own. The layout
+    is the one of seg6_pot_latency, read by cmd/hopts.go. The timestamps wrap
+    every 4.29 s and a hop whose clock lags behind shows as 0 ns.
+*/
+#if POT_HOPTS
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, POT_HOP_SLOTS);
+    __type(key, __u32);
+    __type(value, struct pot_lat_hist);
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+} seg6_pot_hop_delay SEC(".maps");
+
+static __always_inline __be32 pot_hop_now(void)
+{
+    return bpf_htonl((__u32)bpf_ktime_get_tai_ns());
+}
+
+static __always_inline void pot_hop_hist(__u32 hop, __u32 prev, __u32 now)
+{
+    __s32 delta = (__s32)(now - prev);
+    __u64 delay = delta > 0 ? (__u64)delta : 0;
+
+    struct pot_lat_hist *hist = bpf_map_lookup_elem(&seg6_pot_hop_delay, &hop);
+    if (!hist)
+        return;
+
+    __u32 slot = pot_lat_log2(delay);
+    if (slot >= POT_LAT_SLOTS)
+        slot = POT_LAT_SLOTS - 1;
+
+    // Per-CPU values, no atomics needed
+    hist->slots[slot]++;
+    hist->count++;
+    hist->sum_ns += delay;
+}
+
+/*
+    Delays of a validated packet. The hop at segments left i follows the one
+    at i + 1, the first one the head-end, and the egress the hop at 1.
+*/
+static __always_inline void pot_hop_record(const struct pot_tlv *tlv, __u32 segment_size, __be32 arrival)
+{
+    __u32 prev = bpf_ntohl(tlv->hop_ts[0]);
+
+#pragma clang loop unroll(full)
+    for (__s32 i = POT_HOP_SLOTS - 1; i >= 0; i--) {
+        if ((__u32)i >= segment_size)
+            continue;
+
+        __u32 now = i == 0 ? bpf_ntohl(arrival) : bpf_ntohl(tlv->hop_ts[i]);
+        pot_hop_hist((__u32)i, prev, now);
+        prev = now;
+    }
+}
+
+#endif /* POT_HOPTS */
+
+#endif /* __SEG6_TLV_HOPTS_H */
@@ -0,0 +1,94 @@
+#ifndef __SEG6_TLV_LATENCY_H
+#define __SEG6_TLV_LATENCY_H
+
+#include <linux/bpf.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_helpers.h>
+
+/*
+    Per-stage latency instrumentation, compiled in with -DPOT_LATENCY=1.
+
+    Every (path, stage) pair owns a per-CPU log2 histogram of nanoseconds, slot
+    N counts the samples in [2^N, 2^(N+1)). The layout is mirrored by the
+    latencyHist type of cmd/latency.go, the per-hop delays share it.
+*/
+enum pot_lat_path {
+    POT_LAT_ADD = 0, // Head-end, add_pot_tlv
+    POT_LAT_UPDATE,  // Transit and the endpoint own witness, update_pot_tlv
+    POT_LAT_REMOVE,  // Endpoint chain, verification and strip, remove_pot_tlv
+    POT_LAT_PATH_MAX,
+};
+
+enum pot_lat_stage {
+    POT_LAT_PARSE = 0,
+    POT_LAT_KEY_LOOKUP,
+    POT_LAT_HASH, // One sample per SID
+    POT_LAT_VERIFY,
+    POT_LAT_REWRITE,
+    POT_LAT_TOTAL,
+    POT_LAT_STAGE_MAX,
+};
+
+#define POT_LAT_SLOTS 32
+
+struct pot_lat_hist {
+    __u64 slots[POT_LAT_SLOTS];
+    __u64 count;
+    __u64 sum_ns;
+};
+
+static __always_inline __u32 pot_lat_log2(__u64 v)
+{
+    __u32 r = 0, shift;
+
+    shift = (v > 0xFFFFFFFF) << 5; v >>= shift; r |= shift;
+    shift = (v > 0xFFFF) << 4; v >>= shift; r |= shift;
+    shift = (v > 0xFF) << 3; v >>= shift; r |= shift;
+    shift = (v > 0xF) << 2; v >>= shift; r |= shift;
+    shift = (v > 0x3) << 1; v >>= shift; r |= shift;
+    r |= (__u32)(v >> 1);
+
+    return r;
+}
+
+#if POT_LATENCY
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, POT_LAT_PATH_MAX * POT_LAT_STAGE_MAX);
+    __type(key, __u32);
+    __type(value, struct pot_lat_hist);
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+} seg6_pot_latency SEC(".maps");
+
+static __always_inline void pot_lat_record(__u32 path, __u32 stage, __u64 start)
+{
+    __u64 delta = bpf_ktime_get_ns() - start;
+    __u32 key = path * POT_LAT_STAGE_MAX + stage;
+
+    struct pot_lat_hist *hist = bpf_map_lookup_elem(&seg6_pot_latency, &key);
+    if (!hist)
+        return;
+
+    __u32 slot = pot_lat_log2(delta);
+    if (slot >= POT_LAT_SLOTS)
+        slot = POT_LAT_SLOTS - 1;
+
+    // Per-CPU values, no atomics needed
+    hist->slots[slot]++;
+    hist->count++;
+    hist->sum_ns += delta;
+}
+
+#define POT_LAT_START(v) __u64 v = bpf_ktime_get_ns()
+#define POT_LAT_RECORD(path, stage, v) pot_lat_record(path, stage, v)
+
+#else
+
+#define POT_LAT_START(v)
+#define POT_LAT_RECORD(path, stage, v) ((void)(path))
+
+#endif /* POT_LATENCY */
+
+#endif /* __SEG6_TLV_LATENCY_H */
@@ -0,0 +1,110 @@
+#ifndef __SEG6_TLV_LIMIT_H
+#define __SEG6_TLV_LIMIT_H
+
+#include <linux/bpf.h>
+#include <linux/in6.h>
+#include <linux/ipv6.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+
+#include "hdr.h"
+
+#define POT_LIMIT_MAX_SOURCES 65536
+#define POT_NSEC_PER_SEC 1000000000ull
+
+/*
+    Rate of full validations each source prefix may trigger on the endpoint,
+    set by the loader with --limit. A zero rate disables the limit.
+*/
+struct pot_limit_cfg {
+    __u32 rate;       // Validations per second
+    __u32 burst;      // Validations allowed back to back
+    __u32 prefix_len; // Outer source bits that make up one bucket
+    __u32 pad;
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct pot_limit_cfg);
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+} seg6_pot_limit SEC(".maps");
+
+/*
+    One token bucket per source prefix, kept as the time its next token is due
+    (GCRA), so a single word is updated per packet. The least recently seen
+    prefixes are evicted first, a flood of spoofed sources only costs them
+    their burst.
+*/
+struct {
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(key_size, sizeof(struct in6_addr));
+    __uint(value_size, sizeof(__u64));
+    __uint(max_entries, POT_LIMIT_MAX_SOURCES);
+} seg6_pot_buckets SEC(".maps");
+
+/* Packets dropped over the limit, a log line each would cost more than the hash saved */
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, __u64);
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+} seg6_pot_limit_drops SEC(".maps");
+
+static __always_inline void pot_limit_prefix(struct in6_addr *prefix, const struct in6_addr *src, __u32 prefix_len)
+{
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < 4; i++) {
+        __u32 bits = prefix_len > 32 * i ? prefix_len - 32 * i : 0;
+        __u32 mask = bits >= 32 ? 0xFFFFFFFFu : bits ? ~(0xFFFFFFFFu >> bits) : 0;
+        prefix->in6_u.u6_addr32[i] = src->in6_u.u6_addr32[i] & bpf_htonl(mask);
+    }
+}
+
+/* Returns -1 when the source of the packet ran out of validations */
+static __always_inline int pot_limit_check(void *data, void *end, const struct pot_hdrs *hdrs)
+{
+    __u32 zero = 0;
+    struct pot_limit_cfg *cfg = bpf_map_lookup_elem(&seg6_pot_limit, &zero);
+    if (!cfg || cfg->rate == 0)
+        return 0;
+
+    struct ipv6hdr *ipv6 = ip6_hdr_at(data, end, hdrs);
+    if (!ipv6)
+        return -1;
+
+    struct in6_addr src, prefix;
+    __builtin_memcpy(&src, &ipv6->saddr, IPV6_LEN);
+    pot_limit_prefix(&prefix, &src, cfg->prefix_len);
+
+    __u64 now = bpf_ktime_get_ns();
+    __u64 interval = POT_NSEC_PER_SEC / cfg->rate;
+    if (interval == 0)
+        interval = 1; // Rates above 1/ns are refused by the loader
+    __u64 tolerance = interval * (cfg->burst ? cfg->burst : 1);
+
+    __u64 *due = bpf_map_lookup_elem(&seg6_pot_buckets, &prefix);
+    if (!due) {
+        __u64 next = now + interval;
+        bpf_map_update_elem(&seg6_pot_buckets, &prefix, &next, BPF_ANY);
+        return 0;
+    }
+
+    __u64 tat = *due > now ? *due : now;
+    if (tat - now >= tolerance) {
+        __u64 *drops = bpf_map_lookup_elem(&seg6_pot_limit_drops, &zero);
+        if (drops)
+            (*drops)++;
+        return -1;
+    }
+
+    // Shared by every CPU, a racing update at worst lets one more packet through
+    *due = tat + interval;
+    return 0;
+}
+
+#endif /* __SEG6_TLV_LIMIT_H */
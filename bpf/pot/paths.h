@@ -0,0 +1,147 @@
+#ifndef __SEG6_TLV_PATHS_H
+#define __SEG6_TLV_PATHS_H
+
+#include <linux/bpf.h>
+#include <linux/in6.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_helpers.h>
+
+#include "hdr.h"
+#include "sid.h"
+#include "srh.h"
+
+#define POT_MAX_PATHS 4096
+
+enum pot_path_role {
+    POT_PATH_NONE = 0, // Not accounted
+    POT_PATH_HEADEND,
+    POT_PATH_EGRESS,
+};
+
+/* The digest of the SID list, the same path gets the same one on every node */
+struct pot_path_key {
+    __u64 digest;
+    __u32 role;
+    __u32 pad;
+};
+
+/*
+    Per-CPU counters of one path, summed by the exporter of cmd/paths.go. The
+    SID list is written along with the first packet of the path on each CPU, so
+    the exporter can name the path, and never touched again.
+*/
+struct pot_path_stats {
+    __u64 packets;
+    __u64 bytes;
+    __u64 failures;
+    __u64 last_seen_ns; // bpf_ktime_get_boot_ns
+    __u32 segment_size;
+    __u32 pad;
+    struct in6_addr segments[SRH_MAX_ALLOWED_SEGMENTS];
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_LRU_PERCPU_HASH);
+    __uint(key_size, sizeof(struct pot_path_key));
+    __uint(value_size, sizeof(struct pot_path_stats));
+    __uint(max_entries, POT_MAX_PATHS);
+    __uint(pinning, LIBBPF_PIN_BY_NAME);
+} seg6_pot_paths SEC(".maps");
+
+/* Room for the first value of a path, too large for the stack of the callers */
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct pot_path_stats);
+} seg6_pot_path_new SEC(".maps");
+
+static __always_inline __u64 pot_path_mix(__u64 h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/* Not a keyed hash, only the map key of the path */
+static __always_inline int pot_path_hash(void *data, void *end, const struct pot_hdrs *hdrs, __u32 role, struct pot_path_key *key)
+{
+    struct srh *srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
+        return -1;
+
+    __u32 segment_size = (__u32)srh->last_entry + 1;
+    if (segment_size > SRH_MAX_ALLOWED_SEGMENTS)
+        return -1;
+
+    __u64 h = segment_size;
+
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < SRH_MAX_ALLOWED_SEGMENTS; i++) {
+        if (i >= segment_size)
+            break;
+
+        void *segment = (void *)srh + SRH_FIXED_HDR_LEN + (IPV6_LEN * i);
+        if (segment + IPV6_LEN > end)
+            return -1;
+
+        __u64 sid[2];
+        __builtin_memcpy(sid, segment, IPV6_LEN);
+        h = pot_path_mix(h ^ sid[0]);
+        h = pot_path_mix(h ^ sid[1]);
+    }
+
+    key->digest = h;
+    key->role = role;
+    key->pad = 0;
+    return 0;
+}
+
+/* One update of seg6_pot_paths per packet, in place through the lookup or the insertion of a new path */
+static __always_inline void pot_path_account(void *data, void *end, const struct pot_hdrs *hdrs, const struct pot_path_key *key, __u64 bytes, __u32 failed)
+{
+    if (key->role == POT_PATH_NONE)
+        return;
+
+    __u64 now = bpf_ktime_get_boot_ns();
+
+    struct pot_path_stats *stats = bpf_map_lookup_elem(&seg6_pot_paths, key);
+    if (stats) {
+        // Per-CPU values, no atomics needed
+        stats->packets++;
+        stats->bytes += bytes;
+        stats->failures += failed;
+        stats->last_seen_ns = now;
+        return;
+    }
+
+    __u32 zero = 0;
+    stats = bpf_map_lookup_elem(&seg6_pot_path_new, &zero);
+    if (!stats)
+        return;
+
+    struct srh *srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
+        return;
+
+    __u32 segment_size = (__u32)srh->last_entry + 1;
+    if (segment_size > SRH_MAX_ALLOWED_SEGMENTS)
+        return;
+
+    stats->packets = 1;
+    stats->bytes = bytes;
+    stats->failures = failed;
+    stats->last_seen_ns = now;
+    stats->segment_size = segment_size;
+
+    if (retrieve_sidlist(stats->segments, srh, segment_size, end) < 0)
+        return;
+
+    bpf_map_update_elem(&seg6_pot_paths, key, stats, BPF_NOEXIST);
+}
+
+#endif /* __SEG6_TLV_PATHS_H */
@@ -0,0 +1,123 @@
+#ifndef __SEG6_TLV_PIPELINE_H
+#define __SEG6_TLV_PIPELINE_H
+
+#include <linux/bpf.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_helpers.h>
+
+#include "hdr.h"
+#include "sid.h"
+#include "tlv.h"
+#include "crypto/keys.h"
+#include "pot/latency.h"
+#include "pot/paths.h"
+
+/*
+    XDP validation pipeline, every stage is its own program chained by tail calls.
+    With CPU steering enabled the whole pipeline runs as the cpumap program:
+
+    seg6_pot_tlv_d_steer ──► seg6_pot_cpumap[inner flow hash] ──► seg6_pot_tlv_d
+
+    seg6_pot_tlv_d ──► witness ──┬──► forward ──┬──► XDP_REDIRECT (transit, local End SID)
+        (parse)                  │              └──► XDP_PASS (transit)
+                                 └──► chain ─┬─► chain (one SID per call)
+                                             └─► decap ──┬──► XDP_REDIRECT (endpoint, local End.DT6 SID)
+                                                         └──► strip ──► XDP_PASS (endpoint)
+
+    Built with AFXDP=1, endpoint packets received on a queue where seg6-pot-xsk
+    is bound are validated in userspace instead, before anything is parsed:
+
+    seg6_pot_tlv_d ──► seg6_pot_xsks[rx queue] ──► seg6-pot-xsk ──► TAP (endpoint)
+
+    Where native XDP is unavailable the same stages run on tc ingress, with
+    their own program array, and the TLV is removed with bpf_skb_adjust_room:
+
+    seg6_pot_tlv_i ──► witness ──┬──► TC_ACT_OK (transit)
+        (parse)                  └──► chain ─┬─► chain (one SID per call)
+                                             └─► strip ──► TC_ACT_OK (endpoint)
+*/
+enum pot_stage {
+    POT_STAGE_WITNESS = 0,
+    POT_STAGE_CHAIN,
+    POT_STAGE_STRIP,
+    POT_STAGE_FORWARD,
+    POT_STAGE_DECAP,
+    POT_STAGE_MAX,
+};
+
+/* Upper bound of the TLV offset so the verifier can track data + offset, other TLVs may come first */
+#define POT_MAX_TLV_OFFSET (POT_MAX_SRH_OFFSET + SRH_FIXED_HDR_LEN + (IPV6_LEN * SRH_MAX_ALLOWED_SEGMENTS) + POT_MAX_TLV_AREA)
+
+/* Headers the tc pipeline writes directly, they must be in the linear area */
+#define POT_TC_PULL_LEN (POT_MAX_TLV_OFFSET + POT_TLV_WIRE_LEN)
+
+/*
+    Intermediate state handed from one stage to the next. Tail calls never leave
+    the CPU, so one per-CPU slot is enough. The recursive TLV must stay first, the
+    keyed-hash functions load its nonce as 4 bytes aligned words. The header
+    offsets are those parse_srv6_hdrs found, no stage parses the packet again.
+
+    keys[i] holds the key of segments[i], fetched by parse_pot_tlv before any
+    hashing: every SID of the list on the endpoint, only the active one on transit.
+    Built with CSID=1 they are the keys of the C-SIDs instead, the endpoint holds
+    the k-th of n in path order at keys[n - 1 - k] and chains n of them.
+*/
+struct pot_scratch {
+    struct pot_tlv recursive_tlv;
+    struct pot_hdrs hdrs;
+    __u32 tlv_offset;
+    __u32 srh_len; // As received, before any stage rewrites hdr_ext_len
+    __u32 segment_size;
+    __s32 chain_idx;
+    __u32 endpoint;
+    struct pot_sid_key keys[SEG6_MAX_KEYS];
+    struct pot_path_key path; // Egress only, set once the SRH passed its checks
+#if ISADDR
+    struct pot_sid_key src_key;
+#endif
+#if POT_LATENCY
+    __u64 lat_start; // Parse timestamp, the total is recorded by the last stage
+#endif
+#if POT_HOPTS
+    __be32 hop_arrival; // Endpoint only, its own timestamp for the delays
+#endif
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct pot_scratch);
+} seg6_pot_scratch SEC(".maps");
+
+static __always_inline struct pot_scratch *pot_scratch_get(void)
+{
+    __u32 key = 0;
+    return bpf_map_lookup_elem(&seg6_pot_scratch, &key);
+}
+
+#if POT_LATENCY
+#define POT_LAT_SAVE(scratch, v) ((scratch)->lat_start = (v))
+#define POT_LAT_RECORD_TOTAL(path, scratch) pot_lat_record(path, POT_LAT_TOTAL, (scratch)->lat_start)
+#else
+#define POT_LAT_SAVE(scratch, v)
+#define POT_LAT_RECORD_TOTAL(path, scratch)
+#endif
+
+static __always_inline struct pot_tlv *pot_scratch_tlv(struct pot_scratch *scratch, void *data, void *end)
+{
+    __u32 tlv_offset = scratch->tlv_offset;
+    if (tlv_offset > POT_MAX_TLV_OFFSET)
+        return NULL;
+
+    struct pot_tlv *tlv = data + tlv_offset;
+    if ((void *)tlv + POT_TLV_WIRE_LEN > end) {
+        bpf_printk("[seg6_pot_tlv][-] invalid offset on packet buffer for TLV");
+        return NULL;
+    }
+
+    return tlv;
+}
+
+#endif /* __SEG6_TLV_PIPELINE_H */
@@ -9,70 +9,64 @@
 
 #include "tlv.h"
 #include "hdr.h"
+#include "pot/hopts.h"
+#include "pot/pipeline.h"
+#include "pot/vlan.h"
 
-static __always_inline int remove_pot_tlv(struct xdp_md *ctx)
+/* Returns 1 while there are SIDs left to chain, 0 once the chain is complete */
+static __always_inline int chain_pot_tlv(struct pot_scratch *scratch)
 {
-    void *data = (void *)(long)ctx->data;
-    void *end = (void *)(long)ctx->data_end;
-
-    __u32 xdp_len = (__u32)(end - data);
-
-    struct ipv6hdr *ipv6 = IPV6_HDR_PTR;
-    struct srh *srh = SRH_HDR_PTR;
-
-    ipv6 = IPV6_HDR_PTR;
-    if (ip6_hdr_cb(ipv6, end) < 0)
+    __s32 idx = scratch->chain_idx;
+    if (idx < 0 || idx >= SEG6_MAX_KEYS)
         return -1;
 
-    srh = SRH_HDR_PTR;
-    if (srh_hdr_cb(srh, end) < 0)
-        return -1;
+#if POT_HOPTS
+    pot_hop_fold(&scratch->recursive_tlv, (__u32)idx);
+#endif
+    hash_witness(&scratch->recursive_tlv, scratch->keys[idx].key, POT_LAT_REMOVE);
 
-    if (recalc_ctx_tlv_len(ctx, POT_TLV_EXT_LEN) < 0) {
-        bpf_printk("[seg6_pot_tlv][-] recalc_ctx_tlv_len failed");
-        return -1;
-    }
+    if (--scratch->chain_idx >= 0)
+        return 1;
 
-    struct pot_tlv *tlv = SRH_HDR_PTR + srh_hdr_len(srh);
+    bpf_printk("[seg6_pot_tlv][*] keyed-hash calculated to each SID successfully");
+    return 0;
+}
 
-    if (SRH_HDR_PTR + srh_hdr_len(srh) + POT_TLV_WIRE_LEN > end) {
-        bpf_printk("[seg6_pot_tlv][-] invalid offset on packet buffer for TLV");
+static __always_inline int verify_pot_tlv(void *data, void *end, struct pot_scratch *scratch)
+{
+    struct pot_tlv *tlv = pot_scratch_tlv(scratch, data, end);
+    if (!tlv)
         return -1;
-    }
 
-    if (compute_witness_once(tlv, srh, end) < 0) {
-        bpf_printk("[seg6_pot_tlv][-] compute_witness failed");
+    bpf_printk("[seg6_pot_tlv][*] Comparing TLV digests");
+    POT_LAT_START(start);
+    if (compare_pot_digest(tlv, &scratch->recursive_tlv) != 0) {
+        bpf_printk("[seg6_pot_tlv][-] PoT TLV wrong, possible path mismatch!");
         return -1;
     }
+    POT_LAT_RECORD(POT_LAT_REMOVE, POT_LAT_VERIFY, start);
 
-    struct pot_tlv recursive_tlv;
-    dup_tlv_nonce(tlv, &recursive_tlv);
-    bpf_printk("[seg6_pot_tlv][*] Recursive recalculation of PoT digest");
-
-#if ISADDR
-    if (compute_first_witness(ipv6, &recursive_tlv) < 0) {
-        bpf_printk("[seg6_pot_tlv][-] Failed to compute the first witness");
-        return -1;
-    }
+#if POT_HOPTS
+    pot_hop_record(&scratch->recursive_tlv, scratch->segment_size, scratch->hop_arrival);
 #endif
 
-    if (chain_keys(srh, &recursive_tlv, end) < 0) {
-        bpf_printk("[seg6_pot_tlv][-] Failed to chain SID keys");
-        return -1;
-    }
+    bpf_printk("[seg6_pot_tlv][*] TLV successfully validated");
+    return 0;
+}
 
-    bpf_printk("[seg6_pot_tlv][*] Comparing TLV digests");
-    if (compare_pot_digest(tlv, &recursive_tlv) != 0) {
-        bpf_printk("[seg6_pot_tlv][-] PoT TLV wrong, possible path mismatch!");
-        return -1;
-    }
+static __always_inline int remove_pot_tlv(struct xdp_md *ctx, struct pot_scratch *scratch)
+{
+    void *data = (void *)(long)ctx->data;
+    void *end = (void *)(long)ctx->data_end;
 
-    bpf_printk("[seg6_pot_tlv][*] TLV successfully validated");
+    __u32 xdp_len = (__u32)(end - data);
 
-    __u32 segment_size = calc_segment_size(srh, end);
-    if (segment_size == 0) return -1;
+    POT_LAT_START(start);
+
+    __u32 tlv_offset = scratch->tlv_offset;
+    if (tlv_offset > POT_MAX_TLV_OFFSET)
+        return -1;
 
-    __u32 tlv_offset = SRH_HDR_OFFSET + SRH_FIXED_HDR_LEN + (IPV6_LEN * (__u32)segment_size);
     if (data + tlv_offset + POT_TLV_WIRE_LEN > end) {
         bpf_printk("[seg6_pot_tlv][-] packet too short to remove TLV?");
         return -1;
@@ -105,12 +99,127 @@ static __always_inline int remove_pot_tlv(struct xdp_md *ctx)
         return -1;
     }
 
-    if (recalc_ctx_ip6_tlv_len(ctx, POT_TLV_WIRE_LEN) < 0) {
+    data = (void *)(long)ctx->data;
+    end = (void *)(long)ctx->data_end;
+
+    if (recalc_ctx_ip6_tlv_len(data, end, &scratch->hdrs, POT_TLV_WIRE_LEN) < 0) {
         bpf_printk("[seg6_pot_tlv][-] recalc_ctx_ip6_tlv_len failed");
         return -1;
     }
 
+    if (recalc_ctx_tlv_len(data, end, &scratch->hdrs, POT_TLV_EXT_LEN) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] recalc_ctx_tlv_len failed");
+        return -1;
+    }
+
+    POT_LAT_RECORD(POT_LAT_REMOVE, POT_LAT_REWRITE, start);
+    return 0;
+}
+
+/*
+    Everything between the IPv6 header and the TLV: the extension headers in
+    front of the SRH, its fixed header, the SID list and the TLVs before it
+*/
+#define POT_MAX_SRH_HEAD_LEN (POT_MAX_TLV_OFFSET - (SRH_HDR_OFFSET))
+
+#define IPV6_PAYLOAD_LEN_OFFSET 4 // Of payload_len in the IPv6 header
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, __u8[POT_MAX_SRH_HEAD_LEN]);
+} seg6_pot_srh_head SEC(".maps");
+
+/*
+    Moves everything between the IPv6 header and the TLV one TLV further, over
+    the TLV, and frees the room left in front of it. bpf_skb_adjust_room only
+    frees room right after the IPv6 header.
+*/
+static __always_inline int strip_pot_tlv_skb(struct __sk_buff *skb, const struct pot_hdrs *hdrs, __u32 tlv_offset)
+{
+    __u32 head_offset = hdrs->ip6_offset + IPV6_HDR_LEN;
+    __u32 srh_offset = hdrs->srh_offset;
+    if (tlv_offset > POT_MAX_TLV_OFFSET || srh_offset < head_offset || tlv_offset < srh_offset + SRH_FIXED_HDR_LEN) {
+        bpf_printk("[seg6_pot_tlv][-] Invalid offset to remove TLV");
+        return -1;
+    }
+
+    // Bounded on its own, the verifier doesn't relate the offsets it comes from
+    __u32 head_len = tlv_offset - head_offset;
+    if (head_len < SRH_FIXED_HDR_LEN || head_len > POT_MAX_SRH_HEAD_LEN)
+        return -1;
+
+    __u32 key = 0;
+    __u8 *head = bpf_map_lookup_elem(&seg6_pot_srh_head, &key);
+    if (!head)
+        return -1;
+
+    if (bpf_skb_load_bytes(skb, head_offset, head, head_len) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] bpf_skb_load_bytes failed to read the srh");
+        return -1;
+    }
+
+    // The SRH ends one TLV earlier once it's gone
+    __u32 ext_len = srh_offset - head_offset;
+    if (ext_len > POT_MAX_EXT_LEN)
+        return -1;
+    ((struct srh *)(head + ext_len))->hdr_ext_len -= POT_TLV_EXT_LEN;
+
+    // skb->csum then covers the head where the TLV was, the pop takes the copy left in front out of it
+    if (bpf_skb_store_bytes(skb, head_offset + POT_TLV_WIRE_LEN, head, head_len, BPF_F_RECOMPUTE_CSUM) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] bpf_skb_store_bytes failed to move the srh");
+        return -1;
+    }
+
+    if (bpf_skb_adjust_room(skb, -(__s32)POT_TLV_WIRE_LEN, BPF_ADJ_ROOM_NET, 0) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to shrink L3 room");
+        return -1;
+    }
+
+    void *data = (void *)(long)skb->data;
+    void *end = (void *)(long)skb->data_end;
+
+    struct ipv6hdr *ipv6 = ip6_hdr_at(data, end, hdrs);
+    if (!ipv6)
+        return -1;
+
+    // Through the helper too, a direct write would leave skb->csum stale
+    __be16 payload_len = bpf_htons((__u16)(bpf_ntohs(ipv6->payload_len) - POT_TLV_WIRE_LEN));
+    if (bpf_skb_store_bytes(skb, hdrs->ip6_offset + IPV6_PAYLOAD_LEN_OFFSET, &payload_len, sizeof(payload_len), BPF_F_RECOMPUTE_CSUM) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] bpf_skb_store_bytes failed to write the payload length");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+    tc variant of remove_pot_tlv. Tags still in the frame are popped for the
+    resize and pushed back after it, the packet is validated before either.
+*/
+static __always_inline int remove_pot_tlv_skb(struct __sk_buff *skb, struct pot_scratch *scratch)
+{
+    POT_LAT_START(start);
+
+    struct pot_hdrs hdrs = scratch->hdrs;
+    struct pot_vlan_stack tags;
+    int tags_len = pot_vlan_untag(skb, &hdrs, &tags);
+    if (tags_len < 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to pop the VLAN tags");
+        return -1;
+    }
+
+    int ret = strip_pot_tlv_skb(skb, &hdrs, scratch->tlv_offset - (__u32)tags_len);
+
+    if (pot_vlan_retag(skb, &tags) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to push the VLAN tags back");
+        return -1;
+    }
+    if (ret != 0)
+        return ret;
+
+    POT_LAT_RECORD(POT_LAT_REMOVE, POT_LAT_REWRITE, start);
     return 0;
 }
 
-#endif /* __SEG6_TLV_REMOVE_H */
\ No newline at end of file
+#endif /* __SEG6_TLV_REMOVE_H */
@@ -8,37 +8,274 @@
 #include <bpf/bpf_helpers.h>
 
 #include "hdr.h"
+#include "sid.h"
+#if POT_CSID
+#include "csid.h"
+#endif
 #include "tlv.h"
+#include "crypto/keys.h"
+#include "pot/hopts.h"
+#include "pot/limit.h"
+#include "pot/pipeline.h"
 
-static __always_inline int update_pot_tlv(struct xdp_md *ctx)
+/*
+    Structural checks of the SRH and the PoT TLV, every one of them is cheaper
+    than a key lookup. The TLV is found by walking the TLVs after the SID list,
+    where add_pot_tlv inserts it, others like the HMAC one may come with it.
+*/
+static __always_inline int check_pot_srh(void *data, void *end, const struct pot_hdrs *hdrs, __u32 *tlv_offset)
 {
-    void *data = (void *)(long)ctx->data;
-    void *end = (void *)(long)ctx->data_end;
+    struct srh *srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
+        return -1;
 
-    struct srh *srh = SRH_HDR_PTR;
+    if (srh->routing_type != SRH_ROUTING_HEADER_TYPE) {
+        bpf_printk("[seg6_pot_tlv][-] Unexpected routing type %u", srh->routing_type);
+        return -1;
+    }
 
-    if (recalc_ctx_tlv_len(ctx, POT_TLV_EXT_LEN) < 0) {
-        bpf_printk("[seg6_pot_tlv][-] recalc_ctx_tlv_len failed");
+    __u32 segment_size = (__u32)srh->last_entry + 1;
+    if (segment_size > SRH_MAX_ALLOWED_SEGMENTS || srh->segments_left > srh->last_entry) {
+        bpf_printk("[seg6_pot_tlv][-] Invalid SRH last entry %u, segments left %u", srh->last_entry, srh->segments_left);
         return -1;
     }
 
-    struct pot_tlv *tlv = SRH_HDR_PTR + srh_hdr_len(srh);
-    if (SRH_HDR_PTR + srh_hdr_len(srh) + POT_TLV_WIRE_LEN > end) {
-        bpf_printk("[seg6_pot_tlv][-] invalid offset on packet buffer for TLV");
+    if (srh_hdr_len(srh) < SRH_HDR_LEN(segment_size) + POT_TLV_WIRE_LEN) {
+        bpf_printk("[seg6_pot_tlv][-] SRH hdr_ext_len %u doesn't fit %u SIDs and the TLV", srh->hdr_ext_len, segment_size);
         return -1;
     }
 
-    if (compute_witness_once(tlv, srh, end) < 0) {
-        bpf_printk("[seg6_pot_tlv][-] compute_witness failed");
+    if (find_pot_tlv(data, end, hdrs, tlv_offset) < 0)
         return -1;
+
+    if (*tlv_offset > POT_MAX_TLV_OFFSET) {
+        bpf_printk("[seg6_pot_tlv][-] PoT TLV behind more than %u bytes of TLVs", POT_MAX_TLV_AREA);
+        return -1;
+    }
+
+    return 0;
+}
+
+#if POT_CSID
+/*
+    Keys of a compressed path, one per C-SID. Transit nodes take the active
+    C-SID from the destination address. The endpoint walks the containers in
+    path order and sets the chain to run over every C-SID of them.
+*/
+static __always_inline int fetch_csid_keys(void *data, void *end, struct pot_scratch *scratch, __u32 endpoint, void *keys)
+{
+    struct ipv6hdr *ipv6 = ip6_hdr_at(data, end, &scratch->hdrs);
+    if (!ipv6)
+        return -1;
+
+    struct srh *srh = srh_hdr_at(data, end, &scratch->hdrs);
+    if (!srh)
+        return -1;
+
+    __u32 last_entry = srh->last_entry;
+    struct in6_addr sid;
+
+    if (!endpoint) {
+        __u32 active = srh->segments_left;
+        if (active >= SEG6_MAX_KEYS)
+            return -1;
+
+        csid_sid(ipv6->daddr.s6_addr, 0, &sid);
+        return fetch_key(keys, &sid, &scratch->keys[active]);
+    }
+
+    __u32 count = 0;
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < SRH_MAX_ALLOWED_SEGMENTS; i++) {
+        if (i > last_entry)
+            break;
+
+        __u8 *container = (void *)srh + SRH_FIXED_HDR_LEN + (IPV6_LEN * i);
+        if ((void *)container + IPV6_LEN > end)
+            return -1;
+
+        count += csid_count(container);
     }
 
-    if (reverse_recalc_ctx_tlv_len(ctx, POT_TLV_EXT_LEN) < 0) {
-        bpf_printk("[seg6_pot_tlv][-] reverse_recalc_ctx_tlv_len failed");
+    if (count == 0 || count > SEG6_MAX_KEYS) {
+        bpf_printk("[seg6_pot_tlv][-] Unsupported number of C-SIDs %u", count);
         return -1;
     }
 
+    // Segments are stored in reverse order, the first C-SID of the path gets the last key
+    __u32 idx = count;
+#pragma clang loop unroll(full)
+    for (__s32 i = SRH_MAX_ALLOWED_SEGMENTS - 1; i >= 0; i--) {
+        if ((__u32)i > last_entry)
+            continue;
+
+        __u8 *container = (void *)srh + SRH_FIXED_HDR_LEN + (IPV6_LEN * (__u32)i);
+        if ((void *)container + IPV6_LEN > end)
+            return -1;
+
+#pragma clang loop unroll(full)
+        for (__u32 j = 0; j < CSID_PER_CONTAINER; j++) {
+            if (csid_is_zero(container + CSID_LB_LEN + (CSID_LEN * j)))
+                break;
+            if (idx == 0 || idx > SEG6_MAX_KEYS)
+                return -1;
+
+            csid_sid(container, j, &sid);
+            if (fetch_key(keys, &sid, &scratch->keys[--idx]) < 0)
+                return -1;
+        }
+    }
+
+    scratch->chain_idx = (__s32)count - 1;
+    return 0;
+}
+#endif
+
+/* A missing key fails the packet here, before the first keyed-hash is spent on it */
+static __always_inline int fetch_pot_keys(void *data, void *end, struct pot_scratch *scratch, __u32 endpoint, __u32 ifindex)
+{
+    struct srh *srh = srh_hdr_at(data, end, &scratch->hdrs);
+    if (!srh)
+        return -1;
+
+    // Every key of the packet comes from the same set, the one of its ingress interface
+    void *keys = pot_keys_active(ifindex);
+    if (!keys)
+        return -1;
+
+#if POT_CSID
+    if (fetch_csid_keys(data, end, scratch, endpoint, keys) < 0)
+        return -1;
+#else
+    __u32 segment_size = (__u32)srh->last_entry + 1;
+    __u32 active = srh->segments_left;
+    struct in6_addr sid;
+
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < SEG6_MAX_KEYS; i++) {
+        if (i >= segment_size)
+            break;
+        if (!endpoint && i != active)
+            continue;
+
+        void *segment = (void *)srh + SRH_FIXED_HDR_LEN + (IPV6_LEN * i);
+        if (segment + IPV6_LEN > end)
+            return -1;
+
+        __builtin_memcpy(&sid, segment, IPV6_LEN);
+        if (fetch_key(keys, &sid, &scratch->keys[i]) < 0)
+            return -1;
+    }
+#endif
+
+#if ISADDR
+    if (endpoint) {
+        struct ipv6hdr *ipv6 = ip6_hdr_at(data, end, &scratch->hdrs);
+        if (!ipv6)
+            return -1;
+
+        struct in6_addr saddr;
+        __builtin_memcpy(&saddr, &ipv6->saddr, IPV6_LEN);
+        if (fetch_key(keys, &saddr, &scratch->src_key) < 0)
+            return -1;
+    }
+#endif
+
+    return 0;
+}
+
+static __always_inline int parse_pot_tlv(void *data, void *end, const struct pot_hdrs *hdrs, struct pot_scratch *scratch, __u32 endpoint, __u32 ifindex)
+{
+    scratch->path.role = POT_PATH_NONE;
+    scratch->hdrs = *hdrs;
+
+    // Garbage must be rejected before it costs a keyed-hash
+    __u32 tlv_offset = 0;
+    if (check_pot_srh(data, end, hdrs, &tlv_offset) < 0)
+        return -1;
+
+    // Failures from here on are accounted to the path
+    if (endpoint)
+        pot_path_hash(data, end, hdrs, POT_PATH_EGRESS, &scratch->path);
+
+    // A throttled source doesn't get its keys looked up either
+    if (endpoint && pot_limit_check(data, end, hdrs) < 0)
+        return -1;
+
+    POT_LAT_START(lookup_start);
+    if (fetch_pot_keys(data, end, scratch, endpoint, ifindex) < 0)
+        return -1;
+    POT_LAT_RECORD(endpoint ? POT_LAT_REMOVE : POT_LAT_UPDATE, POT_LAT_KEY_LOOKUP, lookup_start);
+
+    struct srh *srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
+        return -1;
+
+    scratch->tlv_offset = tlv_offset;
+    scratch->srh_len = srh_hdr_len(srh);
+    scratch->endpoint = endpoint;
+
+    struct pot_tlv *tlv = pot_scratch_tlv(scratch, data, end);
+    if (!tlv)
+        return -1;
+
+#if POT_HOPTS
+    if (!(tlv->reserved & bpf_htons(POT_TLV_F_HOPTS))) {
+        bpf_printk("[seg6_pot_tlv][-] PoT TLV without hop timestamps");
+        return -1;
+    }
+#endif
+
+    if (!endpoint)
+        return 0;
+
+    scratch->segment_size = calc_segment_size(srh, end);
+    if (scratch->segment_size == 0)
+        return -1;
+
+#if !POT_CSID
+    // Set by fetch_csid_keys otherwise, the chain runs over C-SIDs, not containers
+    scratch->chain_idx = (__s32)scratch->segment_size - 1;
+#endif
+
+    dup_tlv_nonce(tlv, &scratch->recursive_tlv);
+    bpf_printk("[seg6_pot_tlv][*] Recursive recalculation of PoT digest");
+
+#if ISADDR
+    hash_witness(&scratch->recursive_tlv, scratch->src_key.key, POT_LAT_REMOVE);
+#endif
+
+    return 0;
+}
+
+static __always_inline int update_pot_tlv(void *data, void *end, struct pot_scratch *scratch)
+{
+    struct srh *srh = srh_hdr_at(data, end, &scratch->hdrs);
+    if (!srh)
+        return -1;
+
+    struct pot_tlv *tlv = pot_scratch_tlv(scratch, data, end);
+    if (!tlv)
+        return -1;
+
+    __u32 idx = srh->segments_left;
+    if (idx >= SEG6_MAX_KEYS)
+        return -1;
+
+#if POT_HOPTS
+    // One clock read per hop, the endpoint keeps it for the delays and folds the head-end slot
+    __be32 now = pot_hop_now();
+    if (scratch->endpoint)
+        scratch->hop_arrival = now;
+    else
+        tlv->hop_ts[idx] = now;
+    pot_hop_fold(tlv, idx);
+#endif
+
+    // The witness is rewritten in place, nothing else of the packet changes
+    hash_witness(tlv, scratch->keys[idx].key, POT_LAT_UPDATE);
+
     return 0;
 }
 
-#endif /* __SEG6_TLV_UPDATE_H */
\ No newline at end of file
+#endif /* __SEG6_TLV_UPDATE_H */
@@ -0,0 +1,85 @@
+#ifndef __SEG6_TLV_VLAN_H
+#define __SEG6_TLV_VLAN_H
+
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+
+#include "hdr.h"
+
+/*
+    bpf_skb_adjust_room refuses an skb whose protocol isn't IPv6, which it
+    isn't while VLAN tags are still in the frame: QinQ, or 802.1Q with the
+    VLAN offload off. The tags are popped into the skb, outermost first,
+    until the IPv6 header follows the Ethernet one, and pushed back once the
+    packet is resized.
+*/
+struct pot_vlan_stack {
+    __u32 depth;
+    __be16 proto[POT_MAX_VLAN_TAGS];
+    __u16 tci[POT_MAX_VLAN_TAGS];
+};
+
+/* Moves the offsets of hdrs along with the frame, returns the bytes of tags it lost */
+static __always_inline int pot_vlan_untag(struct __sk_buff *skb, struct pot_hdrs *hdrs, struct pot_vlan_stack *stack)
+{
+    stack->depth = 0;
+    if (skb->protocol == bpf_htons(ETH_P_IPV6))
+        return 0;
+
+    __u32 tags_len = hdrs->ip6_offset - (__u32)ETH_HDR_LEN;
+    if (hdrs->ip6_offset < ETH_HDR_LEN || tags_len > VLAN_HDR_LEN * POT_MAX_VLAN_TAGS)
+        return -1;
+
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < POT_MAX_VLAN_TAGS; i++) {
+        if (skb->protocol == bpf_htons(ETH_P_IPV6))
+            break;
+
+        // The outermost tag is either held by the skb or the first one of the frame
+        if (skb->vlan_present) {
+            stack->proto[i] = (__be16)skb->vlan_proto;
+            stack->tci[i] = (__u16)skb->vlan_tci;
+        } else {
+            void *data = (void *)(long)skb->data;
+            void *end = (void *)(long)skb->data_end;
+
+            struct ethhdr *eth = data;
+            struct pot_vlan_hdr *vlan = data + ETH_HDR_LEN;
+            if ((void *)vlan + VLAN_HDR_LEN > end)
+                return -1;
+
+            stack->proto[i] = eth->h_proto;
+            stack->tci[i] = bpf_ntohs(vlan->tci);
+        }
+
+        if (bpf_skb_vlan_pop(skb) < 0)
+            return -1;
+        stack->depth = i + 1;
+    }
+
+    if (skb->protocol != bpf_htons(ETH_P_IPV6))
+        return -1;
+
+    hdrs->ip6_offset -= tags_len;
+    hdrs->srh_offset -= tags_len;
+    return (int)tags_len;
+}
+
+/* Innermost first, each push moves the tag the skb held into the frame */
+static __always_inline int pot_vlan_retag(struct __sk_buff *skb, const struct pot_vlan_stack *stack)
+{
+#pragma clang loop unroll(full)
+    for (__u32 i = POT_MAX_VLAN_TAGS; i > 0; i--) {
+        if (i > stack->depth)
+            continue;
+        if (bpf_skb_vlan_push(skb, stack->proto[i - 1], stack->tci[i - 1]) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+#endif /* __SEG6_TLV_VLAN_H */
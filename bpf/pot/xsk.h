@@ -0,0 +1,37 @@
+#ifndef __SEG6_TLV_XSK_H
+#define __SEG6_TLV_XSK_H
+
+#include <linux/bpf.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_helpers.h>
+
+#define POT_MAX_QUEUES 64
+
+/*
+    AF_XDP sockets of seg6-pot-xsk by receive queue. The engine finds the map
+    through the XDP program of its interface, a socket only receives from the
+    queue it is bound to, so it is never pinned.
+*/
+struct {
+    __uint(type, BPF_MAP_TYPE_XSKMAP);
+    __uint(max_entries, POT_MAX_QUEUES);
+    __type(key, __u32);
+    __type(value, __u32);
+} seg6_pot_xsks SEC(".maps");
+
+/*
+    Hands the packet to the engine bound to its receive queue. Returns -1
+    when no socket is bound there, the datapath then validates it itself.
+*/
+static __always_inline int pot_xsk_redirect(struct xdp_md *ctx)
+{
+    __u32 queue = ctx->rx_queue_index;
+
+    if (!bpf_map_lookup_elem(&seg6_pot_xsks, &queue))
+        return -1;
+
+    return (int)bpf_redirect_map(&seg6_pot_xsks, queue, XDP_DROP);
+}
+
+#endif /* __SEG6_TLV_XSK_H */
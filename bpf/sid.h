@@ -18,21 +18,22 @@ struct {
     __type(value, struct in6_addr[SRH_MAX_ALLOWED_SEGMENTS]);
 } sidmap SEC(".maps");
 
+/* SIDs of the list, the SRH may also carry TLVs after them */
 static __always_inline __u32 calc_segment_size(struct srh *srh, void *end)
 {
-    __u32 segment_size = srh_hdr_len(srh) / IPV6_LEN;
-    if ((void *)((__u8 *)srh + SRH_HDR_LEN(segment_size)) > end) {
-        bpf_printk("[seg6_pot_tlv][-] SRH segments out-of-bounds");
+    __u32 segment_size = (__u32)srh->last_entry + 1;
+    if (segment_size > SRH_MAX_ALLOWED_SEGMENTS) {
+        bpf_printk("[seg6_pot_tlv][-] Too many SRH segments: %u\n", segment_size);
         return 0;
     }
 
-    if (srh->hdr_ext_len & 1) {
-        bpf_printk("[seg6_pot_tlv][-] SRH hdr_ext_len isn't even");
+    if (SRH_HDR_LEN(segment_size) > srh_hdr_len(srh)) {
+        bpf_printk("[seg6_pot_tlv][-] SRH hdr_ext_len %u doesn't fit %u SIDs", srh->hdr_ext_len, segment_size);
         return 0;
     }
 
-    if (segment_size > SRH_MAX_ALLOWED_SEGMENTS) {
-        bpf_printk("[seg6_pot_tlv][-] Too many SRH segments: %u\n", segment_size);
+    if ((void *)((__u8 *)srh + SRH_HDR_LEN(segment_size)) > end) {
+        bpf_printk("[seg6_pot_tlv][-] SRH segments out-of-bounds");
         return 0;
     }
 
@@ -1,7 +1,9 @@
 #ifndef __SEG6_SRH_H
 #define __SEG6_SRH_H
 
+#include <linux/if_ether.h>
 #include <linux/in6.h>
+#include <linux/ipv6.h>
 #include <linux/types.h>
 
 #include <bpf/bpf_endian.h>
@@ -66,9 +68,85 @@ static __always_inline int srh_hdr_cb(struct srh *srh, void *end)
     return 0;
 }
 
-static __always_inline __u32 tlv_hdr_offset(struct srh *srh)
+static __always_inline struct srh *srh_hdr_at(void *data, void *end, const struct pot_hdrs *hdrs)
 {
-    return ETH_HDR_LEN + IPV6_HDR_LEN + SRH_FIXED_HDR_LEN + srh_hdr_len(srh);
+    __u32 off = hdrs->srh_offset;
+    if (off > POT_MAX_SRH_OFFSET)
+        return NULL;
+
+    struct srh *srh = data + off;
+    if (srh_hdr_cb(srh, end) < 0)
+        return NULL;
+    return srh;
+}
+
+#define POT_HDRS_NOT_SRV6 -1 // Left alone
+#define POT_HDRS_TOO_DEEP -2  // Options headers past the walk, an SRH may still follow them
+
+/*
+    Bounded walk from the Ethernet header to the SRH, once per packet: up to
+    two VLAN tags (802.1Q, or 802.1ad then 802.1Q), the IPv6 header and up to
+    two Hop-by-Hop or Destination Options headers. Returns POT_HDRS_NOT_SRV6
+    for anything that isn't an SRv6 packet, and POT_HDRS_TOO_DEEP when more
+    or longer options headers hide what follows them, the validators drop
+    those rather than let an SRv6 packet through unchecked.
+*/
+static __always_inline int parse_srv6_hdrs(void *data, void *end, struct pot_hdrs *hdrs)
+{
+    struct ethhdr *eth = ETH_HDR_PTR;
+    if (eth_hdr_cb(eth, end) < 0)
+        return POT_HDRS_NOT_SRV6;
+
+    __be16 proto = eth->h_proto;
+    __u32 off = ETH_HDR_LEN;
+
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < POT_MAX_VLAN_TAGS; i++) {
+        if (proto != bpf_htons(ETH_P_8021Q) && proto != bpf_htons(ETH_P_8021AD))
+            break;
+
+        struct pot_vlan_hdr *vlan = data + off;
+        if ((void *)vlan + VLAN_HDR_LEN > end)
+            return POT_HDRS_NOT_SRV6;
+
+        proto = vlan->proto;
+        off += VLAN_HDR_LEN;
+    }
+
+    if (proto != bpf_htons(ETH_P_IPV6))
+        return POT_HDRS_NOT_SRV6;
+
+    struct ipv6hdr *ip6 = data + off;
+    if (ip6_hdr_cb(ip6, end) < 0)
+        return POT_HDRS_NOT_SRV6;
+
+    hdrs->ip6_offset = off;
+    __u8 nexthdr = ip6->nexthdr;
+    off += IPV6_HDR_LEN;
+
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < POT_MAX_EXT_HDRS; i++) {
+        if (nexthdr != IPPROTO_HOPOPTS && nexthdr != IPPROTO_DSTOPTS)
+            break;
+
+        __u8 *ext = data + off;
+        if ((void *)ext + 2 > end)
+            return POT_HDRS_NOT_SRV6;
+
+        nexthdr = ext[0];
+        off += ((__u32)ext[1] + 1) * HDR_BYTE_SIZE;
+        if (off > POT_MAX_SRH_OFFSET)
+            return POT_HDRS_TOO_DEEP;
+    }
+
+    if (nexthdr == IPPROTO_HOPOPTS || nexthdr == IPPROTO_DSTOPTS)
+        return POT_HDRS_TOO_DEEP;
+
+    if (nexthdr != SRH_NEXT_HEADER)
+        return POT_HDRS_NOT_SRV6;
+
+    hdrs->srh_offset = off;
+    return 0;
 }
 
 static __always_inline int seg6_first_sid(struct srh *srh)
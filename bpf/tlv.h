@@ -9,12 +9,24 @@
 
 #include "crypto/nonce.h"
 #include "exp.h"
+#include "sid.h"
 #include "srh.h"
 #include "hdr.h"
 
-/* PoT TLV properties*/
-#define POT_TLV_TYPE 0x04u
+/* SRH TLV types of RFC 8754 */
+#define SRH_TLV_PAD1 0x00u
+#define SRH_TLV_PADN 0x04u
+#define SRH_TLV_HMAC 0x05u
+
+/* PoT TLV properties, an experimental type of the range whose data may change en route */
+#define POT_TLV_TYPE 0xFCu
+#define POT_TLV_F_HOPTS 0x4000u // A timestamp slot per SID follows the witness
+#if POT_HOPTS
+#define POT_TLV_FLAGS POT_TLV_F_HOPTS
+#define POT_HOP_SLOTS SRH_MAX_ALLOWED_SEGMENTS // One per SID, indexed like the keys
+#else
 #define POT_TLV_FLAGS 0x0000u
+#endif
 #define POT_TLV_WIRE_LEN sizeof(struct pot_tlv)
 #define POT_TLV_LEN (POT_TLV_WIRE_LEN - 2)
 #define POT_TLV_EXT_LEN (POT_TLV_WIRE_LEN / HDR_BYTE_SIZE)
@@ -51,6 +63,12 @@ Define the custom TLV structure for proof-of-transit using BLAKE3.
 |                       Witness (64-256b)                        |
 |                            ...                                 |
 +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-
+|              Hop timestamps (8 x 32b, HOPTS=1 only)            |
+|                            ...                                 |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-
+
+    Slot i of the timestamps is written by the SID at segments left i, slot
+    0 by the head-end, with the low 32 bits of its TAI clock in ns.
 */
 struct pot_tlv {
     __u8 type;
@@ -58,8 +76,84 @@ struct pot_tlv {
     __u16 reserved;
     __u8 nonce[NONCE_LEN];
     __u8 witness[DIGEST_LEN];
+#if POT_HOPTS
+    __be32 hop_ts[POT_HOP_SLOTS];
+#endif
 } __attribute__((packed));
 
+#define POT_MAX_SRH_TLVS 8 // TLVs walked after the SID list, padding included
+#define POT_MAX_TLV_AREA 128 // Bytes of other TLVs accepted in front of the PoT one
+
+/*
+    Single pass over the TLVs after the SID list, RFC 8754 section 2.1. Pad1 is
+    a lone byte, every other TLV a type, a length and that many bytes, and the
+    last one must end with the SRH. The PoT TLV may come anywhere among them,
+    once, and the packet is never written to find it. Sets the offset of the
+    PoT TLV from data.
+*/
+static __always_inline int find_pot_tlv(void *data, void *end, const struct pot_hdrs *hdrs, __u32 *tlv_offset)
+{
+    struct srh *srh = srh_hdr_at(data, end, hdrs);
+    if (!srh)
+        return -1;
+
+    __u32 srh_offset = hdrs->srh_offset;
+    __u32 off = srh_offset + (__u32)SRH_HDR_LEN((__u32)srh->last_entry + 1);
+    __u32 srh_end = srh_offset + srh_hdr_len(srh);
+    __u32 found = 0;
+
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < POT_MAX_SRH_TLVS; i++) {
+        if (off >= srh_end)
+            break;
+
+        // Keeps data + off tracked by the verifier, the SRH can't be longer
+        if (off > POT_MAX_SRH_OFFSET + SRH_FIXED_HDR_LEN + 255 * HDR_BYTE_SIZE)
+            return -1;
+
+        __u8 *tlv = data + off;
+        if ((void *)tlv + 1 > end)
+            return -1;
+
+        if (tlv[0] == SRH_TLV_PAD1) {
+            off++;
+            continue;
+        }
+
+        if ((void *)tlv + 2 > end)
+            return -1;
+
+        __u32 next = off + 2 + tlv[1];
+        if (next > srh_end) {
+            bpf_printk("[seg6_pot_tlv][-] SRH TLV type %u overruns the SRH", tlv[0]);
+            return -1;
+        }
+
+        if (tlv[0] == POT_TLV_TYPE) {
+            if (found || tlv[1] != POT_TLV_LEN) {
+                bpf_printk("[seg6_pot_tlv][-] Unexpected PoT TLV length %u or duplicate", tlv[1]);
+                return -1;
+            }
+            *tlv_offset = off;
+            found = 1;
+        }
+
+        off = next;
+    }
+
+    if (off < srh_end) {
+        bpf_printk("[seg6_pot_tlv][-] More than %u SRH TLVs", POT_MAX_SRH_TLVS);
+        return -1;
+    }
+
+    if (!found) {
+        bpf_printk("[seg6_pot_tlv][-] No PoT TLV in the SRH");
+        return -1;
+    }
+
+    return 0;
+}
+
 static __always_inline void compute_tlv(struct pot_tlv *tlv, const __u8 key[32])
 {
 #if POLY1305
@@ -83,6 +177,21 @@ static __always_inline void compute_tlv(struct pot_tlv *tlv, const __u8 key[32])
 #endif
 }
 
+#if POT_HOPTS
+/* Mixes the timestamp of slot idx into the witness, the next keyed-hash then covers it */
+static __always_inline void pot_hop_fold(struct pot_tlv *tlv, __u32 idx)
+{
+    if (idx >= POT_HOP_SLOTS)
+        return;
+
+    __u8 ts[sizeof(__be32)];
+    __builtin_memcpy(ts, &tlv->hop_ts[idx], sizeof(ts));
+#pragma clang loop unroll(full)
+    for (__u32 i = 0; i < sizeof(ts); i++)
+        tlv->witness[i] ^= ts[i];
+}
+#endif
+
 static __always_inline int compare_pot_digest(const struct pot_tlv *x, const struct pot_tlv *y)
 {
     if (__builtin_memcmp(x->witness, y->witness, DIGEST_LEN) == 0)
@@ -96,9 +205,12 @@ static __always_inline void init_tlv(struct pot_tlv *tlv)
 {
     tlv->type= POT_TLV_TYPE;
     tlv->length = POT_TLV_LEN;
-    tlv->reserved = POT_TLV_FLAGS;
+    tlv->reserved = bpf_htons(POT_TLV_FLAGS);
     new_nonce(tlv->nonce);
     __builtin_memset(tlv->witness, 0, sizeof(tlv->witness));
+#if POT_HOPTS
+    __builtin_memset(tlv->hop_ts, 0, sizeof(tlv->hop_ts));
+#endif
 
     if (sizeof(tlv) % HDR_BYTE_SIZE != 0)
         bpf_printk("[seg6_pot_tlv][*] warning: TLV length %d not multiple of %d for SRH update", sizeof(tlv), HDR_BYTE_SIZE);
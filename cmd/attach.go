@@ -0,0 +1,319 @@
+package main
+
+import (
+	"errors"
+	"fmt"
+	"net"
+	"os"
+	"path/filepath"
+	"syscall"
+	"time"
+
+	bpf "github.com/aquasecurity/libbpfgo"
+	"github.com/cilium/ebpf"
+	"github.com/cilium/ebpf/link"
+)
+
+const defaultPinDir = "/sys/fs/bpf/seg6_pot"
+
+// Mirrors BPF_FS_MAGIC of linux/magic.h
+const bpffsMagic = 0xcafe4a11
+
+// Attach modes of the validation pipeline, see --mode
+const (
+	modeAuto       = "auto"
+	modeXDP        = "xdp"
+	modeXDPGeneric = "xdp-generic"
+	modeTC         = "tc"
+)
+
+var attachModes = []string{modeAuto, modeXDP, modeXDPGeneric, modeTC}
+
+// Links created on each interface, also the names of their pins and of the
+// pinned entry programs
+const (
+	linkXDP       = "xdp"
+	linkTcIngress = "tc_ingress"
+	linkTcEgress  = "tc_egress"
+)
+
+var linkKinds = []string{linkXDP, linkTcIngress, linkTcEgress}
+
+// Tail call maps of the pipeline. The kernel empties a prog array once no
+// fd or pin refers to it, so they are pinned with the links
+var stageMaps = []string{"seg6_pot_stages", "seg6_pot_tc_stages"}
+
+// Time the programs replaced by an upgrade may still be running a packet
+// before their stage maps are unpinned and emptied
+const upgradeGrace = 100 * time.Millisecond
+
+func validAttachMode(mode string) bool {
+	for _, m := range attachModes {
+		if m == mode {
+			return true
+		}
+	}
+	return false
+}
+
+// pipeline holds the entry programs of one loaded object by link kind and its
+// stage maps, as cilium/ebpf objects since it owns the bpf_link API
+type pipeline struct {
+	progs  map[string]*ebpf.Program
+	stages map[string]*ebpf.Map
+}
+
+func newPipeline(module *bpf.Module, xdpEntry string) (*pipeline, error) {
+	p := &pipeline{progs: map[string]*ebpf.Program{}, stages: map[string]*ebpf.Map{}}
+	entries := map[string]string{
+		linkXDP:       xdpEntry,
+		linkTcIngress: "seg6_pot_tlv_i",
+		linkTcEgress:  "seg6_pot_tlv",
+	}
+
+	for kind, name := range entries {
+		prog, err := module.GetProgram(name)
+		if err != nil || prog == nil {
+			p.Close()
+			return nil, fmt.Errorf("get program %s: %w", name, err)
+		}
+		fd, err := dupFD(prog.FileDescriptor())
+		if err != nil {
+			p.Close()
+			return nil, fmt.Errorf("program %s: %w", name, err)
+		}
+		if p.progs[kind], err = ebpf.NewProgramFromFD(fd); err != nil {
+			p.Close()
+			return nil, fmt.Errorf("program %s: %w", name, err)
+		}
+	}
+
+	for _, name := range stageMaps {
+		m, err := module.GetMap(name)
+		if err != nil {
+			p.Close()
+			return nil, fmt.Errorf("get map %s: %w", name, err)
+		}
+		fd, err := dupFD(m.FileDescriptor())
+		if err != nil {
+			p.Close()
+			return nil, fmt.Errorf("map %s: %w", name, err)
+		}
+		if p.stages[name], err = ebpf.NewMapFromFD(fd); err != nil {
+			p.Close()
+			return nil, fmt.Errorf("map %s: %w", name, err)
+		}
+	}
+	return p, nil
+}
+
+func (p *pipeline) Close() {
+	for _, prog := range p.progs {
+		prog.Close()
+	}
+	for _, m := range p.stages {
+		m.Close()
+	}
+}
+
+// dupFD lets cilium/ebpf own its own copy of a descriptor libbpfgo closes
+func dupFD(fd int) (int, error) {
+	dup, err := syscall.Dup(fd)
+	if err != nil {
+		return -1, fmt.Errorf("dup fd: %w", err)
+	}
+	syscall.CloseOnExec(dup)
+	return dup, nil
+}
+
+// attachInterface links the tc egress program and the validator to iface and
+// returns the links by kind with the mode the validator ended up in
+func attachInterface(p *pipeline, iface, mode string) (map[string]link.Link, string, error) {
+	ifc, err := net.InterfaceByName(iface)
+	if err != nil {
+		return nil, "", err
+	}
+
+	egress, err := link.AttachTCX(link.TCXOptions{
+		Interface: ifc.Index,
+		Program:   p.progs[linkTcEgress],
+		Attach:    ebpf.AttachTCXEgress,
+	})
+	if err != nil {
+		return nil, "", fmt.Errorf("tc egress attach: %w", err)
+	}
+
+	validator, used, err := attachValidator(p, ifc, mode)
+	if err != nil {
+		egress.Close()
+		return nil, "", err
+	}
+
+	kind := linkXDP
+	if used == modeTC {
+		kind = linkTcIngress
+	}
+	return map[string]link.Link{linkTcEgress: egress, kind: validator}, used, nil
+}
+
+// attachValidator attaches the validation pipeline to ifc and returns the
+// mode it ended up in. Whether a driver runs XDP natively is only known by
+// trying it, so auto attempts native XDP first and falls back to tc ingress,
+// which beats generic XDP since both run on an skb anyway.
+func attachValidator(p *pipeline, ifc *net.Interface, mode string) (link.Link, string, error) {
+	if mode == modeAuto {
+		l, err := attachXDP(p, ifc, link.XDPDriverMode)
+		if err == nil {
+			return l, modeXDP, nil
+		}
+		fmt.Printf("[*] Native XDP unavailable on %s (%v), falling back to tc\n", ifc.Name, err)
+		mode = modeTC
+	}
+
+	switch mode {
+	case modeXDP:
+		l, err := attachXDP(p, ifc, link.XDPDriverMode)
+		return l, mode, err
+	case modeXDPGeneric:
+		l, err := attachXDP(p, ifc, link.XDPGenericMode)
+		return l, mode, err
+	default:
+		l, err := link.AttachTCX(link.TCXOptions{
+			Interface: ifc.Index,
+			Program:   p.progs[linkTcIngress],
+			Attach:    ebpf.AttachTCXIngress,
+		})
+		if err != nil {
+			return nil, mode, fmt.Errorf("tc ingress attach: %w", err)
+		}
+		return l, mode, nil
+	}
+}
+
+func attachXDP(p *pipeline, ifc *net.Interface, flags link.XDPAttachFlags) (link.Link, error) {
+	l, err := link.AttachXDP(link.XDPOptions{
+		Program:   p.progs[linkXDP],
+		Interface: ifc.Index,
+		Flags:     flags,
+	})
+	if err != nil {
+		return nil, fmt.Errorf("attach XDP ingress: %w", err)
+	}
+	return l, nil
+}
+
+// pinLinks pins the links of iface under <dir>/links/<iface>/<kind>
+func pinLinks(dir, iface string, links map[string]link.Link) error {
+	ifaceDir := filepath.Join(dir, "links", iface)
+	if err := os.MkdirAll(ifaceDir, 0700); err != nil {
+		return err
+	}
+	for kind, l := range links {
+		if err := l.Pin(filepath.Join(ifaceDir, kind)); err != nil {
+			return fmt.Errorf("pin %s link: %w", kind, err)
+		}
+	}
+	return nil
+}
+
+// pinPipeline pins the entry programs under <dir>/progs and the stage maps
+// under <dir>/maps, replacing the pins of a previous load
+func pinPipeline(dir string, p *pipeline) error {
+	for _, sub := range []string{"progs", "maps"} {
+		if err := os.MkdirAll(filepath.Join(dir, sub), 0700); err != nil {
+			return err
+		}
+	}
+
+	for kind, prog := range p.progs {
+		path := filepath.Join(dir, "progs", kind)
+		if err := os.Remove(path); err != nil && !errors.Is(err, os.ErrNotExist) {
+			return err
+		}
+		if err := prog.Pin(path); err != nil {
+			return fmt.Errorf("pin %s program: %w", kind, err)
+		}
+	}
+
+	for name, m := range p.stages {
+		path := filepath.Join(dir, "maps", name)
+		if err := os.Remove(path); err != nil && !errors.Is(err, os.ErrNotExist) {
+			return err
+		}
+		if err := m.Pin(path); err != nil {
+			return fmt.Errorf("pin %s: %w", name, err)
+		}
+	}
+	return nil
+}
+
+// pinnedInterfaces lists the interfaces with links pinned under dir
+func pinnedInterfaces(dir string) ([]string, error) {
+	var statfs syscall.Statfs_t
+	if err := syscall.Statfs(dir, &statfs); err != nil {
+		return nil, err
+	}
+	if statfs.Type != bpffsMagic {
+		return nil, fmt.Errorf("%s is not on a bpffs", dir)
+	}
+
+	entries, err := os.ReadDir(filepath.Join(dir, "links"))
+	if err != nil {
+		return nil, fmt.Errorf("no links pinned under %s: %w", dir, err)
+	}
+
+	var ifaces []string
+	for _, entry := range entries {
+		if entry.IsDir() {
+			ifaces = append(ifaces, entry.Name())
+		}
+	}
+	return ifaces, nil
+}
+
+// upgradeLinks swaps the programs of every link pinned under dir for the ones
+// of p with bpf_link_update, the hook never runs without a program in between
+func upgradeLinks(dir string, p *pipeline) error {
+	ifaces, err := pinnedInterfaces(dir)
+	if err != nil {
+		return err
+	}
+
+	for _, iface := range ifaces {
+		for _, kind := range linkKinds {
+			l, err := link.LoadPinnedLink(filepath.Join(dir, "links", iface, kind), nil)
+			if errors.Is(err, os.ErrNotExist) {
+				continue
+			}
+			if err != nil {
+				return fmt.Errorf("load %s link of %s: %w", kind, iface, err)
+			}
+
+			err = l.Update(p.progs[kind])
+			l.Close()
+			if err != nil {
+				return fmt.Errorf("update %s link of %s: %w", kind, iface, err)
+			}
+			fmt.Printf("[+] Upgraded %s on %s\n", kind, iface)
+		}
+	}
+
+	time.Sleep(upgradeGrace)
+	return pinPipeline(dir, p)
+}
+
+// unpinLinks detaches everything pinned under dir, a link goes away with
+// its last pin and fd
+func unpinLinks(dir string) error {
+	ifaces, err := pinnedInterfaces(dir)
+	if err != nil {
+		return err
+	}
+	if err := os.RemoveAll(dir); err != nil {
+		return err
+	}
+	for _, iface := range ifaces {
+		fmt.Printf("[+] Detached from %s\n", iface)
+	}
+	return nil
+}
@@ -0,0 +1,356 @@
+package main
+
+import (
+	"bytes"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"net"
+	"os"
+	"path/filepath"
+	"strings"
+	"text/tabwriter"
+	"time"
+
+	"github.com/cilium/ebpf"
+)
+
+const (
+	tcActOK = 0
+
+	// Packets of each case, run one by one since every run rewrites its packet
+	benchRuns = 10000
+)
+
+// benchCase is one kind of packet run through one entry program
+type benchCase struct {
+	Name     string
+	Program  string
+	Frame    []byte
+	Verdict  uint32
+	Accounts bool // Expected to update seg6_pot_paths once per packet
+	Tenants  int  // Tenants bound to interfaces, the packet's one among them
+}
+
+// benchResult is the datapath cost of one case of an object. Accounted is the
+// number of packets found in seg6_pot_paths afterwards, -1 for objects without it.
+type benchResult struct {
+	Object    string  `json:"object"`
+	Case      string  `json:"case"`
+	Runs      int     `json:"runs"`
+	MeanNs    float64 `json:"mean_ns"`
+	Accounted int64   `json:"accounted"`
+	Error     string  `json:"error,omitempty"`
+}
+
+// benchPath is the path of the packets of an object: its SIDs in path order,
+// each holding a key, and the packet sent to the SID of a hop
+type benchPath struct {
+	sids  []net.IP
+	frame func(hop int, tlv []byte) []byte
+}
+
+func vectorPath() benchPath {
+	n := len(vectorSIDs)
+	return benchPath{sids: vectorSIDs, frame: func(hop int, tlv []byte) []byte { return srv6Frame(n-1-hop, tlv) }}
+}
+
+// csidBenchPath is the path of vectorSIDs compressed into C-SIDs, for CSID=1 objects
+func csidBenchPath() benchPath {
+	var sids []net.IP
+	for _, c := range csidPath {
+		sids = append(sids, csidSID(c))
+	}
+	return benchPath{sids: sids, frame: func(hop int, tlv []byte) []byte { return csidFrame(csidPath, hop, tlv) }}
+}
+
+// testRunBench runs the head-end, transit and egress packets of testVectors
+// through every object with BPF_PROG_TEST_RUN and reports the mean time per
+// packet measured by the kernel, along with the packets accounted per path.
+// The transit and valid egress packets run once more behind an HMAC TLV, and
+// the egress ones with their keys taken from one of 1, 100 and 1000 tenants. With csid the objects are CSID=1 builds and the packets
+// carry the same path in C-SID containers.
+func testRunBench(outputPath string, objects []string, csid bool) error {
+	var results []benchResult
+
+	path := vectorPath()
+	if csid {
+		path = csidBenchPath()
+	}
+
+	if len(objects) == 0 {
+		r, err := objectBench(algorithm, fmt.Sprintf("seg6_pot_tlv_%s.o", algorithm), bpfObj, path)
+		if err != nil {
+			return err
+		}
+		results = append(results, r...)
+	}
+
+	for _, file := range objects {
+		obj, err := os.ReadFile(file)
+		if err != nil {
+			return fmt.Errorf("read object: %w", err)
+		}
+		algo := strings.TrimSuffix(strings.TrimPrefix(filepath.Base(file), "seg6_pot_tlv_"), ".o")
+		r, err := objectBench(algo, file, obj, path)
+		if err != nil {
+			return err
+		}
+		results = append(results, r...)
+	}
+
+	w := tabwriter.NewWriter(os.Stdout, 0, 0, 2, ' ', 0)
+	fmt.Fprintln(w, "OBJECT\tCASE\tRUNS\tNS/PACKET\tACCOUNTED")
+	for _, r := range results {
+		if r.Error != "" {
+			fmt.Fprintf(w, "%s\t%s\tFAILED: %s\n", r.Object, r.Case, r.Error)
+			continue
+		}
+		accounted := "-"
+		if r.Accounted >= 0 {
+			accounted = fmt.Sprint(r.Accounted)
+		}
+		fmt.Fprintf(w, "%s\t%s\t%d\t%.1f\t%s\n", r.Object, r.Case, r.Runs, r.MeanNs, accounted)
+	}
+	if err := w.Flush(); err != nil {
+		return err
+	}
+
+	if outputPath == "" {
+		return nil
+	}
+	raw, err := json.MarshalIndent(results, "", "  ")
+	if err != nil {
+		return err
+	}
+	if err := os.MkdirAll(filepath.Dir(outputPath), 0o755); err != nil {
+		return fmt.Errorf("create output dir: %w", err)
+	}
+	return os.WriteFile(outputPath, raw, 0o644)
+}
+
+func objectBench(algo, name string, obj []byte, path benchPath) ([]benchResult, error) {
+	wlen, ok := witnessLen[algo]
+	if !ok {
+		return nil, fmt.Errorf("%s: unknown algorithm %q", name, algo)
+	}
+
+	spec, err := ebpf.LoadCollectionSpecFromReader(bytes.NewReader(obj))
+	if err != nil {
+		return nil, fmt.Errorf("parse %s: %w", name, err)
+	}
+
+	// The timestamp slots of a HOPTS=1 object are carried along with the witness
+	hopTS = spec.Maps["seg6_pot_hop_delay"] != nil
+	if hopTS {
+		wlen += 4 * hopSlots
+	}
+
+	// Throwaway load: private maps only, nothing reaches the bpffs
+	for _, m := range spec.Maps {
+		m.Pinning = ebpf.PinNone
+	}
+
+	coll, err := ebpf.NewCollection(spec)
+	if err != nil {
+		return nil, fmt.Errorf("load %s: %w", name, err)
+	}
+	defer coll.Close()
+
+	xdp, keysMap := coll.Programs["seg6_pot_tlv_d"], coll.Maps["seg6_pot_keys"]
+	if xdp == nil || keysMap == nil {
+		return nil, fmt.Errorf("%s: missing seg6_pot_tlv_d or seg6_pot_keys", name)
+	}
+	keys := map[[16]byte][32]byte{}
+	for _, sid := range path.sids {
+		var s [16]byte
+		var k [32]byte
+		copy(s[:], sid.To16())
+		copy(k[:], randomBytes(32))
+		keys[s] = k
+		if err := keysMap.Update(s, k, ebpf.UpdateAny); err != nil {
+			return nil, fmt.Errorf("%s: set key of %s: %w", name, sid, err)
+		}
+	}
+
+	// Witness written by the transit hops, as received by the egress
+	n := len(path.sids)
+	nonce := randomBytes(potNonceLen)
+	witness := make([]byte, wlen)
+	for hop := 0; hop < n-1; hop++ {
+		frame := path.frame(hop, potTLV(nonce, witness))
+		data := make([]byte, 2048)
+		if _, err := xdp.Run(&ebpf.RunOptions{Data: frame, DataOut: data}); err != nil {
+			return nil, fmt.Errorf("%s: run hop %d: %w", name, hop, err)
+		}
+		// The TLV ends the SRH, right before the inner packet
+		off := len(frame) - ipv6HdrLen - udpHdrLen - 16 - wlen
+		witness = append([]byte(nil), data[off:][:wlen]...)
+	}
+	tampered := append([]byte(nil), witness...)
+	tampered[0] ^= 1
+
+	cases := []benchCase{
+		{Name: "headend", Program: "seg6_pot_tlv", Frame: path.frame(0, nil), Verdict: tcActOK, Accounts: true},
+		{Name: "transit", Program: "seg6_pot_tlv_d", Frame: path.frame(0, potTLV(nonce, make([]byte, wlen))), Verdict: xdpPass},
+		{Name: "egress-pass", Program: "seg6_pot_tlv_d", Frame: path.frame(n-1, potTLV(nonce, witness)), Verdict: xdpPass, Accounts: true},
+		{Name: "egress-drop", Program: "seg6_pot_tlv_d", Frame: path.frame(n-1, potTLV(nonce, tampered)), Verdict: xdpDrop, Accounts: true},
+	}
+	// An RFC 8754 HMAC TLV in front of the PoT one, the walker has to step over it
+	hmac := append([]byte{srhTLVHMAC, 38, 0, 0, 0, 0, 0, 1}, randomBytes(32)...)
+	cases = append(cases,
+		benchCase{Name: "transit-tlvs", Program: "seg6_pot_tlv_d",
+			Frame: path.frame(0, append(hmac, potTLV(nonce, make([]byte, wlen))...)), Verdict: xdpPass},
+		benchCase{Name: "egress-tlvs", Program: "seg6_pot_tlv_d",
+			Frame: path.frame(n-1, append(hmac, potTLV(nonce, witness)...)), Verdict: xdpPass, Accounts: true})
+	// Headers in front of the SRH, their parse against the fixed offsets of transit and egress-pass
+	transit, egress := path.frame(0, potTLV(nonce, make([]byte, wlen))), path.frame(n-1, potTLV(nonce, witness))
+	cases = append(cases,
+		benchCase{Name: "transit-vlan", Program: "seg6_pot_tlv_d", Frame: vlanFrame(transit, 100), Verdict: xdpPass},
+		benchCase{Name: "transit-qinq", Program: "seg6_pot_tlv_d", Frame: vlanFrame(transit, 10, 100), Verdict: xdpPass},
+		benchCase{Name: "transit-hbh", Program: "seg6_pot_tlv_d", Frame: hbhFrame(transit), Verdict: xdpPass},
+		benchCase{Name: "egress-qinq-hbh", Program: "seg6_pot_tlv_d", Frame: vlanFrame(hbhFrame(egress), 10, 100),
+			Verdict: xdpPass, Accounts: true},
+		// One options header more than the walk takes, the SRH behind it is never reached
+		benchCase{Name: "egress-hbh-deep", Program: "seg6_pot_tlv_d", Frame: hbhFrame(hbhFrame(hbhFrame(egress))), Verdict: xdpDrop},
+		// Tags in the frame are popped around the TLV insertion
+		benchCase{Name: "headend-vlan", Program: "seg6_pot_tlv", Frame: vlanFrame(path.frame(0, nil), 100),
+			Verdict: tcActOK, Accounts: true})
+	for _, t := range []int{1, 100, 1000} {
+		cases = append(cases, benchCase{Name: fmt.Sprintf("egress-tenants-%d", t), Program: "seg6_pot_tlv_d",
+			Frame: path.frame(n-1, potTLV(nonce, witness)), Verdict: xdpPass, Accounts: true, Tenants: t})
+	}
+
+	paths, tenants := coll.Maps["seg6_pot_paths"], coll.Maps["seg6_pot_tenants"]
+	results := make([]benchResult, 0, len(cases))
+	for _, c := range cases {
+		r := benchResult{Object: name, Case: c.Name, Accounted: -1}
+		err := bindTenants(tenants, c.Tenants, keys)
+		if err == nil {
+			err = runBenchCase(coll.Programs[c.Program], paths, c, &r)
+		}
+		if err != nil {
+			r.Error = err.Error()
+		}
+		results = append(results, r)
+	}
+
+	fmt.Printf("[+] Benchmarked %d packets per case of %s\n", benchRuns, name)
+	return results, nil
+}
+
+func runBenchCase(prog *ebpf.Program, paths *ebpf.Map, c benchCase, r *benchResult) error {
+	if prog == nil {
+		return fmt.Errorf("missing program %s", c.Program)
+	}
+	if paths != nil {
+		if err := clearPaths(paths); err != nil {
+			return err
+		}
+	}
+
+	var total time.Duration
+	for i := 0; i < benchRuns; i++ {
+		ret, d, err := prog.Benchmark(c.Frame, 1, nil)
+		if err != nil {
+			return err
+		}
+		if ret != c.Verdict {
+			return fmt.Errorf("returned %d instead of %d", ret, c.Verdict)
+		}
+		total += d
+	}
+	r.Runs = benchRuns
+	r.MeanNs = float64(total.Nanoseconds()) / benchRuns
+
+	if paths == nil {
+		return nil
+	}
+	records, err := readPaths(paths)
+	if err != nil {
+		return err
+	}
+	r.Accounted = 0
+	for _, rec := range records {
+		r.Accounted += int64(rec.Packets)
+	}
+
+	expected := int64(0)
+	if c.Accounts {
+		expected = benchRuns
+	}
+	if r.Accounted != expected || len(records) > 1 {
+		return fmt.Errorf("%d packets in %d paths, expected %d in one", r.Accounted, len(records), expected)
+	}
+	return nil
+}
+
+func clearPaths(m *ebpf.Map) error {
+	var key pathKey
+	var keys []pathKey
+	var perCPU []pathStats
+	it := m.Iterate()
+	for it.Next(&key, &perCPU) {
+		keys = append(keys, key)
+	}
+	if err := it.Err(); err != nil {
+		return fmt.Errorf("iterate map: %w", err)
+	}
+	for _, k := range keys {
+		if err := m.Delete(k); err != nil && !errors.Is(err, ebpf.ErrKeyNotExist) {
+			return fmt.Errorf("map.Delete: %w", err)
+		}
+	}
+	return nil
+}
+
+// bindTenants gives n tenants the keys of the default set, the one bound to
+// the loopback, where BPF_PROG_TEST_RUN receives its packets, and the others
+// to interfaces that don't exist. The tenants of the previous case are dropped.
+func bindTenants(m *ebpf.Map, n int, keys map[[16]byte][32]byte) error {
+	if m == nil {
+		if n > 0 {
+			return fmt.Errorf("missing seg6_pot_tenants")
+		}
+		return nil
+	}
+
+	var ifindex, inner uint32
+	var bound []uint32
+	it := m.Iterate()
+	for it.Next(&ifindex, &inner) {
+		bound = append(bound, ifindex)
+	}
+	if err := it.Err(); err != nil {
+		return fmt.Errorf("iterate map: %w", err)
+	}
+	for _, i := range bound {
+		if err := m.Delete(i); err != nil && !errors.Is(err, ebpf.ErrKeyNotExist) {
+			return fmt.Errorf("map.Delete: %w", err)
+		}
+	}
+	if n == 0 {
+		return nil
+	}
+
+	lo, err := net.InterfaceByName("lo")
+	if err != nil {
+		return fmt.Errorf("lookup loopback: %w", err)
+	}
+	for i := 0; i < n; i++ {
+		ifindex := uint32(lo.Index)
+		if i > 0 {
+			ifindex = 1<<20 + uint32(i)
+		}
+		set, err := newKeySet(64, keys)
+		if err != nil {
+			return err
+		}
+		err = m.Update(ifindex, set, ebpf.UpdateAny)
+		set.Close()
+		if err != nil {
+			return fmt.Errorf("bind tenant %d: %w", i, err)
+		}
+	}
+	return nil
+}
@@ -0,0 +1,260 @@
+package main
+
+import (
+	"bufio"
+	"bytes"
+	"encoding/binary"
+	"encoding/hex"
+	"errors"
+	"fmt"
+	"net"
+	"os"
+	"os/signal"
+	"syscall"
+	"time"
+
+	"github.com/cilium/ebpf"
+	"github.com/cilium/ebpf/perf"
+)
+
+const (
+	captureMapPath = "/sys/fs/bpf/seg6_pot_capture"
+	eventsMapPath  = "/sys/fs/bpf/seg6_pot_events"
+
+	// Per-CPU ring of seg6_pot_events, a failure storm is cut short by the rate anyway
+	capturePerCPUBuffer = 256 * 1024
+
+	pcapngLinkEthernet = 1
+)
+
+// Mirrors enum pot_capture_verdict of bpf/pot/capture.h
+var captureVerdicts = []string{"pass", "witness", "reject"}
+
+// Mirrors struct pot_capture_cfg and struct pot_capture_meta of bpf/pot/capture.h
+type captureConfig struct {
+	SnapLen    uint32
+	SamplePass uint32
+	Rate       uint32
+	_          uint32
+}
+
+type captureMeta struct {
+	TsNs       uint64
+	Verdict    uint32
+	CPU        uint32
+	Ifindex    uint32
+	PktLen     uint32
+	CapLen     uint32
+	WitnessLen uint32
+	Expected   [32]byte
+	Received   [32]byte
+}
+
+var captureMetaLen = binary.Size(captureMeta{})
+
+func setCapture(cfg captureConfig) error {
+	m, err := ebpf.LoadPinnedMap(captureMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer m.Close()
+
+	if err := m.Update(uint32(0), cfg, ebpf.UpdateAny); err != nil {
+		return fmt.Errorf("map.Update: %w", err)
+	}
+	return nil
+}
+
+// capturePackets enables the egress snapshots and writes them to a pcapng file
+// until interrupted: every failed validation, plus 1-in-sample valid packets,
+// at most rate per second on each CPU. The snapshots are switched off again on
+// the way out, nothing is copied while no one is reading.
+func capturePackets(output string, snapLen, sample, rate uint32) error {
+	if snapLen == 0 || rate == 0 {
+		return fmt.Errorf("invalid snap length %d or rate %d", snapLen, rate)
+	}
+
+	events, err := ebpf.LoadPinnedMap(eventsMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer events.Close()
+
+	rd, err := perf.NewReader(events, capturePerCPUBuffer)
+	if err != nil {
+		return fmt.Errorf("perf reader: %w", err)
+	}
+	defer rd.Close()
+
+	f, err := os.Create(output)
+	if err != nil {
+		return fmt.Errorf("create %s: %w", output, err)
+	}
+	defer f.Close()
+
+	w, err := newPcapngWriter(f, snapLen)
+	if err != nil {
+		return err
+	}
+
+	boot, err := bootTime()
+	if err != nil {
+		return fmt.Errorf("boot time: %w", err)
+	}
+
+	if err := setCapture(captureConfig{SnapLen: snapLen, SamplePass: sample, Rate: rate}); err != nil {
+		return err
+	}
+	defer setCapture(captureConfig{})
+
+	stop := make(chan os.Signal, 1)
+	signal.Notify(stop, syscall.SIGINT, syscall.SIGTERM)
+	go func() {
+		<-stop
+		rd.Close()
+	}()
+
+	fmt.Printf("[*] Capturing egress snapshots to %s — press Ctrl-C to stop\n", output)
+
+	var written, lost uint64
+	for {
+		rec, err := rd.Read()
+		if errors.Is(err, perf.ErrClosed) {
+			break
+		}
+		if err != nil {
+			return fmt.Errorf("perf read: %w", err)
+		}
+		if rec.LostSamples > 0 {
+			lost += rec.LostSamples
+			continue
+		}
+
+		if err := w.writeSample(rec.RawSample, boot); err != nil {
+			return err
+		}
+		written++
+	}
+
+	if err := w.Flush(); err != nil {
+		return fmt.Errorf("write %s: %w", output, err)
+	}
+	fmt.Printf("[+] Wrote %d packets to %s, %d lost\n", written, output, lost)
+	return nil
+}
+
+// pcapngWriter emits one section, with an interface description for every
+// ifindex the first time a packet of it shows up
+type pcapngWriter struct {
+	*bufio.Writer
+	snapLen    uint32
+	interfaces map[uint32]uint32 // ifindex to interface ID
+}
+
+func newPcapngWriter(f *os.File, snapLen uint32) (*pcapngWriter, error) {
+	w := &pcapngWriter{Writer: bufio.NewWriter(f), snapLen: snapLen, interfaces: map[uint32]uint32{}}
+
+	// Section header: byte-order magic, version 1.0, unknown section length
+	var shb bytes.Buffer
+	binary.Write(&shb, binary.LittleEndian, uint32(0x1A2B3C4D))
+	binary.Write(&shb, binary.LittleEndian, uint16(1))
+	binary.Write(&shb, binary.LittleEndian, uint16(0))
+	binary.Write(&shb, binary.LittleEndian, int64(-1))
+	pcapngOption(&shb, 4, []byte("seg6-pot-tlv")) // shb_userappl
+	pcapngOption(&shb, 0, nil)
+
+	if err := w.block(0x0A0D0D0A, shb.Bytes()); err != nil {
+		return nil, err
+	}
+	return w, nil
+}
+
+func (w *pcapngWriter) block(kind uint32, body []byte) error {
+	total := uint32(12 + len(body))
+	var b bytes.Buffer
+	binary.Write(&b, binary.LittleEndian, kind)
+	binary.Write(&b, binary.LittleEndian, total)
+	b.Write(body)
+	binary.Write(&b, binary.LittleEndian, total)
+	_, err := w.Write(b.Bytes())
+	return err
+}
+
+func pcapngOption(b *bytes.Buffer, code uint16, value []byte) {
+	binary.Write(b, binary.LittleEndian, code)
+	binary.Write(b, binary.LittleEndian, uint16(len(value)))
+	b.Write(value)
+	b.Write(make([]byte, (4-len(value)%4)%4))
+}
+
+func (w *pcapngWriter) interfaceID(ifindex uint32) (uint32, error) {
+	if id, ok := w.interfaces[ifindex]; ok {
+		return id, nil
+	}
+
+	name := fmt.Sprintf("ifindex%d", ifindex)
+	if ifc, err := net.InterfaceByIndex(int(ifindex)); err == nil {
+		name = ifc.Name
+	}
+
+	var idb bytes.Buffer
+	binary.Write(&idb, binary.LittleEndian, uint16(pcapngLinkEthernet))
+	binary.Write(&idb, binary.LittleEndian, uint16(0))
+	binary.Write(&idb, binary.LittleEndian, w.snapLen)
+	pcapngOption(&idb, 2, []byte(name)) // if_name
+	pcapngOption(&idb, 9, []byte{9})    // if_tsresol, nanoseconds
+	pcapngOption(&idb, 0, nil)
+
+	if err := w.block(1, idb.Bytes()); err != nil {
+		return 0, err
+	}
+	id := uint32(len(w.interfaces))
+	w.interfaces[ifindex] = id
+	return id, nil
+}
+
+// writeSample turns one seg6_pot_events record into an enhanced packet block,
+// the verdict and both witnesses go into its comment
+func (w *pcapngWriter) writeSample(raw []byte, boot time.Time) error {
+	var meta captureMeta
+	if len(raw) < captureMetaLen {
+		return fmt.Errorf("short sample of %d bytes", len(raw))
+	}
+	if err := binary.Read(bytes.NewReader(raw), binary.LittleEndian, &meta); err != nil {
+		return err
+	}
+	pkt := raw[captureMetaLen:]
+	if int(meta.CapLen) > len(pkt) {
+		return fmt.Errorf("sample of %d bytes holds %d packet bytes", len(raw), meta.CapLen)
+	}
+	pkt = pkt[:meta.CapLen]
+
+	id, err := w.interfaceID(meta.Ifindex)
+	if err != nil {
+		return err
+	}
+
+	verdict := fmt.Sprintf("unknown(%d)", meta.Verdict)
+	if int(meta.Verdict) < len(captureVerdicts) {
+		verdict = captureVerdicts[meta.Verdict]
+	}
+	comment := fmt.Sprintf("verdict=%s cpu=%d ifindex=%d", verdict, meta.CPU, meta.Ifindex)
+	if n := int(meta.WitnessLen); n > 0 && n <= len(meta.Expected) {
+		comment += fmt.Sprintf(" expected=%s received=%s", hex.EncodeToString(meta.Expected[:n]), hex.EncodeToString(meta.Received[:n]))
+	}
+
+	ts := uint64(boot.Add(time.Duration(meta.TsNs)).UnixNano())
+
+	var epb bytes.Buffer
+	binary.Write(&epb, binary.LittleEndian, id)
+	binary.Write(&epb, binary.LittleEndian, uint32(ts>>32))
+	binary.Write(&epb, binary.LittleEndian, uint32(ts))
+	binary.Write(&epb, binary.LittleEndian, meta.CapLen)
+	binary.Write(&epb, binary.LittleEndian, meta.PktLen)
+	epb.Write(pkt)
+	epb.Write(make([]byte, (4-len(pkt)%4)%4))
+	pcapngOption(&epb, 1, []byte(comment)) // opt_comment
+	pcapngOption(&epb, 0, nil)
+
+	return w.block(6, epb.Bytes())
+}
@@ -0,0 +1,54 @@
+package main
+
+import (
+	"encoding/binary"
+	"net"
+)
+
+// C-SID layout of a CSID=1 build, mirrors the F3216 format of bpf/csid.h
+const (
+	csidLBLen        = 4
+	csidLen          = 2
+	csidPerContainer = (16 - csidLBLen) / csidLen
+)
+
+// csidBlock is the locator block shared by every C-SID of csidPath
+var csidBlock = net.ParseIP("fcbb:bb00::")
+
+// csidPath is the path of vectorSIDs with compressed SIDs, the first C-SID is visited first
+var csidPath = []uint16{0x0002, 0x0003, 0x0004}
+
+// csidSID is the SID of the node of a C-SID, the one holding its key
+func csidSID(csid uint16) net.IP {
+	sid := make(net.IP, 16)
+	copy(sid, csidBlock.To16()[:csidLBLen])
+	binary.BigEndian.PutUint16(sid[csidLBLen:], csid)
+	return sid
+}
+
+// csidContainers packs the C-SIDs of a path into SRH segments, in path order
+func csidContainers(csids []uint16) []net.IP {
+	var containers []net.IP
+	for i := 0; i < len(csids); i += csidPerContainer {
+		c := make(net.IP, 16)
+		copy(c, csidBlock.To16()[:csidLBLen])
+		for j := 0; j < csidPerContainer && i+j < len(csids); j++ {
+			binary.BigEndian.PutUint16(c[csidLBLen+csidLen*j:], csids[i+j])
+		}
+		containers = append(containers, c)
+	}
+	return containers
+}
+
+// csidFrame is an SRv6 packet on csids sent to the C-SID of hop, the rest
+// of its container shifted in after it as every End with next-csid leaves it
+func csidFrame(csids []uint16, hop int, tlv []byte) []byte {
+	containers := csidContainers(csids)
+	c := hop / csidPerContainer
+
+	daddr := make(net.IP, 16)
+	copy(daddr, containers[c][:csidLBLen])
+	copy(daddr[csidLBLen:], containers[c][csidLBLen+csidLen*(hop%csidPerContainer):])
+
+	return srhFrame(containers, len(containers)-1-c, daddr, tlv)
+}
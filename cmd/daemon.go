@@ -0,0 +1,413 @@
+package main
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"net"
+	"os"
+	"os/signal"
+	"sync"
+	"syscall"
+	"time"
+
+	"github.com/cilium/ebpf"
+)
+
+const (
+	keysetMapPath = "/sys/fs/bpf/seg6_pot_keyset"
+
+	// Largest batch accepted from a controller, in bytes
+	daemonMaxFrame = 1 << 20
+)
+
+// Operations of a batch. A frame is a big-endian u32 length followed by the
+// operations back to back, each a one-byte opcode and its fixed-size body.
+// The reply frame holds a status byte (0 applied, 1 rejected), 3 bytes of
+// padding, the u32 count of operations applied, the u64 apply time in
+// nanoseconds and, when rejected, the reason.
+const (
+	opKeySet = 1 // sid[16] key[32]
+	opKeyDel = 2 // sid[16]
+	opSIDSet = 3 // sid[16] action u32 table u32, action 0 removes the SID
+	opLimit  = 4 // rate u32 burst u32 prefix_len u32
+)
+
+var opBodyLen = map[byte]int{opKeySet: 16 + 32, opKeyDel: 16, opSIDSet: 16 + 8, opLimit: 12}
+
+type daemonOp struct {
+	code  byte
+	sid   [16]byte
+	key   [32]byte
+	sidCf localSIDConfig
+	limit limitConfig
+}
+
+// keyDaemon holds the pinned maps open and applies one batch at a time
+type keyDaemon struct {
+	mu     sync.Mutex
+	keyset *ebpf.Map
+	sids   *ebpf.Map
+	limit  *ebpf.Map
+
+	batches, ops uint64
+	applyTotal   time.Duration
+}
+
+func parseBatch(frame []byte) ([]daemonOp, error) {
+	var ops []daemonOp
+	for off := 0; off < len(frame); {
+		code := frame[off]
+		n, ok := opBodyLen[code]
+		if !ok {
+			return nil, fmt.Errorf("unknown opcode %d at byte %d", code, off)
+		}
+		if off+1+n > len(frame) {
+			return nil, fmt.Errorf("truncated opcode %d at byte %d", code, off)
+		}
+		body := frame[off+1 : off+1+n]
+		off += 1 + n
+
+		op := daemonOp{code: code}
+		switch code {
+		case opKeySet:
+			copy(op.sid[:], body)
+			copy(op.key[:], body[16:])
+		case opKeyDel:
+			copy(op.sid[:], body)
+		case opSIDSet:
+			copy(op.sid[:], body)
+			op.sidCf = localSIDConfig{Action: binary.BigEndian.Uint32(body[16:]), Table: binary.BigEndian.Uint32(body[20:])}
+			if int(op.sidCf.Action) >= len(localSIDActions) {
+				return nil, fmt.Errorf("unknown action %d for SID %s", op.sidCf.Action, net.IP(op.sid[:]))
+			}
+		case opLimit:
+			op.limit = limitConfig{Rate: binary.BigEndian.Uint32(body), Burst: binary.BigEndian.Uint32(body[4:]), PrefixLen: binary.BigEndian.Uint32(body[8:])}
+			if err := checkLimit(&op.limit); err != nil {
+				return nil, err
+			}
+		}
+		ops = append(ops, op)
+	}
+	return ops, nil
+}
+
+func keyOps(ops []daemonOp) int {
+	n := 0
+	for _, op := range ops {
+		if op.code == opKeySet || op.code == opKeyDel {
+			n++
+		}
+	}
+	return n
+}
+
+// nextKeySet builds a new key map holding the active keys with the key
+// operations of the batch applied, nil when the batch has none. The active
+// set is returned along with it to swap it back if the batch fails. Keys set
+// with --sid --key between the read and the swap are lost, controllers
+// should send them through the daemon while it runs.
+func (d *keyDaemon) nextKeySet(ops []daemonOp) (next, active *ebpf.Map, err error) {
+	if keyOps(ops) == 0 {
+		return nil, nil, nil
+	}
+
+	if err := d.keyset.Lookup(uint32(0), &active); err != nil {
+		return nil, nil, fmt.Errorf("active key set: %w", err)
+	}
+
+	info, err := active.Info()
+	if err != nil {
+		active.Close()
+		return nil, nil, fmt.Errorf("active key set info: %w", err)
+	}
+
+	keys := map[[16]byte][32]byte{}
+	var sid [16]byte
+	var key [32]byte
+	it := active.Iterate()
+	for it.Next(&sid, &key) {
+		keys[sid] = key
+	}
+	if err := it.Err(); err != nil {
+		active.Close()
+		return nil, nil, fmt.Errorf("iterate map: %w", err)
+	}
+
+	for _, op := range ops {
+		switch op.code {
+		case opKeySet:
+			keys[op.sid] = op.key
+		case opKeyDel:
+			delete(keys, op.sid)
+		}
+	}
+	if len(keys) > int(info.MaxEntries) {
+		active.Close()
+		return nil, nil, fmt.Errorf("%d keys, the key set holds at most %d", len(keys), info.MaxEntries)
+	}
+
+	// Must match the inner map of seg6_pot_keyset, hence the active one
+	next, err = ebpf.NewMap(&ebpf.MapSpec{
+		Name:       "seg6_pot_keys",
+		Type:       info.Type,
+		KeySize:    info.KeySize,
+		ValueSize:  info.ValueSize,
+		MaxEntries: info.MaxEntries,
+		Flags:      info.Flags,
+	})
+	if err != nil {
+		active.Close()
+		return nil, nil, fmt.Errorf("create key set: %w", err)
+	}
+	for sid, key := range keys {
+		if err := next.Put(sid, key); err != nil {
+			next.Close()
+			active.Close()
+			return nil, nil, fmt.Errorf("map.Put: %w", err)
+		}
+	}
+	return next, active, nil
+}
+
+// setLocalSID applies op to the local SID map and returns how to restore
+// the previous entry
+func (d *keyDaemon) setLocalSID(op daemonOp) (func() error, error) {
+	var prev localSIDConfig
+	existed := true
+	if err := d.sids.Lookup(op.sid, &prev); errors.Is(err, ebpf.ErrKeyNotExist) {
+		existed = false
+	} else if err != nil {
+		return nil, fmt.Errorf("map.Lookup: %w", err)
+	}
+
+	var err error
+	if op.sidCf.Action == 0 {
+		err = d.sids.Delete(op.sid)
+		if errors.Is(err, ebpf.ErrKeyNotExist) {
+			err = nil
+		}
+	} else {
+		err = d.sids.Update(op.sid, op.sidCf, ebpf.UpdateAny)
+	}
+	if err != nil {
+		return nil, fmt.Errorf("map.Update: %w", err)
+	}
+
+	return func() error {
+		if existed {
+			return d.sids.Update(op.sid, prev, ebpf.UpdateAny)
+		}
+		if err := d.sids.Delete(op.sid); err != nil && !errors.Is(err, ebpf.ErrKeyNotExist) {
+			return err
+		}
+		return nil
+	}, nil
+}
+
+// setLimitOp applies op to the limit and returns how to restore the previous one
+func (d *keyDaemon) setLimitOp(op daemonOp) (func() error, error) {
+	var prev limitConfig
+	if err := d.limit.Lookup(uint32(0), &prev); err != nil {
+		return nil, fmt.Errorf("map.Lookup: %w", err)
+	}
+	if err := d.limit.Update(uint32(0), op.limit, ebpf.UpdateAny); err != nil {
+		return nil, fmt.Errorf("map.Update: %w", err)
+	}
+	return func() error { return d.limit.Update(uint32(0), prev, ebpf.UpdateAny) }, nil
+}
+
+// swapKeySet makes next the key set in use with a single update of
+// seg6_pot_keyset, so the datapath sees either none or all of the keys of
+// the batch, and moves the pin along for --keys and a later --load. On
+// failure it reports whether next is still the set in use.
+func (d *keyDaemon) swapKeySet(next, active *ebpf.Map) (bool, error) {
+	if err := d.keyset.Update(uint32(0), next, ebpf.UpdateAny); err != nil {
+		return false, fmt.Errorf("swap key set: %w", err)
+	}
+
+	tmp := defaultMapPath + ".next"
+	os.Remove(tmp)
+	err := next.Pin(tmp)
+	if err == nil {
+		err = os.Rename(tmp, defaultMapPath)
+	}
+	if err != nil {
+		os.Remove(tmp)
+		if rerr := d.keyset.Update(uint32(0), active, ebpf.UpdateAny); rerr != nil {
+			return true, fmt.Errorf("pin key set: %w, and the previous set couldn't be restored: %v", err, rerr)
+		}
+		return false, fmt.Errorf("pin key set: %w", err)
+	}
+	return true, nil
+}
+
+// apply runs a batch as a whole. Every operation was validated by
+// parseBatch and the new key set is built before anything is written. The
+// local SIDs and the limit are then updated one entry at a time, and the
+// key set swapped last. When a step fails the ones before it are undone in
+// reverse order, so the batch leaves either all of its changes or none.
+// It returns the count of operations left applied, which is only between
+// the two when an undo fails too.
+func (d *keyDaemon) apply(ops []daemonOp) (int, time.Duration, error) {
+	d.mu.Lock()
+	defer d.mu.Unlock()
+
+	start := time.Now()
+
+	next, active, err := d.nextKeySet(ops)
+	if err != nil {
+		return 0, 0, err
+	}
+	if next != nil {
+		defer next.Close()
+		defer active.Close()
+	}
+
+	// One undo per local SID or limit operation written
+	var undos []func() error
+	rollback := func(cause error) (int, time.Duration, error) {
+		left := 0
+		for i := len(undos) - 1; i >= 0; i-- {
+			if err := undos[i](); err != nil {
+				fmt.Fprintf(os.Stderr, "[-] undo of a failed batch: %v\n", err)
+				left++
+			}
+		}
+		return left, 0, cause
+	}
+
+	for _, op := range ops {
+		var undo func() error
+		switch op.code {
+		case opSIDSet:
+			undo, err = d.setLocalSID(op)
+		case opLimit:
+			undo, err = d.setLimitOp(op)
+		default:
+			continue
+		}
+		if err != nil {
+			return rollback(err)
+		}
+		undos = append(undos, undo)
+	}
+
+	if next != nil {
+		if swapped, err := d.swapKeySet(next, active); err != nil {
+			left, took, err := rollback(err)
+			if swapped {
+				left += keyOps(ops)
+			}
+			return left, took, err
+		}
+	}
+
+	took := time.Since(start)
+	d.batches++
+	d.ops += uint64(len(ops))
+	d.applyTotal += took
+	return len(ops), took, nil
+}
+
+func (d *keyDaemon) serve(conn net.Conn) {
+	defer conn.Close()
+
+	var hdr [4]byte
+	for {
+		if _, err := io.ReadFull(conn, hdr[:]); err != nil {
+			if !errors.Is(err, io.EOF) {
+				fmt.Fprintf(os.Stderr, "[-] read batch: %v\n", err)
+			}
+			return
+		}
+		n := binary.BigEndian.Uint32(hdr[:])
+		if n > daemonMaxFrame {
+			fmt.Fprintf(os.Stderr, "[-] batch of %d bytes over the %d limit\n", n, daemonMaxFrame)
+			return
+		}
+		frame := make([]byte, n)
+		if _, err := io.ReadFull(conn, frame); err != nil {
+			fmt.Fprintf(os.Stderr, "[-] read batch: %v\n", err)
+			return
+		}
+
+		ops, err := parseBatch(frame)
+		applied := 0
+		var took time.Duration
+		if err == nil {
+			applied, took, err = d.apply(ops)
+		}
+
+		reply := make([]byte, 4+16)
+		binary.BigEndian.PutUint32(reply[8:], uint32(applied))
+		binary.BigEndian.PutUint64(reply[12:], uint64(took.Nanoseconds()))
+		if err != nil {
+			reply[4] = 1
+			reply = append(reply, err.Error()...)
+		}
+		binary.BigEndian.PutUint32(reply, uint32(len(reply)-4))
+		if _, err := conn.Write(reply); err != nil {
+			fmt.Fprintf(os.Stderr, "[-] write reply: %v\n", err)
+			return
+		}
+	}
+}
+
+// runDaemon serves batches of key, local SID and limit updates on the Unix
+// socket at socketPath until interrupted
+func runDaemon(socketPath string) error {
+	d := &keyDaemon{}
+	for _, m := range []struct {
+		path string
+		dst  **ebpf.Map
+	}{{keysetMapPath, &d.keyset}, {localSIDMapPath, &d.sids}, {limitMapPath, &d.limit}} {
+		pinned, err := ebpf.LoadPinnedMap(m.path, &ebpf.LoadPinOptions{})
+		if err != nil {
+			return fmt.Errorf("open pinned map %s: %w", m.path, err)
+		}
+		defer pinned.Close()
+		*m.dst = pinned
+	}
+
+	os.Remove(socketPath)
+	ln, err := net.Listen("unix", socketPath)
+	if err != nil {
+		return fmt.Errorf("listen: %w", err)
+	}
+	defer os.Remove(socketPath)
+	if err := os.Chmod(socketPath, 0o600); err != nil {
+		ln.Close()
+		return err
+	}
+
+	stop := make(chan os.Signal, 1)
+	signal.Notify(stop, syscall.SIGINT, syscall.SIGTERM)
+	go func() {
+		<-stop
+		ln.Close()
+	}()
+
+	fmt.Printf("[*] Serving key updates on %s — press Ctrl-C to exit\n", socketPath)
+
+	for {
+		conn, err := ln.Accept()
+		if errors.Is(err, net.ErrClosed) {
+			break
+		}
+		if err != nil {
+			return fmt.Errorf("accept: %w", err)
+		}
+		go d.serve(conn)
+	}
+
+	d.mu.Lock()
+	defer d.mu.Unlock()
+	mean := time.Duration(0)
+	if d.batches > 0 {
+		mean = d.applyTotal / time.Duration(d.batches)
+	}
+	fmt.Printf("[+] Applied %d batches, %d updates, %s per batch\n", d.batches, d.ops, mean)
+	return nil
+}
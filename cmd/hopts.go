@@ -0,0 +1,95 @@
+package main
+
+import (
+	"encoding/json"
+	"fmt"
+	"os"
+	"path/filepath"
+
+	"github.com/cilium/ebpf"
+)
+
+const hopDelayMapPath = "/sys/fs/bpf/seg6_pot_hop_delay"
+
+// Mirrors POT_HOP_SLOTS of bpf/tlv.h, SRH_MAX_ALLOWED_SEGMENTS, one histogram per segments left
+const hopSlots = 8
+
+// hopDelayReport renders the per-hop delay histograms recorded by the egress
+// of a HOPTS=1 build, key i holding the delay from the hop at segments left
+// i + 1, or the head-end, to the one at i
+func hopDelayReport(outputPath string, reset bool) error {
+	m, err := ebpf.LoadPinnedMap(hopDelayMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map (built with HOPTS=1?): %w", err)
+	}
+	defer m.Close()
+
+	var stats []latencyStats
+	for key := uint32(hopSlots); key > 0; key-- {
+		hop := key - 1
+
+		var perCPU []latencyHist
+		if err := m.Lookup(&hop, &perCPU); err != nil {
+			return fmt.Errorf("lookup sl-%d: %w", hop, err)
+		}
+
+		var hist latencyHist
+		for _, h := range perCPU {
+			for i := range hist.Slots {
+				hist.Slots[i] += h.Slots[i]
+			}
+			hist.Count += h.Count
+			hist.SumNs += h.SumNs
+		}
+		if hist.Count == 0 {
+			continue
+		}
+
+		stats = append(stats, latencyStats{
+			Algorithm: algorithm,
+			Path:      "hop",
+			Stage:     fmt.Sprintf("sl-%d", hop),
+			Count:     hist.Count,
+			MeanNs:    float64(hist.SumNs) / float64(hist.Count),
+			P50Ns:     hist.percentile(0.50),
+			P99Ns:     hist.percentile(0.99),
+			P999Ns:    hist.percentile(0.999),
+			Slots:     hist.Slots[:],
+		})
+	}
+
+	if len(stats) == 0 {
+		fmt.Println("[*] no hop delays recorded yet")
+	}
+	for _, st := range stats {
+		printLatencyHist(st)
+	}
+	printLatencyStats(stats)
+
+	if outputPath != "" {
+		out, err := json.MarshalIndent(stats, "", "  ")
+		if err != nil {
+			return fmt.Errorf("encode report: %w", err)
+		}
+		if err := os.MkdirAll(filepath.Dir(outputPath), 0o755); err != nil {
+			return fmt.Errorf("create report dir: %w", err)
+		}
+		if err := os.WriteFile(outputPath, append(out, '\n'), 0o644); err != nil {
+			return fmt.Errorf("write report: %w", err)
+		}
+	}
+
+	if reset {
+		cpus, err := ebpf.PossibleCPU()
+		if err != nil {
+			return fmt.Errorf("possible CPUs: %w", err)
+		}
+		zero := make([]latencyHist, cpus)
+		for hop := uint32(0); hop < hopSlots; hop++ {
+			if err := m.Update(&hop, zero, ebpf.UpdateExist); err != nil {
+				return fmt.Errorf("reset histogram %d: %w", hop, err)
+			}
+		}
+	}
+	return nil
+}
@@ -0,0 +1,177 @@
+package main
+
+import (
+	"encoding/json"
+	"fmt"
+	"math"
+	"os"
+	"path/filepath"
+	"strings"
+	"text/tabwriter"
+
+	"github.com/cilium/ebpf"
+)
+
+const latencyMapPath = "/sys/fs/bpf/seg6_pot_latency"
+
+// Mirrors enum pot_lat_path, enum pot_lat_stage and struct pot_lat_hist of bpf/pot/latency.h
+var (
+	latencyPaths  = []string{"add", "update", "remove"}
+	latencyStages = []string{"parse", "key_lookup", "hash", "verify", "rewrite", "total"}
+)
+
+const latencySlots = 32
+
+type latencyHist struct {
+	Slots [latencySlots]uint64
+	Count uint64
+	SumNs uint64
+}
+
+// latencyStats is the summary of one stage, percentiles are the upper bound of their log2 slot
+type latencyStats struct {
+	Algorithm string   `json:"algorithm"`
+	Path      string   `json:"path"`
+	Stage     string   `json:"stage"`
+	Count     uint64   `json:"count"`
+	MeanNs    float64  `json:"mean_ns"`
+	P50Ns     uint64   `json:"p50_ns"`
+	P99Ns     uint64   `json:"p99_ns"`
+	P999Ns    uint64   `json:"p999_ns"`
+	Slots     []uint64 `json:"slots"`
+}
+
+// latencyReport renders the per-stage histograms of a POT_LATENCY build and
+// exports their percentiles, the counters are optionally cleared afterwards
+func latencyReport(outputPath string, reset bool) error {
+	m, err := ebpf.LoadPinnedMap(latencyMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map (built with LATENCY=1?): %w", err)
+	}
+	defer m.Close()
+
+	var stats []latencyStats
+	for p, path := range latencyPaths {
+		for s, stage := range latencyStages {
+			key := uint32(p*len(latencyStages) + s)
+
+			var perCPU []latencyHist
+			if err := m.Lookup(&key, &perCPU); err != nil {
+				return fmt.Errorf("lookup %s/%s: %w", path, stage, err)
+			}
+
+			var hist latencyHist
+			for _, h := range perCPU {
+				for i := range hist.Slots {
+					hist.Slots[i] += h.Slots[i]
+				}
+				hist.Count += h.Count
+				hist.SumNs += h.SumNs
+			}
+			if hist.Count == 0 {
+				continue
+			}
+
+			stats = append(stats, latencyStats{
+				Algorithm: algorithm,
+				Path:      path,
+				Stage:     stage,
+				Count:     hist.Count,
+				MeanNs:    float64(hist.SumNs) / float64(hist.Count),
+				P50Ns:     hist.percentile(0.50),
+				P99Ns:     hist.percentile(0.99),
+				P999Ns:    hist.percentile(0.999),
+				Slots:     hist.Slots[:],
+			})
+		}
+	}
+
+	if len(stats) == 0 {
+		fmt.Println("[*] no latency samples recorded yet")
+	}
+	for _, st := range stats {
+		printLatencyHist(st)
+	}
+	printLatencyStats(stats)
+
+	if outputPath != "" {
+		out, err := json.MarshalIndent(stats, "", "  ")
+		if err != nil {
+			return fmt.Errorf("encode report: %w", err)
+		}
+		if err := os.MkdirAll(filepath.Dir(outputPath), 0o755); err != nil {
+			return fmt.Errorf("create report dir: %w", err)
+		}
+		if err := os.WriteFile(outputPath, append(out, '\n'), 0o644); err != nil {
+			return fmt.Errorf("write report: %w", err)
+		}
+	}
+
+	if reset {
+		return resetLatency(m)
+	}
+	return nil
+}
+
+func resetLatency(m *ebpf.Map) error {
+	cpus, err := ebpf.PossibleCPU()
+	if err != nil {
+		return fmt.Errorf("possible CPUs: %w", err)
+	}
+
+	zero := make([]latencyHist, cpus)
+	for key := uint32(0); key < uint32(len(latencyPaths)*len(latencyStages)); key++ {
+		if err := m.Update(&key, zero, ebpf.UpdateExist); err != nil {
+			return fmt.Errorf("reset histogram %d: %w", key, err)
+		}
+	}
+	return nil
+}
+
+// percentile returns the upper bound in ns of the slot holding the q quantile
+func (h *latencyHist) percentile(q float64) uint64 {
+	target := uint64(math.Ceil(q * float64(h.Count)))
+	var cum uint64
+	for i, c := range h.Slots {
+		cum += c
+		if cum >= target {
+			return 1<<(i+1) - 1
+		}
+	}
+	return math.MaxUint64
+}
+
+func printLatencyHist(st latencyStats) {
+	fmt.Printf("\n%s/%s (%s)\n", st.Path, st.Stage, st.Algorithm)
+	fmt.Printf("%24s : %-10s |%-40s|\n", "ns", "count", "distribution")
+
+	var peak uint64
+	last := 0
+	for i, c := range st.Slots {
+		if c > peak {
+			peak = c
+		}
+		if c > 0 {
+			last = i
+		}
+	}
+
+	for i := 0; i <= last; i++ {
+		low := uint64(1) << i
+		if i == 0 {
+			low = 0
+		}
+		bar := int(st.Slots[i] * 40 / peak)
+		fmt.Printf("%10d -> %-10d : %-10d |%-40s|\n", low, uint64(1)<<(i+1)-1, st.Slots[i], strings.Repeat("*", bar))
+	}
+}
+
+func printLatencyStats(stats []latencyStats) {
+	w := tabwriter.NewWriter(os.Stdout, 0, 0, 2, ' ', 0)
+	fmt.Fprintln(w, "\nALGORITHM\tPATH\tSTAGE\tCOUNT\tMEAN(ns)\tP50(ns)\tP99(ns)\tP999(ns)")
+	for _, st := range stats {
+		fmt.Fprintf(w, "%s\t%s\t%s\t%d\t%.0f\t%d\t%d\t%d\n",
+			st.Algorithm, st.Path, st.Stage, st.Count, st.MeanNs, st.P50Ns, st.P99Ns, st.P999Ns)
+	}
+	w.Flush()
+}
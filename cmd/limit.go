@@ -0,0 +1,76 @@
+package main
+
+import (
+	"fmt"
+
+	"github.com/cilium/ebpf"
+)
+
+const (
+	limitMapPath      = "/sys/fs/bpf/seg6_pot_limit"
+	limitDropsMapPath = "/sys/fs/bpf/seg6_pot_limit_drops"
+
+	// One validation per ns, the bucket interval of bpf/pot/limit.h is 0 above
+	maxLimitRate = 1000000000
+)
+
+// Mirrors struct pot_limit_cfg of bpf/pot/limit.h
+type limitConfig struct {
+	Rate      uint32
+	Burst     uint32
+	PrefixLen uint32
+	_         uint32
+}
+
+// checkLimit refuses what the datapath can't enforce and sets the default burst
+func checkLimit(cfg *limitConfig) error {
+	if cfg.Rate > maxLimitRate {
+		return fmt.Errorf("rate %d over the %d validations per second the bucket can count", cfg.Rate, maxLimitRate)
+	}
+	if cfg.PrefixLen > 128 {
+		return fmt.Errorf("invalid prefix length %d", cfg.PrefixLen)
+	}
+	if cfg.Burst == 0 {
+		cfg.Burst = 1
+	}
+	return nil
+}
+
+// setLimit caps the full validations each outer source prefix can trigger on
+// the endpoint to rate per second, after a burst. A zero rate removes the cap.
+func setLimit(rate, burst, prefixLen uint32) error {
+	cfg := limitConfig{Rate: rate, Burst: burst, PrefixLen: prefixLen}
+	if err := checkLimit(&cfg); err != nil {
+		return err
+	}
+
+	m, err := ebpf.LoadPinnedMap(limitMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer m.Close()
+
+	if err := m.Update(uint32(0), cfg, ebpf.UpdateAny); err != nil {
+		return fmt.Errorf("map.Update: %w", err)
+	}
+	return nil
+}
+
+// limitDrops sums the packets every CPU dropped over the limit since the load
+func limitDrops() (uint64, error) {
+	m, err := ebpf.LoadPinnedMap(limitDropsMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return 0, fmt.Errorf("open pinned map: %w", err)
+	}
+	defer m.Close()
+
+	var perCPU []uint64
+	if err := m.Lookup(uint32(0), &perCPU); err != nil {
+		return 0, fmt.Errorf("map.Lookup: %w", err)
+	}
+	var drops uint64
+	for _, n := range perCPU {
+		drops += n
+	}
+	return drops, nil
+}
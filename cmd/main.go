@@ -3,18 +3,23 @@ package main
 import (
 	_ "embed"
 	"encoding/hex"
-	"errors"
 	"flag"
 	"fmt"
 	"log"
+	"math"
 	"net"
 	"os"
 	"os/signal"
+	"path/filepath"
+	"strings"
 	"syscall"
 	"text/tabwriter"
+	"time"
+	"unsafe"
 
 	bpf "github.com/aquasecurity/libbpfgo"
 	"github.com/cilium/ebpf"
+	"github.com/cilium/ebpf/link"
 )
 
 const defaultMapPath = "/sys/fs/bpf/seg6_pot_keys"
@@ -22,40 +27,241 @@ const defaultMapPath = "/sys/fs/bpf/seg6_pot_keys"
 //go:embed build/seg6_pot_tlv.o
 var bpfObj []byte
 
+// algorithm is the keyed-hash compiled into bpfObj, set at link time by the Makefile
+var algorithm = "blake3"
+
 func main() {
-	loadIface := flag.String("load", "", "Install and Attach eBPF programs to <iface>")
+	loadIface := flag.String("load", "", "Install and Attach eBPF programs to <iface>[,<iface>...]")
 	sidStr := flag.String("sid", "", "IPv6 SID (e.g. 2001:db8::1)")
 	keyHex := flag.String("key", "", "32-byte key as 64 hex digits")
 	showKeys := flag.Bool("keys", false, "List all SID→key entries in the map")
 	delSID := flag.String("del", "", "Remove the map entry for the given IPv6 SID")
+	verifier := flag.Bool("verifier-report", false, "Load [objects...] without attaching and report verifier and JIT costs")
+	vectors := flag.String("test-vectors", "", "Run [objects...] with BPF_PROG_TEST_RUN and write PoT test vectors to <file>")
+	baseline := flag.String("baseline", "", "Verifier report JSON to compare against")
+	output := flag.String("output", "", "Write the verifier, latency, hop delay or profile report as JSON to <file>")
+	latency := flag.Bool("latency", false, "Show the per-stage latency histograms of a LATENCY=1 build")
+	hopDelay := flag.Bool("hop-delay", false, "Show the per-hop delay histograms recorded by the egress of a HOPTS=1 build")
+	profile := flag.Duration("profile", 0, "Time every loaded PoT program with the kernel BPF stats for <duration> and report its cost")
+	reset := flag.Bool("reset", false, "Clear the latency or hop delay histograms after reporting them")
+	localSID := flag.String("local-sid", "", "Local IPv6 SID whose SRv6 behaviour is executed in XDP")
+	action := flag.String("action", "", "XDP behaviour of --local-sid: end, end.dt6 or none")
+	table := flag.Uint("table", 254, "FIB table of the decapsulated packet for --action end.dt6")
+	showLocalSIDs := flag.Bool("local-sids", false, "List all local SIDs with an XDP behaviour")
+	cpuList := flag.String("cpus", "", "With --load, spread the validation over these CPUs by inner flow (e.g. 0-3,6)")
+	qsize := flag.Uint("qsize", 2048, "With --cpus, frames queued on each CPU")
+	mode := flag.String("mode", modeAuto, "With --load, validator attach mode: auto, xdp, xdp-generic or tc")
+	pin := flag.Bool("pin", false, "With --load, pin the programs and links under --pin-dir and exit")
+	pinDir := flag.String("pin-dir", defaultPinDir, "bpffs directory of the pinned programs and links")
+	upgrade := flag.Bool("upgrade", false, "Atomically swap the programs of the links pinned under --pin-dir")
+	unload := flag.Bool("unload", false, "Detach the links pinned under --pin-dir")
+	showPaths := flag.Bool("paths", false, "List the packets, bytes and failures of every SR path seen by the head-end and egress")
+	export := flag.String("export", "", "Append the per-path counters as JSON lines to <file> (- for stdout) every --interval")
+	interval := flag.Duration("interval", 10*time.Second, "With --export, time between two exports")
+	bench := flag.String("test-run-bench", "", "Time head-end, transit and egress packets of [objects...] with BPF_PROG_TEST_RUN, JSON to <file>")
+	csid := flag.Bool("csid", false, "With --test-run-bench, [objects...] are CSID=1 builds, their packets carry compressed SIDs")
+	tlvTypeFlag := flag.Uint("tlv-type", potTLVType, "With --test-run-bench, PoT TLV type of the packets, 4 for objects built before the TLV walker")
+	limit := flag.Int("limit", -1, "Full validations per second each source prefix may trigger on the endpoint, 0 disables")
+	burst := flag.Uint("burst", 64, "With --limit, validations allowed back to back")
+	limitPrefix := flag.Uint("limit-prefix", 64, "With --limit, outer source prefix length of one bucket")
+	capture := flag.String("capture", "", "Write snapshots of failed egress packets to the pcapng <file> until interrupted")
+	snapLen := flag.Uint("snaplen", 128, "With --capture, leading bytes kept of each packet")
+	sample := flag.Uint("sample", 0, "With --capture, also keep 1-in-N valid packets, 0 for failures only")
+	captureRate := flag.Uint("capture-rate", 1000, "With --capture, snapshots per second on each CPU")
+	tenant := flag.String("tenant", "", "Create or replace the key set of tenant <name>, with --sid/--key, --del or --keys act on its keys")
+	tenantSize := flag.Uint("tenant-size", 64, "With --tenant, keys the tenant can hold")
+	tenantKeys := flag.String("tenant-keys", "", "With --tenant, replace its keys at once with the \"<sid> <key>\" lines of <file>")
+	tenantIfaces := flag.String("iface", "", "With --tenant, validate the packets received on <iface>[,<iface>...] with its keys")
+	showTenants := flag.Bool("tenants", false, "List all tenants with their size, keys and interfaces")
+	dropTenant := flag.String("drop-tenant", "", "Unbind tenant <name> from its interfaces and remove it")
+	daemon := flag.String("daemon", "", "Apply batched key, local SID and limit updates received on the Unix socket <path>")
 	flag.Parse()
 
+	keyMap := defaultMapPath
+	if *tenant != "" {
+		keyMap = tenantPath(*tenant)
+	}
+
 	switch {
+	case *latency:
+		if err := latencyReport(*output, *reset); err != nil {
+			log.Fatalf("[-] latency report failed: %v", err)
+		}
+		return
+
+	case *hopDelay:
+		if err := hopDelayReport(*output, *reset); err != nil {
+			log.Fatalf("[-] hop delay report failed: %v", err)
+		}
+		return
+
+	case *profile > 0:
+		if err := profileProgs(*profile, *pinDir, *output); err != nil {
+			log.Fatalf("[-] profile failed: %v", err)
+		}
+		return
+
+	case *verifier:
+		if err := verifierReport(flag.Args(), *baseline, *output); err != nil {
+			log.Fatalf("[-] verifier report failed: %v", err)
+		}
+		return
+
+	case *vectors != "":
+		if err := testVectors(*vectors, flag.Args()); err != nil {
+			log.Fatalf("[-] test vectors failed: %v", err)
+		}
+		fmt.Printf("[+] Wrote test vectors to %s\n", *vectors)
+		return
+
+	case *bench != "":
+		if *tlvTypeFlag > 0xff {
+			log.Fatalf("[-] Invalid TLV type %d", *tlvTypeFlag)
+		}
+		tlvType = byte(*tlvTypeFlag)
+		if err := testRunBench(*bench, flag.Args(), *csid); err != nil {
+			log.Fatalf("[-] test-run benchmark failed: %v", err)
+		}
+		fmt.Printf("[+] Wrote test-run benchmark to %s\n", *bench)
+		return
+
+	case *showPaths:
+		if err := listPaths(); err != nil {
+			log.Fatalf("[-] failed to list paths: %v", err)
+		}
+		return
+
+	case *export != "":
+		if err := exportPaths(*export, *interval); err != nil {
+			log.Fatalf("[-] path export failed: %v", err)
+		}
+		return
+
+	case *daemon != "":
+		if err := runDaemon(*daemon); err != nil {
+			log.Fatalf("[-] daemon failed: %v", err)
+		}
+		return
+
+	case *capture != "":
+		if err := capturePackets(*capture, uint32(*snapLen), uint32(*sample), uint32(*captureRate)); err != nil {
+			log.Fatalf("[-] capture failed: %v", err)
+		}
+		return
+
+	case *limit >= 0:
+		// Checked before the uint32 conversion would wrap them
+		if *limit > maxLimitRate {
+			log.Fatalf("[-] --limit must be at most %d validations per second", maxLimitRate)
+		}
+		if *burst > math.MaxUint32 || *limitPrefix > 128 {
+			log.Fatalf("[-] --burst must fit 32 bits and --limit-prefix be at most 128")
+		}
+		if err := setLimit(uint32(*limit), uint32(*burst), uint32(*limitPrefix)); err != nil {
+			log.Fatalf("[-] limit update failed: %v", err)
+		}
+		if drops, err := limitDrops(); err == nil {
+			fmt.Printf("[*] %d packets dropped over the limit since the load\n", drops)
+		}
+		if *limit == 0 {
+			fmt.Printf("[+] Removed the validation limit from %s\n", limitMapPath)
+			return
+		}
+		fmt.Printf("[+] Limited validations to %d/s per /%d source prefix, burst %d\n", *limit, *limitPrefix, *burst)
+		return
+
+	case *localSID != "" && *action != "":
+		if err := updateLocalSID(*localSID, *action, uint32(*table)); err != nil {
+			log.Fatalf("[-] local SID update failed: %v", err)
+		}
+		fmt.Printf("[+] Set SID %s → action %s into %s\n", *localSID, *action, localSIDMapPath)
+		return
+
+	case *showLocalSIDs:
+		if err := listLocalSIDs(); err != nil {
+			log.Fatalf("[-] failed to list local SIDs: %v", err)
+		}
+		return
+
 	case *delSID != "":
-		if err := deleteEntry(*delSID); err != nil {
+		if err := deleteEntry(keyMap, *delSID); err != nil {
 			log.Fatalf("[-] delete failed: %v", err)
 		}
-		fmt.Printf("[+] Removed SID %s from %s\n", *delSID, defaultMapPath)
+		fmt.Printf("[+] Removed SID %s from %s\n", *delSID, keyMap)
 		return
 
 	case *showKeys:
-		if err := listKeys(); err != nil {
+		if err := listKeys(keyMap); err != nil {
 			log.Fatalf("[-] failed to list keys: %v", err)
 		}
 		return
 
+	case *unload:
+		if err := unpinLinks(*pinDir); err != nil {
+			log.Fatalf("[-] unload failed: %v", err)
+		}
+		return
+
+	case *upgrade:
+		cpus, err := parseCPUFlag(*cpuList)
+		if err != nil {
+			log.Fatalf("[-] invalid --cpus: %v", err)
+		}
+		if err := upgradePrograms(*pinDir, cpus, uint32(*qsize)); err != nil {
+			log.Fatalf("[-] upgrade failed: %v", err)
+		}
+		fmt.Printf("[+] Upgraded the programs pinned under %s\n", *pinDir)
+		return
+
 	case *loadIface != "":
-		if err := loadPrograms(*loadIface); err != nil {
+		cpus, err := parseCPUFlag(*cpuList)
+		if err != nil {
+			log.Fatalf("[-] invalid --cpus: %v", err)
+		}
+		if !validAttachMode(*mode) {
+			log.Fatalf("[-] invalid --mode %q, expected one of %v", *mode, attachModes)
+		}
+		if len(cpus) > 0 && *mode == modeTC {
+			log.Fatalf("[-] --cpus needs an XDP attach mode")
+		}
+		if !*pin {
+			*pinDir = ""
+		}
+		if err := loadPrograms(strings.Split(*loadIface, ","), *mode, cpus, uint32(*qsize), *pinDir); err != nil {
 			log.Fatalf("[-] load failed: %v", err)
 		}
 		fmt.Printf("[+] Loaded TC & XDP programs on %s\n", *loadIface)
 		return
 
 	case *sidStr != "" && *keyHex != "":
-		if err := updateMap(*sidStr, *keyHex); err != nil {
+		if err := updateMap(keyMap, *sidStr, *keyHex); err != nil {
 			log.Fatalf("[-] map update failed: %v", err)
 		}
-		fmt.Printf("[+] Inserted SID %s → key %s into %s\n", *sidStr, *keyHex, defaultMapPath)
+		fmt.Printf("[+] Inserted SID %s → key %s into %s\n", *sidStr, *keyHex, keyMap)
+		return
+
+	case *showTenants:
+		if err := listTenants(); err != nil {
+			log.Fatalf("[-] failed to list tenants: %v", err)
+		}
+		return
+
+	case *dropTenant != "":
+		if err := removeTenant(*dropTenant); err != nil {
+			log.Fatalf("[-] tenant removal failed: %v", err)
+		}
+		fmt.Printf("[+] Removed tenant %s\n", *dropTenant)
+		return
+
+	case *tenant != "":
+		var ifaces []string
+		if *tenantIfaces != "" {
+			ifaces = strings.Split(*tenantIfaces, ",")
+		}
+		if err := setTenant(*tenant, uint32(*tenantSize), *tenantKeys, ifaces); err != nil {
+			log.Fatalf("[-] tenant update failed: %v", err)
+		}
+		fmt.Printf("[+] Tenant %s ready in %s\n", *tenant, keyMap)
 		return
 
 	default:
@@ -64,14 +270,14 @@ func main() {
 	}
 }
 
-func deleteEntry(sidStr string) error {
+func deleteEntry(mapPath, sidStr string) error {
 	ip := net.ParseIP(sidStr)
 	if ip == nil || ip.To16() == nil {
 		return fmt.Errorf("invalid IPv6 SID: %q", sidStr)
 	}
 	key := ip.To16()
 
-	m, err := ebpf.LoadPinnedMap(defaultMapPath, &ebpf.LoadPinOptions{})
+	m, err := ebpf.LoadPinnedMap(mapPath, &ebpf.LoadPinOptions{})
 	if err != nil {
 		return fmt.Errorf("open pinned map: %w", err)
 	}
@@ -84,8 +290,8 @@ func deleteEntry(sidStr string) error {
 	return nil
 }
 
-func listKeys() error {
-	m, err := ebpf.LoadPinnedMap(defaultMapPath, &ebpf.LoadPinOptions{})
+func listKeys(mapPath string) error {
+	m, err := ebpf.LoadPinnedMap(mapPath, &ebpf.LoadPinOptions{})
 	if err != nil {
 		return fmt.Errorf("open pinned map: %w", err)
 	}
@@ -109,7 +315,7 @@ func listKeys() error {
 	return w.Flush()
 }
 
-func updateMap(sidStr, keyHex string) error {
+func updateMap(mapPath, sidStr, keyHex string) error {
 	ip := net.ParseIP(sidStr)
 	if ip == nil || ip.To16() == nil {
 		return fmt.Errorf("invalid IPv6 SID: %q", sidStr)
@@ -124,7 +330,7 @@ func updateMap(sidStr, keyHex string) error {
 		return fmt.Errorf("key must be 32 bytes, got %d", len(keyBytes))
 	}
 
-	m, err := ebpf.LoadPinnedMap(defaultMapPath, &ebpf.LoadPinOptions{})
+	m, err := ebpf.LoadPinnedMap(mapPath, &ebpf.LoadPinOptions{})
 	if err != nil {
 		return fmt.Errorf("open pinned map: %w", err)
 	}
@@ -136,62 +342,115 @@ func updateMap(sidStr, keyHex string) error {
 	return nil
 }
 
-func loadPrograms(iface string) error {
+// openObject loads the embedded object, with the pipeline turned into
+// cpumap programs when steering over cpus, and returns its XDP entry
+func openObject(cpus []uint32, qsize uint32) (*bpf.Module, string, error) {
 	module, err := bpf.NewModuleFromBuffer(bpfObj, "seg6_pot_tlv")
 	if err != nil {
-		fmt.Fprintf(os.Stderr, "BPF new module: %v\n", err)
-		os.Exit(1)
+		return nil, "", fmt.Errorf("BPF new module: %w", err)
+	}
+
+	xdpEntry := "seg6_pot_tlv_d"
+	if len(cpus) > 0 {
+		if err := prepareSteering(module, cpus); err != nil {
+			module.Close()
+			return nil, "", fmt.Errorf("prepare CPU steering: %w", err)
+		}
+		xdpEntry = "seg6_pot_tlv_d_steer"
 	}
-	defer module.Close()
 
 	if err := module.BPFLoadObject(); err != nil {
-		fmt.Fprintf(os.Stderr, "BPF load object: %v\n", err)
-		os.Exit(1)
+		module.Close()
+		return nil, "", fmt.Errorf("BPF load object: %w", err)
+	}
+
+	if err := fillDevmap(module); err != nil {
+		module.Close()
+		return nil, "", fmt.Errorf("fill devmap: %w", err)
 	}
 
-	xdpProg, err := module.GetProgram("seg6_pot_tlv_d")
-	if err != nil || xdpProg == nil {
-		return fmt.Errorf("get XDP program: %w", err)
+	if len(cpus) > 0 {
+		if err := fillCPUMap(module, cpus, qsize); err != nil {
+			module.Close()
+			return nil, "", fmt.Errorf("fill cpumap: %w", err)
+		}
+		fmt.Printf("[+] Steering SRv6 flows over CPUs %v\n", cpus)
 	}
-	xdpLink, err := xdpProg.AttachXDP(iface)
+	return module, xdpEntry, nil
+}
+
+// loadPrograms attaches one object to every interface, so they share its
+// maps. With a pinDir the links are pinned and outlive the process, otherwise
+// they are released on SIGINT or SIGTERM.
+func loadPrograms(ifaces []string, mode string, cpus []uint32, qsize uint32, pinDir string) error {
+	module, xdpEntry, err := openObject(cpus, qsize)
 	if err != nil {
-		return fmt.Errorf("attach XDP ingress: %w", err)
+		return err
 	}
-	defer xdpLink.Destroy()
+	defer module.Close()
 
-	hook := module.TcHookInit()
-	defer hook.Destroy()
+	p, err := newPipeline(module, xdpEntry)
+	if err != nil {
+		return err
+	}
+	defer p.Close()
 
-	if err := hook.SetInterfaceByName(iface); err != nil {
-		fmt.Fprintf(os.Stderr, "set interface: %v\n", err)
-		os.Exit(1)
+	// Steering redirects into a cpumap, only XDP can do it
+	if len(cpus) > 0 && mode == modeAuto {
+		mode = modeXDP
 	}
-	hook.SetAttachPoint(bpf.BPFTcEgress)
-	if err := hook.Create(); err != nil {
-		if !errors.Is(err, syscall.EEXIST) {
-			return fmt.Errorf("tc hook create: %w", err)
+
+	if pinDir != "" {
+		for _, iface := range ifaces {
+			if _, err := os.Stat(filepath.Join(pinDir, "links", iface)); err == nil {
+				return fmt.Errorf("%s already pinned under %s, use --upgrade or --unload", iface, pinDir)
+			}
 		}
-		fmt.Fprintf(os.Stderr, "[+] tc hook already existed, re-using\n")
 	}
 
-	tcProg, err := module.GetProgram("seg6_pot_tlv")
-	if err != nil || tcProg == nil {
-		fmt.Fprintf(os.Stderr, "get program: %v\n", err)
-		os.Exit(1)
-	}
+	// A failed load leaves nothing behind, its pins go with the links
+	var attached []link.Link
+	var pinned []string
+	loaded := false
+	defer func() {
+		for _, l := range attached {
+			l.Close()
+		}
+		if !loaded {
+			for _, dir := range pinned {
+				os.RemoveAll(dir)
+			}
+		}
+	}()
 
-	var opts bpf.TcOpts
-	opts.ProgFd = int(tcProg.GetFd())
-	opts.Handle = 1
-	opts.Priority = 1
+	for _, iface := range ifaces {
+		links, used, err := attachInterface(p, iface, mode)
+		if err != nil {
+			return fmt.Errorf("%s: %w", iface, err)
+		}
+		for _, l := range links {
+			attached = append(attached, l)
+		}
+		fmt.Printf("[+] Validator attached on %s in %s mode\n", iface, used)
 
-	if err := hook.Attach(&opts); err != nil {
-		fmt.Fprintf(os.Stderr, "tc attach: %v\n", err)
-		os.Exit(1)
+		if pinDir != "" {
+			pinned = append(pinned, filepath.Join(pinDir, "links", iface))
+			if err := pinLinks(pinDir, iface, links); err != nil {
+				return fmt.Errorf("%s: %w", iface, err)
+			}
+		}
+	}
+
+	if pinDir != "" {
+		if err := pinPipeline(pinDir, p); err != nil {
+			return err
+		}
+		loaded = true
+		fmt.Printf("[+] Programs and links pinned under %s\n", pinDir)
+		return nil
 	}
-	defer hook.Detach(&opts)
 
-	fmt.Printf("TC egress program attached on %s — press Ctrl-C to exit\n", iface)
+	fmt.Printf("TC egress program attached on %s — press Ctrl-C to exit\n", strings.Join(ifaces, ", "))
 
 	sig := make(chan os.Signal, 1)
 	signal.Notify(sig, syscall.SIGINT, syscall.SIGTERM)
@@ -201,3 +460,46 @@ func loadPrograms(iface string) error {
 
 	return nil
 }
+
+// upgradePrograms loads the embedded object and swaps it into the links
+// pinned under pinDir, the pinned maps carry the keys and SIDs over
+func upgradePrograms(pinDir string, cpus []uint32, qsize uint32) error {
+	module, xdpEntry, err := openObject(cpus, qsize)
+	if err != nil {
+		return err
+	}
+	defer module.Close()
+
+	p, err := newPipeline(module, xdpEntry)
+	if err != nil {
+		return err
+	}
+	defer p.Close()
+
+	return upgradeLinks(pinDir, p)
+}
+
+// fillDevmap allows the XDP fast-path to redirect to every interface of the
+// current network namespace, ifindexes are namespace local so it is not pinned
+func fillDevmap(module *bpf.Module) error {
+	devmap, err := module.GetMap("seg6_pot_devmap")
+	if err != nil {
+		return fmt.Errorf("get map: %w", err)
+	}
+
+	ifaces, err := net.Interfaces()
+	if err != nil {
+		return fmt.Errorf("list interfaces: %w", err)
+	}
+
+	for _, ifc := range ifaces {
+		if ifc.Flags&net.FlagLoopback != 0 {
+			continue
+		}
+		ifindex := uint32(ifc.Index)
+		if err := devmap.Update(unsafe.Pointer(&ifindex), unsafe.Pointer(&ifindex)); err != nil {
+			return fmt.Errorf("add %s: %w", ifc.Name, err)
+		}
+	}
+	return nil
+}
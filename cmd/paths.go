@@ -0,0 +1,189 @@
+package main
+
+import (
+	"encoding/json"
+	"fmt"
+	"io"
+	"net"
+	"os"
+	"os/signal"
+	"sort"
+	"strconv"
+	"strings"
+	"syscall"
+	"text/tabwriter"
+	"time"
+
+	"github.com/cilium/ebpf"
+)
+
+const pathsMapPath = "/sys/fs/bpf/seg6_pot_paths"
+
+// Mirrors enum pot_path_role of bpf/pot/paths.h
+var pathRoles = []string{"none", "headend", "egress"}
+
+// Mirrors struct pot_path_key and struct pot_path_stats of bpf/pot/paths.h
+type pathKey struct {
+	Digest uint64
+	Role   uint32
+	_      uint32
+}
+
+type pathStats struct {
+	Packets     uint64
+	Bytes       uint64
+	Failures    uint64
+	LastSeenNs  uint64
+	SegmentSize uint32
+	_           uint32
+	Segments    [8][16]byte
+}
+
+// pathRecord is one path summed over every CPU, the counters are totals since
+// the path entered the map, so consecutive records of it are diffed for rates.
+type pathRecord struct {
+	Time     time.Time `json:"time"`
+	Role     string    `json:"role"`
+	Digest   string    `json:"digest"`
+	Segments []string  `json:"segments"` // Path order, the first SID is visited first
+	Packets  uint64    `json:"packets"`
+	Bytes    uint64    `json:"bytes"`
+	Failures uint64    `json:"failures"`
+	LastSeen time.Time `json:"last_seen"`
+}
+
+// bootTime is the wall clock time of a bpf_ktime_get_boot_ns timestamp of zero
+func bootTime() (time.Time, error) {
+	raw, err := os.ReadFile("/proc/uptime")
+	if err != nil {
+		return time.Time{}, err
+	}
+	fields := strings.Fields(string(raw))
+	if len(fields) == 0 {
+		return time.Time{}, fmt.Errorf("unexpected /proc/uptime %q", raw)
+	}
+	uptime, err := strconv.ParseFloat(fields[0], 64)
+	if err != nil {
+		return time.Time{}, err
+	}
+	return time.Now().Add(-time.Duration(uptime * float64(time.Second))), nil
+}
+
+// readPaths sums the per-CPU counters of every path, the SID list is taken
+// from any CPU that has seen the path
+func readPaths(m *ebpf.Map) ([]pathRecord, error) {
+	boot, err := bootTime()
+	if err != nil {
+		return nil, fmt.Errorf("boot time: %w", err)
+	}
+	now := time.Now()
+
+	var records []pathRecord
+	var key pathKey
+	var perCPU []pathStats
+	it := m.Iterate()
+
+	for it.Next(&key, &perCPU) {
+		rec := pathRecord{Time: now, Digest: fmt.Sprintf("%016x", key.Digest), Role: fmt.Sprintf("unknown(%d)", key.Role)}
+		if int(key.Role) < len(pathRoles) {
+			rec.Role = pathRoles[key.Role]
+		}
+
+		var lastSeen uint64
+		for _, st := range perCPU {
+			rec.Packets += st.Packets
+			rec.Bytes += st.Bytes
+			rec.Failures += st.Failures
+			if st.LastSeenNs > lastSeen {
+				lastSeen = st.LastSeenNs
+			}
+			if rec.Segments == nil && st.SegmentSize > 0 && st.SegmentSize <= uint32(len(st.Segments)) {
+				for i := int(st.SegmentSize) - 1; i >= 0; i-- {
+					rec.Segments = append(rec.Segments, net.IP(st.Segments[i][:]).String())
+				}
+			}
+		}
+		rec.LastSeen = boot.Add(time.Duration(lastSeen))
+		records = append(records, rec)
+	}
+	if err := it.Err(); err != nil {
+		return nil, fmt.Errorf("iterate map: %w", err)
+	}
+
+	sort.Slice(records, func(i, j int) bool {
+		if records[i].Role != records[j].Role {
+			return records[i].Role < records[j].Role
+		}
+		return records[i].Digest < records[j].Digest
+	})
+	return records, nil
+}
+
+func listPaths() error {
+	m, err := ebpf.LoadPinnedMap(pathsMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer m.Close()
+
+	records, err := readPaths(m)
+	if err != nil {
+		return err
+	}
+
+	w := tabwriter.NewWriter(os.Stdout, 0, 0, 2, ' ', 0)
+	fmt.Fprintln(w, "ROLE\tDIGEST\tPACKETS\tBYTES\tFAILURES\tLAST SEEN\tPATH")
+	for _, r := range records {
+		fmt.Fprintf(w, "%s\t%s\t%d\t%d\t%d\t%s ago\t%s\n", r.Role, r.Digest, r.Packets, r.Bytes, r.Failures,
+			r.Time.Sub(r.LastSeen).Round(time.Millisecond), strings.Join(r.Segments, ","))
+	}
+	return w.Flush()
+}
+
+// exportPaths appends every path as one JSON line to output ("-" for stdout)
+// each interval, until interrupted
+func exportPaths(output string, interval time.Duration) error {
+	if interval <= 0 {
+		return fmt.Errorf("invalid interval %s", interval)
+	}
+
+	m, err := ebpf.LoadPinnedMap(pathsMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer m.Close()
+
+	var out io.Writer = os.Stdout
+	if output != "-" {
+		f, err := os.OpenFile(output, os.O_CREATE|os.O_WRONLY|os.O_APPEND, 0o644)
+		if err != nil {
+			return fmt.Errorf("open %s: %w", output, err)
+		}
+		defer f.Close()
+		out = f
+	}
+	enc := json.NewEncoder(out)
+
+	stop := make(chan os.Signal, 1)
+	signal.Notify(stop, syscall.SIGINT, syscall.SIGTERM)
+	ticker := time.NewTicker(interval)
+	defer ticker.Stop()
+
+	for {
+		records, err := readPaths(m)
+		if err != nil {
+			return err
+		}
+		for _, r := range records {
+			if err := enc.Encode(r); err != nil {
+				return fmt.Errorf("write %s: %w", output, err)
+			}
+		}
+
+		select {
+		case <-ticker.C:
+		case <-stop:
+			return nil
+		}
+	}
+}
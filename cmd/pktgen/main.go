@@ -0,0 +1,251 @@
+// Command pktgen emits SRv6 traffic at line rate to stress a single PoT role.
+//
+//	headend  plain IPv6/UDP towards the SRv6 policy, the tc egress program inserts the TLV
+//	transit  SRH with a pre-inserted PoT TLV and segments left > 0
+//	egress   SRH with a pre-inserted PoT TLV and segments left = 0
+//
+// Pre-inserted TLVs carry a random nonce and a zero witness, enough to exercise
+// the transit path. An egress node rejects them after running the whole chain,
+// use --tlv with a TLV captured from a valid path to measure the strip stage too.
+package main
+
+import (
+	"crypto/rand"
+	"encoding/hex"
+	"flag"
+	"fmt"
+	"log"
+	"net"
+	"os"
+	"os/signal"
+	"strings"
+	"syscall"
+	"time"
+)
+
+func main() {
+	iface := flag.String("iface", "", "Transmit on <iface>")
+	dstMACStr := flag.String("dst-mac", "", "Destination MAC, the ingress interface of the node under test")
+	srcMACStr := flag.String("src-mac", "", "Source MAC (default: MAC of <iface>)")
+	role := flag.String("role", "transit", "Role under test: headend, transit or egress")
+	sidsStr := flag.String("sids", "2001:db8:ff:2::1,2001:db8:ff:3::1,2001:db8:ff:4::1", "Segment list in path order")
+	segLeft := flag.Int("segments-left", -1, "Segments left (default: first SID for transit, 0 for egress)")
+	srcStr := flag.String("src", "2001:db8:10:1::1", "Outer IPv6 source")
+	innerSrcStr := flag.String("inner-src", "2001:db8:10:1::2", "Inner IPv6 source")
+	innerDstStr := flag.String("inner-dst", "2001:db8:60:1::2", "Inner IPv6 destination")
+	dstPort := flag.Uint("dport", 9, "Inner UDP destination port")
+	payload := flag.Int("payload", 64, "Inner UDP payload size in bytes")
+	flows := flag.Int("flows", 1, "Number of flows, each one with its own UDP source port and flow label")
+	algo := flag.String("algo", "blake3", "Size the pre-inserted TLV for <algo>, empty for no TLV")
+	tlvHex := flag.String("tlv", "", "Pre-insert this complete TLV (hex) instead of a zero witness one")
+	duration := flag.Duration("duration", 10*time.Second, "How long to transmit")
+	count := flag.Uint64("count", 0, "Stop after <count> packets (default: no limit)")
+	interval := flag.Duration("interval", 100*time.Millisecond, "Rate report interval")
+	output := flag.String("output", "", "Write the transmitted packets per second of each interval to <file>")
+	ringFrames := flag.Int("ring", 4096, "TX ring slots")
+	flag.Parse()
+
+	if *iface == "" || *dstMACStr == "" {
+		flag.Usage()
+		os.Exit(1)
+	}
+
+	spec, err := buildSpec(*iface, *dstMACStr, *srcMACStr, *role, *sidsStr, *segLeft, *srcStr,
+		*innerSrcStr, *innerDstStr, uint16(*dstPort), *payload, *algo, *tlvHex)
+	if err != nil {
+		log.Fatalf("[-] invalid packet spec: %v", err)
+	}
+
+	if *flows < 1 || *flows > 0xffff-1024 {
+		log.Fatalf("[-] invalid number of flows: %d", *flows)
+	}
+	templates := make([][]byte, *flows)
+	for i := range templates {
+		templates[i] = spec.build(i)
+	}
+
+	ring, err := newTxRing(*iface, *ringFrames)
+	if err != nil {
+		log.Fatalf("[-] TX ring setup failed: %v", err)
+	}
+	defer ring.Close()
+
+	if err := ring.fill(templates); err != nil {
+		log.Fatalf("[-] TX ring fill failed: %v", err)
+	}
+
+	fmt.Printf("[*] %s: %d flows of %d bytes on %s\n", *role, *flows, len(templates[0]), *iface)
+
+	rates, err := transmit(ring, *duration, *count, *interval)
+	if err != nil {
+		log.Fatalf("[-] transmit failed: %v", err)
+	}
+
+	if *output != "" {
+		if err := writeRates(*output, rates); err != nil {
+			log.Fatalf("[-] write results failed: %v", err)
+		}
+		fmt.Printf("[+] Saved %d intervals to %s\n", len(rates), *output)
+	}
+}
+
+func buildSpec(iface, dstMACStr, srcMACStr, role, sidsStr string, segLeft int, srcStr,
+	innerSrcStr, innerDstStr string, dstPort uint16, payload int, algo, tlvHex string) (*packetSpec, error) {
+
+	spec := &packetSpec{dstPort: dstPort, payload: payload}
+	var err error
+
+	if spec.dstMAC, err = net.ParseMAC(dstMACStr); err != nil {
+		return nil, fmt.Errorf("destination MAC: %w", err)
+	}
+	if srcMACStr == "" {
+		ifi, err := net.InterfaceByName(iface)
+		if err != nil {
+			return nil, fmt.Errorf("interface %s: %w", iface, err)
+		}
+		spec.srcMAC = ifi.HardwareAddr
+	} else if spec.srcMAC, err = net.ParseMAC(srcMACStr); err != nil {
+		return nil, fmt.Errorf("source MAC: %w", err)
+	}
+
+	if spec.innerSrc, err = parseIPv6(innerSrcStr); err != nil {
+		return nil, err
+	}
+	if spec.innerDst, err = parseIPv6(innerDstStr); err != nil {
+		return nil, err
+	}
+	if payload < 0 || payload > 1400 {
+		return nil, fmt.Errorf("payload must be between 0 and 1400 bytes, got %d", payload)
+	}
+
+	switch role {
+	case "headend":
+		return spec, nil
+	case "transit", "egress":
+	default:
+		return nil, fmt.Errorf("unknown role %q", role)
+	}
+
+	if spec.src, err = parseIPv6(srcStr); err != nil {
+		return nil, err
+	}
+	for _, s := range strings.Split(sidsStr, ",") {
+		sid, err := parseIPv6(strings.TrimSpace(s))
+		if err != nil {
+			return nil, err
+		}
+		spec.sids = append(spec.sids, sid)
+	}
+
+	spec.segmentsLeft = segLeft
+	if segLeft < 0 {
+		spec.segmentsLeft = 0
+		if role == "transit" {
+			spec.segmentsLeft = len(spec.sids) - 1
+		}
+	}
+	if spec.segmentsLeft >= len(spec.sids) {
+		return nil, fmt.Errorf("segments left %d out of a %d SIDs list", spec.segmentsLeft, len(spec.sids))
+	}
+	if role == "transit" && spec.segmentsLeft == 0 {
+		return nil, fmt.Errorf("a transit node needs segments left > 0")
+	}
+
+	switch {
+	case tlvHex != "":
+		tlv, err := hex.DecodeString(tlvHex)
+		if err != nil {
+			return nil, fmt.Errorf("TLV: %w", err)
+		}
+		if len(tlv) < potTLVHdrLen+potNonceLen || len(tlv)%8 != 0 {
+			return nil, fmt.Errorf("TLV of %d bytes is not a PoT TLV", len(tlv))
+		}
+		spec.tlv = tlv
+	case algo != "":
+		wlen, ok := witnessLen[algo]
+		if !ok {
+			return nil, fmt.Errorf("unknown algorithm %q", algo)
+		}
+		nonce := make([]byte, potNonceLen)
+		if _, err := rand.Read(nonce); err != nil {
+			return nil, fmt.Errorf("nonce: %w", err)
+		}
+		if spec.tlv, err = potTLV(nonce, make([]byte, wlen)); err != nil {
+			return nil, err
+		}
+	}
+
+	return spec, nil
+}
+
+func parseIPv6(s string) (net.IP, error) {
+	ip := net.ParseIP(s)
+	if ip == nil || ip.To4() != nil {
+		return nil, fmt.Errorf("invalid IPv6 address: %q", s)
+	}
+	return ip, nil
+}
+
+// transmit keeps the ring full until the duration or the packet count is
+// reached, sampling the transmit rate every interval
+func transmit(ring *txRing, duration time.Duration, count uint64, interval time.Duration) ([]float64, error) {
+	sig := make(chan os.Signal, 1)
+	signal.Notify(sig, syscall.SIGINT, syscall.SIGTERM)
+
+	var rates []float64
+	var total, last uint64
+
+	start := time.Now()
+	lastReport := start
+	deadline := start.Add(duration)
+
+	for {
+		batch := ring.frames
+		if count > 0 && count-total < uint64(batch) {
+			batch = int(count - total)
+		}
+
+		sent, err := ring.send(batch)
+		if err != nil {
+			return rates, err
+		}
+		total += uint64(sent)
+
+		now := time.Now()
+		if elapsed := now.Sub(lastReport); elapsed >= interval {
+			pps := float64(total-last) / elapsed.Seconds()
+			rates = append(rates, pps)
+			fmt.Printf("%.3f Mpps\n", pps/1e6)
+			last, lastReport = total, now
+		}
+
+		if (count > 0 && total >= count) || now.After(deadline) {
+			break
+		}
+
+		select {
+		case <-sig:
+			deadline = now
+		default:
+		}
+	}
+
+	elapsed := time.Since(start)
+	fmt.Printf("[+] Sent %d packets in %s, %.3f Mpps\n", total, elapsed.Round(time.Millisecond), float64(total)/elapsed.Seconds()/1e6)
+	return rates, nil
+}
+
+func writeRates(path string, rates []float64) error {
+	f, err := os.Create(path)
+	if err != nil {
+		return err
+	}
+	defer f.Close()
+
+	for _, r := range rates {
+		if _, err := fmt.Fprintf(f, "%f\n", r); err != nil {
+			return err
+		}
+	}
+	return nil
+}
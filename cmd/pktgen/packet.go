@@ -0,0 +1,161 @@
+package main
+
+import (
+	"encoding/binary"
+	"fmt"
+	"net"
+)
+
+const (
+	ethHdrLen  = 14
+	ipv6HdrLen = 40
+	srhHdrLen  = 8
+	udpHdrLen  = 8
+
+	ethPIPv6     = 0x86dd
+	nextHdrIPv6  = 41
+	nextHdrSRH   = 43
+	nextHdrUDP   = 17
+	srhRouting   = 4
+	potTLVType   = 0xfc
+	potNonceLen  = 12
+	potTLVHdrLen = 4
+	hopLimit     = 64
+)
+
+// witnessLen mirrors DIGEST_LEN of bpf/tlv.h for each algorithm
+var witnessLen = map[string]int{
+	"blake3":      32,
+	"siphash":     8,
+	"halfsiphash": 8,
+	"poly1305":    16,
+	"hmac-sha1":   24,
+	"hmac-sha256": 32,
+}
+
+// packetSpec describes the frames of one run, every flow gets its own template
+type packetSpec struct {
+	srcMAC, dstMAC net.HardwareAddr
+
+	// Outer header, only used when sids is not empty
+	src          net.IP
+	sids         []net.IP // path order, the first SID is visited first
+	segmentsLeft int
+	tlv          []byte // complete PoT TLV or nil
+
+	// Inner packet
+	innerSrc, innerDst net.IP
+	dstPort            uint16
+	payload            int
+}
+
+// potTLV returns a PoT TLV with the given nonce and witness, the datapath
+// only accepts TLVs whose wire length is a multiple of 8 bytes
+func potTLV(nonce, witness []byte) ([]byte, error) {
+	if len(nonce) != potNonceLen {
+		return nil, fmt.Errorf("nonce must be %d bytes, got %d", potNonceLen, len(nonce))
+	}
+	wire := potTLVHdrLen + potNonceLen + len(witness)
+	if wire%8 != 0 {
+		return nil, fmt.Errorf("TLV wire length %d is not a multiple of 8", wire)
+	}
+
+	tlv := make([]byte, wire)
+	tlv[0] = potTLVType
+	tlv[1] = byte(wire - 2)
+	copy(tlv[potTLVHdrLen:], nonce)
+	copy(tlv[potTLVHdrLen+potNonceLen:], witness)
+	return tlv, nil
+}
+
+// build returns the Ethernet frame of the given flow, flows differ by the
+// inner UDP source port and the outer flow label
+func (p *packetSpec) build(flow int) []byte {
+	inner := p.innerPacket(flow)
+	if len(p.sids) == 0 {
+		return append(ethHeader(p.srcMAC, p.dstMAC), inner...)
+	}
+
+	srhLen := srhHdrLen + 16*len(p.sids) + len(p.tlv)
+	frame := ethHeader(p.srcMAC, p.dstMAC)
+
+	// The active SID is the destination address, segments are stored in reverse order
+	active := p.sids[len(p.sids)-1-p.segmentsLeft]
+	frame = append(frame, ipv6Header(p.src, active, nextHdrSRH, uint32(flow), srhLen+len(inner))...)
+
+	srh := make([]byte, srhHdrLen, srhLen)
+	srh[0] = nextHdrIPv6
+	srh[1] = byte(srhLen/8 - 1)
+	srh[2] = srhRouting
+	srh[3] = byte(p.segmentsLeft)
+	srh[4] = byte(len(p.sids) - 1)
+	for i := len(p.sids) - 1; i >= 0; i-- {
+		srh = append(srh, p.sids[i].To16()...)
+	}
+	srh = append(srh, p.tlv...)
+
+	frame = append(frame, srh...)
+	return append(frame, inner...)
+}
+
+func (p *packetSpec) innerPacket(flow int) []byte {
+	udpLen := udpHdrLen + p.payload
+	pkt := ipv6Header(p.innerSrc, p.innerDst, nextHdrUDP, 0, udpLen)
+
+	udp := make([]byte, udpLen)
+	binary.BigEndian.PutUint16(udp[0:], uint16(1024+flow))
+	binary.BigEndian.PutUint16(udp[2:], p.dstPort)
+	binary.BigEndian.PutUint16(udp[4:], uint16(udpLen))
+	for i := range udp[udpHdrLen:] {
+		udp[udpHdrLen+i] = byte(i)
+	}
+	binary.BigEndian.PutUint16(udp[6:], udpChecksum(p.innerSrc, p.innerDst, udp))
+
+	return append(pkt, udp...)
+}
+
+func ethHeader(src, dst net.HardwareAddr) []byte {
+	eth := make([]byte, ethHdrLen)
+	copy(eth[0:], dst)
+	copy(eth[6:], src)
+	binary.BigEndian.PutUint16(eth[12:], ethPIPv6)
+	return eth
+}
+
+func ipv6Header(src, dst net.IP, nextHdr byte, flowLabel uint32, payloadLen int) []byte {
+	hdr := make([]byte, ipv6HdrLen)
+	binary.BigEndian.PutUint32(hdr[0:], 6<<28|flowLabel&0xfffff)
+	binary.BigEndian.PutUint16(hdr[4:], uint16(payloadLen))
+	hdr[6] = nextHdr
+	hdr[7] = hopLimit
+	copy(hdr[8:], src.To16())
+	copy(hdr[24:], dst.To16())
+	return hdr
+}
+
+func udpChecksum(src, dst net.IP, udp []byte) uint16 {
+	var sum uint32
+	add := func(b []byte) {
+		for i := 0; i+1 < len(b); i += 2 {
+			sum += uint32(binary.BigEndian.Uint16(b[i:]))
+		}
+		if len(b)%2 == 1 {
+			sum += uint32(b[len(b)-1]) << 8
+		}
+	}
+
+	add(src.To16())
+	add(dst.To16())
+	sum += uint32(len(udp))
+	sum += nextHdrUDP
+	add(udp)
+
+	for sum > 0xffff {
+		sum = sum&0xffff + sum>>16
+	}
+	csum := ^uint16(sum)
+	if csum == 0 {
+		return 0xffff
+	}
+	return csum
+}
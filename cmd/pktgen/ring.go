@@ -0,0 +1,145 @@
+package main
+
+import (
+	"fmt"
+	"net"
+	"sync/atomic"
+	"syscall"
+	"unsafe"
+)
+
+// Values from linux/if_packet.h, not exported by the syscall package
+const (
+	packetTxRing       = 13
+	packetVersion      = 10
+	packetQdiscBypass  = 20
+	tpacketV2          = 1
+	tpStatusAvailable  = 0
+	tpStatusSendReq    = 1
+	tpacket2HdrLen     = 32 // TPACKET_ALIGN(sizeof(struct tpacket2_hdr))
+	ringFrameSize      = 2048
+	ringFramesPerBlock = 2
+	ringBlockSize      = ringFrameSize * ringFramesPerBlock
+)
+
+type tpacketReq struct {
+	blockSize, blockNr, frameSize, frameNr uint32
+}
+
+// txRing is an AF_PACKET TPACKET_V2 transmit ring. The frames are written
+// once, after that every round only hands the slots back to the kernel and
+// flushes the whole ring with a single send(2).
+type txRing struct {
+	fd     int
+	ring   []byte
+	frames int
+	next   int
+}
+
+func newTxRing(iface string, frames int) (*txRing, error) {
+	ifi, err := net.InterfaceByName(iface)
+	if err != nil {
+		return nil, fmt.Errorf("interface %s: %w", iface, err)
+	}
+
+	// Protocol 0, the socket only transmits
+	fd, err := syscall.Socket(syscall.AF_PACKET, syscall.SOCK_RAW, 0)
+	if err != nil {
+		return nil, fmt.Errorf("AF_PACKET socket: %w", err)
+	}
+
+	r := &txRing{fd: fd, frames: frames}
+	if err := r.setup(ifi.Index); err != nil {
+		syscall.Close(fd)
+		return nil, err
+	}
+	return r, nil
+}
+
+func (r *txRing) setup(ifindex int) error {
+	if err := syscall.SetsockoptInt(r.fd, syscall.SOL_PACKET, packetVersion, tpacketV2); err != nil {
+		return fmt.Errorf("PACKET_VERSION: %w", err)
+	}
+
+	// Skip the qdisc layer, the tc egress hook of the sender must not touch the frames
+	if err := syscall.SetsockoptInt(r.fd, syscall.SOL_PACKET, packetQdiscBypass, 1); err != nil {
+		return fmt.Errorf("PACKET_QDISC_BYPASS: %w", err)
+	}
+
+	req := tpacketReq{
+		blockSize: ringBlockSize,
+		blockNr:   uint32((r.frames + ringFramesPerBlock - 1) / ringFramesPerBlock),
+		frameSize: ringFrameSize,
+	}
+	req.frameNr = req.blockNr * ringFramesPerBlock
+	r.frames = int(req.frameNr)
+
+	_, _, errno := syscall.Syscall6(syscall.SYS_SETSOCKOPT, uintptr(r.fd), syscall.SOL_PACKET, packetTxRing,
+		uintptr(unsafe.Pointer(&req)), unsafe.Sizeof(req), 0)
+	if errno != 0 {
+		return fmt.Errorf("PACKET_TX_RING: %w", errno)
+	}
+
+	ring, err := syscall.Mmap(r.fd, 0, int(req.blockSize*req.blockNr), syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_SHARED)
+	if err != nil {
+		return fmt.Errorf("mmap TX ring: %w", err)
+	}
+	r.ring = ring
+
+	sll := syscall.SockaddrLinklayer{Protocol: htons(syscall.ETH_P_ALL), Ifindex: ifindex}
+	if err := syscall.Bind(r.fd, &sll); err != nil {
+		return fmt.Errorf("bind: %w", err)
+	}
+
+	return nil
+}
+
+// fill writes the templates round-robin into every slot of the ring
+func (r *txRing) fill(templates [][]byte) error {
+	for i := 0; i < r.frames; i++ {
+		pkt := templates[i%len(templates)]
+		if len(pkt) > ringFrameSize-tpacket2HdrLen {
+			return fmt.Errorf("frame of %d bytes does not fit a ring slot", len(pkt))
+		}
+
+		slot := r.slot(i)
+		copy(slot[tpacket2HdrLen:], pkt)
+		*(*uint32)(unsafe.Pointer(&slot[4])) = uint32(len(pkt)) // tp_len
+	}
+	return nil
+}
+
+// send queues up to n frames and flushes them, returns how many were queued
+func (r *txRing) send(n int) (int, error) {
+	queued := 0
+	for ; queued < n; queued++ {
+		status := r.status(r.next)
+		if atomic.LoadUint32(status) != tpStatusAvailable {
+			break
+		}
+		atomic.StoreUint32(status, tpStatusSendReq)
+		r.next = (r.next + 1) % r.frames
+	}
+
+	if _, _, errno := syscall.Syscall6(syscall.SYS_SENDTO, uintptr(r.fd), 0, 0, 0, 0, 0); errno != 0 && errno != syscall.ENOBUFS {
+		return queued, fmt.Errorf("send: %w", errno)
+	}
+	return queued, nil
+}
+
+func (r *txRing) slot(i int) []byte {
+	return r.ring[i*ringFrameSize : (i+1)*ringFrameSize]
+}
+
+func (r *txRing) status(i int) *uint32 {
+	return (*uint32)(unsafe.Pointer(&r.ring[i*ringFrameSize]))
+}
+
+func (r *txRing) Close() {
+	syscall.Munmap(r.ring)
+	syscall.Close(r.fd)
+}
+
+func htons(v uint16) uint16 {
+	return v<<8 | v>>8
+}
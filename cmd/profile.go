@@ -0,0 +1,252 @@
+package main
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+	"os"
+	"os/signal"
+	"path/filepath"
+	"sort"
+	"strings"
+	"syscall"
+	"text/tabwriter"
+	"time"
+
+	"github.com/cilium/ebpf"
+	"github.com/cilium/ebpf/btf"
+)
+
+// Mirrors BPF_STATS_RUN_TIME of linux/bpf.h
+const bpfStatsRunTime = 0
+
+// Kernel program names are cut to 15 characters, seg6_pot_tlv_d_steer shows
+// as seg6_pot_tlv_d_
+const progNamePrefix = "seg6_pot_tlv"
+
+// Algorithm of the programs whose BTF carries no seg6_pot_alg_<name> tag,
+// built before it
+const unknownAlgorithm = "unknown"
+
+type progSample struct {
+	name      string
+	algorithm string
+	runs      uint64
+	runtime   time.Duration
+}
+
+// progAlgorithm finds the seg6_pot_alg_<name> variable of seg6-pot-tlv.bpf.c
+// in the BTF of a program, objects of other builds loaded next to this one
+// are told apart
+func progAlgorithm(info *ebpf.ProgramInfo) string {
+	id, ok := info.BTFID()
+	if !ok {
+		return unknownAlgorithm
+	}
+	h, err := btf.NewHandleFromID(id)
+	if err != nil {
+		return unknownAlgorithm
+	}
+	defer h.Close()
+
+	spec, err := h.Spec(nil)
+	if err != nil {
+		return unknownAlgorithm
+	}
+	for algo := range witnessLen {
+		if _, err := spec.AnyTypeByName("seg6_pot_alg_" + strings.ReplaceAll(algo, "-", "_")); err == nil {
+			return algo
+		}
+	}
+	return unknownAlgorithm
+}
+
+// profileStats is the activity of one program over the session. Tail calls
+// run within their entry program, the stages only count when entered directly
+type profileStats struct {
+	Algorithm  string   `json:"algorithm"`
+	Program    string   `json:"program"`
+	ID         uint32   `json:"id"`
+	Interfaces []string `json:"interfaces"`
+	Runs       uint64   `json:"runs"`
+	RunsPerSec float64  `json:"runs_per_sec"`
+	NsPerRun   float64  `json:"ns_per_run"`
+	CPUPercent float64  `json:"cpu_percent"`
+}
+
+// sampleProgs reads the run count and runtime of every PoT program loaded
+func sampleProgs() (map[ebpf.ProgramID]progSample, error) {
+	samples := map[ebpf.ProgramID]progSample{}
+	for id := ebpf.ProgramID(0); ; {
+		next, err := ebpf.ProgramGetNextID(id)
+		if errors.Is(err, os.ErrNotExist) {
+			return samples, nil
+		}
+		if err != nil {
+			return nil, fmt.Errorf("next program ID: %w", err)
+		}
+		id = next
+
+		prog, err := ebpf.NewProgramFromID(id)
+		if errors.Is(err, os.ErrNotExist) {
+			continue // unloaded in between
+		}
+		if err != nil {
+			return nil, fmt.Errorf("open program %d: %w", id, err)
+		}
+		info, err := prog.Info()
+		prog.Close()
+		if err != nil {
+			return nil, fmt.Errorf("program %d info: %w", id, err)
+		}
+		if !strings.HasPrefix(info.Name, progNamePrefix) {
+			continue
+		}
+
+		runs, _ := info.RunCount()
+		runtime, _ := info.Runtime()
+		samples[id] = progSample{name: info.Name, algorithm: progAlgorithm(info), runs: runs, runtime: runtime}
+	}
+}
+
+// pinnedProgIfaces maps the entry programs pinned under dir to the interfaces
+// whose links of the same kind are pinned there, empty without --pin
+func pinnedProgIfaces(dir string) map[ebpf.ProgramID][]string {
+	attached := map[ebpf.ProgramID][]string{}
+	ifaces, err := pinnedInterfaces(dir)
+	if err != nil {
+		return attached
+	}
+
+	for _, kind := range linkKinds {
+		prog, err := ebpf.LoadPinnedProgram(filepath.Join(dir, "progs", kind), nil)
+		if err != nil {
+			continue
+		}
+		info, err := prog.Info()
+		prog.Close()
+		if err != nil {
+			continue
+		}
+		id, ok := info.ID()
+		if !ok {
+			continue
+		}
+		for _, iface := range ifaces {
+			if _, err := os.Stat(filepath.Join(dir, "links", iface, kind)); err == nil {
+				attached[id] = append(attached[id], iface)
+			}
+		}
+	}
+	return attached
+}
+
+// profileProgs turns the kernel runtime statistics on for the length of the
+// session, or until interrupted, and reports what every PoT program cost in
+// between. The stats fd is closed on return, the kernel stops timing the
+// programs once no one holds it unless kernel.bpf_stats_enabled is set.
+func profileProgs(d time.Duration, dir, outputPath string) error {
+	stats, err := ebpf.EnableStats(bpfStatsRunTime)
+	if err != nil {
+		return fmt.Errorf("enable BPF stats: %w", err)
+	}
+	defer stats.Close()
+
+	before, err := sampleProgs()
+	if err != nil {
+		return err
+	}
+	start := time.Now()
+
+	fmt.Printf("[*] Profiling %d programs for %s — press Ctrl-C to stop early\n", len(before), d)
+	stop := make(chan os.Signal, 1)
+	signal.Notify(stop, syscall.SIGINT, syscall.SIGTERM)
+	defer signal.Stop(stop)
+	select {
+	case <-time.After(d):
+	case <-stop:
+	}
+
+	after, err := sampleProgs()
+	if err != nil {
+		return err
+	}
+	elapsed := time.Since(start)
+
+	attached := pinnedProgIfaces(dir)
+	var report []profileStats
+	for id, s := range after {
+		prev := before[id] // zero for programs loaded during the session
+		runs := s.runs - prev.runs
+		ifaces := attached[id]
+		if runs == 0 && len(ifaces) == 0 {
+			continue
+		}
+
+		st := profileStats{
+			Algorithm:  s.algorithm,
+			Program:    s.name,
+			ID:         uint32(id),
+			Interfaces: ifaces,
+			Runs:       runs,
+			RunsPerSec: float64(runs) / elapsed.Seconds(),
+			CPUPercent: 100 * float64(s.runtime-prev.runtime) / float64(elapsed),
+		}
+		if runs > 0 {
+			st.NsPerRun = float64(s.runtime-prev.runtime) / float64(runs)
+		}
+		report = append(report, st)
+	}
+	sort.Slice(report, func(i, j int) bool {
+		if report[i].Algorithm != report[j].Algorithm {
+			return report[i].Algorithm < report[j].Algorithm
+		}
+		return report[i].ID < report[j].ID
+	})
+
+	printProfileStats(report, elapsed)
+
+	if outputPath != "" {
+		out, err := json.MarshalIndent(report, "", "  ")
+		if err != nil {
+			return fmt.Errorf("encode report: %w", err)
+		}
+		if err := os.MkdirAll(filepath.Dir(outputPath), 0o755); err != nil {
+			return fmt.Errorf("create report dir: %w", err)
+		}
+		if err := os.WriteFile(outputPath, append(out, '\n'), 0o644); err != nil {
+			return fmt.Errorf("write report: %w", err)
+		}
+	}
+	return nil
+}
+
+func printProfileStats(report []profileStats, elapsed time.Duration) {
+	if len(report) == 0 {
+		fmt.Println("[*] no PoT program ran during the session")
+		return
+	}
+
+	w := tabwriter.NewWriter(os.Stdout, 0, 0, 2, ' ', 0)
+	fmt.Fprintln(w, "\nALGORITHM\tPROGRAM\tID\tINTERFACES\tRUNS\tRUNS/S\tNS/RUN\tCPU(%)")
+	// Sorted by algorithm, each one closes with its total
+	var runs uint64
+	var cpu float64
+	for i, st := range report {
+		ifaces := "-"
+		if len(st.Interfaces) > 0 {
+			ifaces = strings.Join(st.Interfaces, ",")
+		}
+		fmt.Fprintf(w, "%s\t%s\t%d\t%s\t%d\t%.0f\t%.0f\t%.2f\n",
+			st.Algorithm, st.Program, st.ID, ifaces, st.Runs, st.RunsPerSec, st.NsPerRun, st.CPUPercent)
+		runs += st.Runs
+		cpu += st.CPUPercent
+
+		if i == len(report)-1 || report[i+1].Algorithm != st.Algorithm {
+			fmt.Fprintf(w, "%s\ttotal\t\t\t%d\t%.0f\t\t%.2f\n", st.Algorithm, runs, float64(runs)/elapsed.Seconds(), cpu)
+			runs, cpu = 0, 0
+		}
+	}
+	w.Flush()
+	fmt.Printf("\n[*] CPU(%%) is the share of one CPU over %s\n", elapsed.Round(time.Millisecond))
+}
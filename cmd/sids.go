@@ -0,0 +1,96 @@
+package main
+
+import (
+	"fmt"
+	"net"
+	"os"
+	"text/tabwriter"
+
+	"github.com/cilium/ebpf"
+)
+
+const localSIDMapPath = "/sys/fs/bpf/seg6_pot_sids"
+
+// Mirrors enum pot_sid_action and struct pot_sid_cfg of bpf/pot/forward.h
+var localSIDActions = []string{"none", "end", "end.dt6"}
+
+type localSIDConfig struct {
+	Action uint32
+	Table  uint32
+}
+
+func parseLocalSIDAction(action string) (uint32, error) {
+	for i, name := range localSIDActions {
+		if name == action {
+			return uint32(i), nil
+		}
+	}
+	return 0, fmt.Errorf("unknown action %q (expected none, end or end.dt6)", action)
+}
+
+// updateLocalSID sets the behaviour executed in XDP for a local SID, the
+// "none" action removes it and hands the SID back to the kernel. The table is
+// where End.DT6 looks the inner destination up.
+func updateLocalSID(sidStr, action string, table uint32) error {
+	ip := net.ParseIP(sidStr)
+	if ip == nil || ip.To16() == nil {
+		return fmt.Errorf("invalid IPv6 SID: %q", sidStr)
+	}
+	sid := ip.To16()
+
+	act, err := parseLocalSIDAction(action)
+	if err != nil {
+		return err
+	}
+
+	m, err := ebpf.LoadPinnedMap(localSIDMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer m.Close()
+
+	if act == 0 {
+		if err := m.Delete(sid); err != nil {
+			return fmt.Errorf("map.Delete: %w", err)
+		}
+		return nil
+	}
+
+	cfg := localSIDConfig{Action: act, Table: table}
+	if err := m.Update(sid, cfg, ebpf.UpdateAny); err != nil {
+		return fmt.Errorf("map.Update: %w", err)
+	}
+	return nil
+}
+
+func listLocalSIDs() error {
+	m, err := ebpf.LoadPinnedMap(localSIDMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer m.Close()
+
+	var sid [16]byte
+	var cfg localSIDConfig
+	it := m.Iterate()
+
+	w := tabwriter.NewWriter(os.Stdout, 0, 0, 2, ' ', 0)
+	fmt.Fprintln(w, "SID\tACTION\tTABLE")
+
+	for it.Next(&sid, &cfg) {
+		name := fmt.Sprintf("unknown(%d)", cfg.Action)
+		if int(cfg.Action) < len(localSIDActions) {
+			name = localSIDActions[cfg.Action]
+		}
+		table := "-"
+		if name == "end.dt6" {
+			table = fmt.Sprint(cfg.Table)
+		}
+		fmt.Fprintf(w, "%s\t%s\t%s\n", net.IP(sid[:]).String(), name, table)
+	}
+	if err := it.Err(); err != nil {
+		return fmt.Errorf("iterate map: %w", err)
+	}
+
+	return w.Flush()
+}
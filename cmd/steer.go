@@ -0,0 +1,117 @@
+package main
+
+import (
+	"fmt"
+	"strconv"
+	"strings"
+	"unsafe"
+
+	bpf "github.com/aquasecurity/libbpfgo"
+)
+
+// Mirrors POT_MAX_CPUS of bpf/pot/flow.h
+const maxSteerCPUs = 128
+
+// Programs of the validation pipeline, they run as cpumap programs when steering
+var pipelinePrograms = []string{
+	"seg6_pot_tlv_d",
+	"seg6_pot_tlv_d_witness",
+	"seg6_pot_tlv_d_chain",
+	"seg6_pot_tlv_d_decap",
+	"seg6_pot_tlv_d_strip",
+	"seg6_pot_tlv_d_forward",
+}
+
+// Mirrors struct bpf_cpumap_val of linux/bpf.h
+type cpumapVal struct {
+	Qsize  uint32
+	ProgFd int32
+}
+
+// parseCPUList parses a list like "0-3,6" into CPU numbers
+func parseCPUList(list string) ([]uint32, error) {
+	var cpus []uint32
+	seen := map[uint32]bool{}
+
+	for _, part := range strings.Split(list, ",") {
+		first, last, isRange := strings.Cut(strings.TrimSpace(part), "-")
+		lo, err := strconv.ParseUint(first, 10, 32)
+		if err != nil {
+			return nil, fmt.Errorf("invalid CPU %q", part)
+		}
+		hi := lo
+		if isRange {
+			if hi, err = strconv.ParseUint(last, 10, 32); err != nil || hi < lo {
+				return nil, fmt.Errorf("invalid CPU range %q", part)
+			}
+		}
+
+		for cpu := lo; cpu <= hi; cpu++ {
+			if cpu >= maxSteerCPUs {
+				return nil, fmt.Errorf("CPU %d above the limit of %d", cpu, maxSteerCPUs)
+			}
+			if !seen[uint32(cpu)] {
+				seen[uint32(cpu)] = true
+				cpus = append(cpus, uint32(cpu))
+			}
+		}
+	}
+	return cpus, nil
+}
+
+// parseCPUFlag parses --cpus, empty when not steering
+func parseCPUFlag(list string) ([]uint32, error) {
+	if list == "" {
+		return nil, nil
+	}
+	return parseCPUList(list)
+}
+
+// prepareSteering turns the pipeline into cpumap programs, it must run before
+// the object is loaded
+func prepareSteering(module *bpf.Module, cpus []uint32) error {
+	for _, name := range pipelinePrograms {
+		prog, err := module.GetProgram(name)
+		if err != nil || prog == nil {
+			return fmt.Errorf("get program %s: %w", name, err)
+		}
+		if err := prog.SetExpectedAttachType(bpf.BPFAttachTypeXDPCPUMap); err != nil {
+			return fmt.Errorf("set %s attach type: %w", name, err)
+		}
+	}
+
+	if err := module.InitGlobalVariable("pot_steer_cpus", uint32(len(cpus))); err != nil {
+		return fmt.Errorf("set pot_steer_cpus: %w", err)
+	}
+	return nil
+}
+
+// fillCPUMap installs the pipeline entry on every steering CPU with a queue of qsize frames
+func fillCPUMap(module *bpf.Module, cpus []uint32, qsize uint32) error {
+	entry, err := module.GetProgram("seg6_pot_tlv_d")
+	if err != nil || entry == nil {
+		return fmt.Errorf("get program seg6_pot_tlv_d: %w", err)
+	}
+
+	cpumap, err := module.GetMap("seg6_pot_cpumap")
+	if err != nil {
+		return fmt.Errorf("get map seg6_pot_cpumap: %w", err)
+	}
+	slots, err := module.GetMap("seg6_pot_cpus")
+	if err != nil {
+		return fmt.Errorf("get map seg6_pot_cpus: %w", err)
+	}
+
+	val := cpumapVal{Qsize: qsize, ProgFd: int32(entry.FileDescriptor())}
+	for i, cpu := range cpus {
+		if err := cpumap.Update(unsafe.Pointer(&cpu), unsafe.Pointer(&val)); err != nil {
+			return fmt.Errorf("add CPU %d to cpumap: %w", cpu, err)
+		}
+
+		slot := uint32(i)
+		if err := slots.Update(unsafe.Pointer(&slot), unsafe.Pointer(&cpu)); err != nil {
+			return fmt.Errorf("add CPU %d to slot %d: %w", cpu, slot, err)
+		}
+	}
+	return nil
+}
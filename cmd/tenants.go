@@ -0,0 +1,307 @@
+package main
+
+import (
+	"bufio"
+	"encoding/hex"
+	"errors"
+	"fmt"
+	"net"
+	"os"
+	"path/filepath"
+	"strings"
+	"text/tabwriter"
+
+	"github.com/cilium/ebpf"
+)
+
+const (
+	tenantsMapPath = "/sys/fs/bpf/seg6_pot_tenants"
+
+	// Every tenant's key set is pinned as <tenantDir>/<name>
+	tenantDir = "/sys/fs/bpf/seg6_pot_tenant"
+)
+
+func tenantPath(name string) string {
+	return filepath.Join(tenantDir, name)
+}
+
+func validTenantName(name string) error {
+	if name == "" || name == "." || name == ".." || strings.ContainsRune(name, '/') {
+		return fmt.Errorf("invalid tenant name %q", name)
+	}
+	return nil
+}
+
+// readKeyFile parses the "<sid> <key>" lines also read by seg6-pot-audit
+func readKeyFile(path string) (map[[16]byte][32]byte, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+
+	keys := map[[16]byte][32]byte{}
+	sc := bufio.NewScanner(f)
+	for line := 1; sc.Scan(); line++ {
+		fields := strings.Fields(sc.Text())
+		if len(fields) == 0 || strings.HasPrefix(fields[0], "#") {
+			continue
+		}
+		if len(fields) != 2 {
+			return nil, fmt.Errorf("%s:%d: expected \"<sid> <key>\"", path, line)
+		}
+		ip := net.ParseIP(fields[0])
+		if ip == nil || ip.To16() == nil {
+			return nil, fmt.Errorf("%s:%d: invalid IPv6 SID %q", path, line, fields[0])
+		}
+		raw, err := hex.DecodeString(fields[1])
+		if err != nil || len(raw) != 32 {
+			return nil, fmt.Errorf("%s:%d: key must be 64 hex digits", path, line)
+		}
+
+		var sid [16]byte
+		var key [32]byte
+		copy(sid[:], ip.To16())
+		copy(key[:], raw)
+		keys[sid] = key
+	}
+	return keys, sc.Err()
+}
+
+func newKeySet(size uint32, keys map[[16]byte][32]byte) (*ebpf.Map, error) {
+	if len(keys) > int(size) {
+		return nil, fmt.Errorf("%d keys, the tenant holds at most %d", len(keys), size)
+	}
+
+	// Only the type, key and value sizes must match the inner map of seg6_pot_tenants
+	m, err := ebpf.NewMap(&ebpf.MapSpec{
+		Name:       "seg6_pot_tenant",
+		Type:       ebpf.Hash,
+		KeySize:    16,
+		ValueSize:  32,
+		MaxEntries: size,
+	})
+	if err != nil {
+		return nil, fmt.Errorf("create key set: %w", err)
+	}
+	for sid, key := range keys {
+		if err := m.Put(sid, key); err != nil {
+			m.Close()
+			return nil, fmt.Errorf("map.Put: %w", err)
+		}
+	}
+	return m, nil
+}
+
+func mapID(m *ebpf.Map) (ebpf.MapID, error) {
+	info, err := m.Info()
+	if err != nil {
+		return 0, err
+	}
+	id, ok := info.ID()
+	if !ok {
+		return 0, fmt.Errorf("map ID not available")
+	}
+	return id, nil
+}
+
+// tenantBindings returns every interface whose key set is the map with id
+func tenantBindings(tenants *ebpf.Map, id ebpf.MapID) ([]uint32, error) {
+	var ifindexes []uint32
+	var ifindex, inner uint32
+	it := tenants.Iterate()
+	for it.Next(&ifindex, &inner) {
+		if ebpf.MapID(inner) == id {
+			ifindexes = append(ifindexes, ifindex)
+		}
+	}
+	if err := it.Err(); err != nil {
+		return nil, fmt.Errorf("iterate map: %w", err)
+	}
+	return ifindexes, nil
+}
+
+// setTenant creates the key set of a tenant, or replaces it with the keys of
+// keyFile on every interface it is bound to, then binds it to ifaces. Each
+// interface switches with a single update of seg6_pot_tenants, its packets
+// are validated with either the old or the new keys, never a mix.
+func setTenant(name string, size uint32, keyFile string, ifaces []string) error {
+	if err := validTenantName(name); err != nil {
+		return err
+	}
+	if size == 0 {
+		return fmt.Errorf("invalid tenant size %d", size)
+	}
+
+	tenants, err := ebpf.LoadPinnedMap(tenantsMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer tenants.Close()
+
+	var ifindexes []uint32
+	for _, iface := range ifaces {
+		ifc, err := net.InterfaceByName(iface)
+		if err != nil {
+			return fmt.Errorf("lookup interface %s: %w", iface, err)
+		}
+		ifindexes = append(ifindexes, uint32(ifc.Index))
+	}
+
+	path := tenantPath(name)
+	current, err := ebpf.LoadPinnedMap(path, &ebpf.LoadPinOptions{})
+	if err != nil && !errors.Is(err, os.ErrNotExist) {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+
+	pinned := ""
+	if current == nil || keyFile != "" {
+		keys := map[[16]byte][32]byte{}
+		if keyFile != "" {
+			if keys, err = readKeyFile(keyFile); err != nil {
+				return err
+			}
+		}
+
+		next, err := newKeySet(size, keys)
+		if err != nil {
+			return err
+		}
+		defer next.Close()
+
+		if current != nil {
+			id, err := mapID(current)
+			current.Close()
+			if err != nil {
+				return err
+			}
+			bound, err := tenantBindings(tenants, id)
+			if err != nil {
+				return err
+			}
+			ifindexes = append(bound, ifindexes...)
+		}
+
+		if err := os.MkdirAll(tenantDir, 0o755); err != nil {
+			return fmt.Errorf("create %s: %w", tenantDir, err)
+		}
+		pinned = path + ".next"
+		os.Remove(pinned)
+		if err := next.Pin(pinned); err != nil {
+			return fmt.Errorf("pin key set: %w", err)
+		}
+		current = next
+	} else {
+		defer current.Close()
+	}
+
+	for _, ifindex := range ifindexes {
+		if err := tenants.Update(ifindex, current, ebpf.UpdateAny); err != nil {
+			if pinned != "" {
+				os.Remove(pinned)
+			}
+			return fmt.Errorf("bind ifindex %d: %w", ifindex, err)
+		}
+	}
+
+	// The pin of the tenant follows its interfaces once they all switched
+	if pinned != "" {
+		if err := os.Rename(pinned, path); err != nil {
+			return fmt.Errorf("pin key set: %w", err)
+		}
+	}
+	return nil
+}
+
+func removeTenant(name string) error {
+	if err := validTenantName(name); err != nil {
+		return err
+	}
+
+	tenants, err := ebpf.LoadPinnedMap(tenantsMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer tenants.Close()
+
+	m, err := ebpf.LoadPinnedMap(tenantPath(name), &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	id, err := mapID(m)
+	m.Close()
+	if err != nil {
+		return err
+	}
+
+	bound, err := tenantBindings(tenants, id)
+	if err != nil {
+		return err
+	}
+	// Back to the default key set
+	for _, ifindex := range bound {
+		if err := tenants.Delete(ifindex); err != nil && !errors.Is(err, ebpf.ErrKeyNotExist) {
+			return fmt.Errorf("map.Delete: %w", err)
+		}
+	}
+	return os.Remove(tenantPath(name))
+}
+
+func listTenants() error {
+	tenants, err := ebpf.LoadPinnedMap(tenantsMapPath, &ebpf.LoadPinOptions{})
+	if err != nil {
+		return fmt.Errorf("open pinned map: %w", err)
+	}
+	defer tenants.Close()
+
+	entries, err := os.ReadDir(tenantDir)
+	if err != nil && !errors.Is(err, os.ErrNotExist) {
+		return err
+	}
+
+	w := tabwriter.NewWriter(os.Stdout, 0, 0, 2, ' ', 0)
+	fmt.Fprintln(w, "TENANT\tSIZE\tKEYS\tINTERFACES")
+
+	for _, entry := range entries {
+		if strings.HasSuffix(entry.Name(), ".next") {
+			continue
+		}
+		m, err := ebpf.LoadPinnedMap(tenantPath(entry.Name()), &ebpf.LoadPinOptions{})
+		if err != nil {
+			return fmt.Errorf("open pinned map: %w", err)
+		}
+
+		keys := 0
+		var sid [16]byte
+		var key [32]byte
+		it := m.Iterate()
+		for it.Next(&sid, &key) {
+			keys++
+		}
+		id, idErr := mapID(m)
+		size := m.MaxEntries()
+		m.Close()
+		if err := it.Err(); err != nil {
+			return fmt.Errorf("iterate map: %w", err)
+		}
+		if idErr != nil {
+			return idErr
+		}
+
+		bound, err := tenantBindings(tenants, id)
+		if err != nil {
+			return err
+		}
+		var names []string
+		for _, ifindex := range bound {
+			name := fmt.Sprintf("ifindex%d", ifindex)
+			if ifc, err := net.InterfaceByIndex(int(ifindex)); err == nil {
+				name = ifc.Name
+			}
+			names = append(names, name)
+		}
+		fmt.Fprintf(w, "%s\t%d\t%d\t%s\n", entry.Name(), size, keys, strings.Join(names, ","))
+	}
+
+	return w.Flush()
+}
@@ -0,0 +1,273 @@
+package main
+
+import (
+	"bytes"
+	"crypto/rand"
+	"encoding/binary"
+	"encoding/hex"
+	"fmt"
+	"net"
+	"os"
+	"path/filepath"
+	"strings"
+
+	"github.com/cilium/ebpf"
+)
+
+const (
+	ethHdrLen  = 14
+	ipv6HdrLen = 40
+	srhHdrLen  = 8
+	udpHdrLen  = 8
+
+	nextHdrHopOpts = 0
+	nextHdrIPv6    = 41
+	nextHdrSRH     = 43
+	nextHdrUDP     = 17
+	potTLVType     = 0xfc
+	srhTLVHMAC     = 0x05
+	potNonceLen    = 12
+	potTLVHdrLen   = 4
+
+	xdpDrop = 1
+	xdpPass = 2
+
+	// Packets run through the datapath per object, each with its own nonce
+	vectorRuns = 16
+)
+
+// witnessLen mirrors DIGEST_LEN of bpf/tlv.h for each algorithm
+var witnessLen = map[string]int{
+	"blake3":      32,
+	"siphash":     8,
+	"halfsiphash": 8,
+	"poly1305":    16,
+	"hmac-sha1":   24,
+	"hmac-sha256": 32,
+}
+
+// vectorSIDs is the path of the recorded packets, the first SID is visited first
+var vectorSIDs = []net.IP{
+	net.ParseIP("2001:db8:ff:2::1"),
+	net.ParseIP("2001:db8:ff:3::1"),
+	net.ParseIP("2001:db8:ff:4::1"),
+}
+
+// testVectors runs packets through seg6_pot_tlv_d of every object with
+// BPF_PROG_TEST_RUN, nothing is pinned or attached, and writes every transit
+// hop and egress verdict in the format of libpot/check.c
+func testVectors(outputPath string, objects []string) error {
+	var out bytes.Buffer
+	fmt.Fprintf(&out, "# hop  <algo> <key> <nonce> <witness-in> <witness-out>\n")
+	fmt.Fprintf(&out, "# path <algo> <pass|drop> <nonce> <witness> <key>[,<key>...]\n")
+
+	if len(objects) == 0 {
+		if err := objectVectors(&out, algorithm, "embedded object", bpfObj); err != nil {
+			return err
+		}
+	}
+
+	for _, path := range objects {
+		obj, err := os.ReadFile(path)
+		if err != nil {
+			return fmt.Errorf("read object: %w", err)
+		}
+		algo := strings.TrimSuffix(strings.TrimPrefix(filepath.Base(path), "seg6_pot_tlv_"), ".o")
+		if err := objectVectors(&out, algo, path, obj); err != nil {
+			return err
+		}
+	}
+
+	if err := os.MkdirAll(filepath.Dir(outputPath), 0o755); err != nil {
+		return fmt.Errorf("create vectors dir: %w", err)
+	}
+	return os.WriteFile(outputPath, out.Bytes(), 0o644)
+}
+
+func objectVectors(out *bytes.Buffer, algo, name string, obj []byte) error {
+	wlen, ok := witnessLen[algo]
+	if !ok {
+		return fmt.Errorf("%s: unknown algorithm %q", name, algo)
+	}
+
+	spec, err := ebpf.LoadCollectionSpecFromReader(bytes.NewReader(obj))
+	if err != nil {
+		return fmt.Errorf("parse %s: %w", name, err)
+	}
+
+	// Throwaway load: private maps only, nothing reaches the bpffs
+	for _, m := range spec.Maps {
+		m.Pinning = ebpf.PinNone
+	}
+
+	coll, err := ebpf.NewCollection(spec)
+	if err != nil {
+		return fmt.Errorf("load %s: %w", name, err)
+	}
+	defer coll.Close()
+
+	prog, keysMap := coll.Programs["seg6_pot_tlv_d"], coll.Maps["seg6_pot_keys"]
+	if prog == nil || keysMap == nil {
+		return fmt.Errorf("%s: missing seg6_pot_tlv_d or seg6_pot_keys", name)
+	}
+
+	keys := make([][]byte, len(vectorSIDs))
+	keyHex := make([]string, len(vectorSIDs))
+	for i, sid := range vectorSIDs {
+		keys[i] = randomBytes(32)
+		keyHex[i] = hex.EncodeToString(keys[i])
+		if err := keysMap.Update(sid.To16(), keys[i], ebpf.UpdateAny); err != nil {
+			return fmt.Errorf("%s: set key of %s: %w", name, sid, err)
+		}
+	}
+
+	for run := 0; run < vectorRuns; run++ {
+		nonce := randomBytes(potNonceLen)
+		witness := make([]byte, wlen) // as init_tlv leaves it at the head-end
+
+		// Transit hops, the key is the one of the active SID
+		for sl := len(vectorSIDs) - 1; sl > 0; sl-- {
+			hop := len(vectorSIDs) - 1 - sl
+			frame := vectorFrame(sl, nonce, witness)
+
+			data := make([]byte, len(frame))
+			ret, err := prog.Run(&ebpf.RunOptions{Data: frame, DataOut: data})
+			if err != nil {
+				return fmt.Errorf("%s: run hop %d: %w", name, hop, err)
+			}
+			if ret != xdpPass {
+				return fmt.Errorf("%s: hop %d returned %d", name, hop, ret)
+			}
+
+			next := data[vectorTLVOffset()+potTLVHdrLen+potNonceLen:][:wlen]
+			fmt.Fprintf(out, "hop %s %s %x %x %x\n", algo, keyHex[hop], nonce, witness, next)
+			witness = append([]byte(nil), next...)
+		}
+
+		// Egress, once as received and once with a flipped witness bit
+		tampered := append([]byte(nil), witness...)
+		tampered[run%wlen] ^= 1 << (run % 8)
+
+		for _, w := range [][]byte{witness, tampered} {
+			ret, err := prog.Run(&ebpf.RunOptions{Data: vectorFrame(0, nonce, w), DataOut: make([]byte, 2048)})
+			if err != nil {
+				return fmt.Errorf("%s: run egress: %w", name, err)
+			}
+
+			var verdict string
+			switch ret {
+			case xdpPass:
+				verdict = "pass"
+			case xdpDrop:
+				verdict = "drop"
+			default:
+				return fmt.Errorf("%s: egress returned %d", name, ret)
+			}
+			fmt.Fprintf(out, "path %s %s %x %x %s\n", algo, verdict, nonce, w, strings.Join(keyHex, ","))
+		}
+	}
+
+	fmt.Printf("[+] Recorded %d packets of %s\n", vectorRuns, name)
+	return nil
+}
+
+func vectorTLVOffset() int {
+	return ethHdrLen + ipv6HdrLen + srhHdrLen + 16*len(vectorSIDs)
+}
+
+// vectorFrame is an SRv6 packet on vectorSIDs carrying the PoT TLV, sent to
+// the SID of segments left sl with a small UDP datagram inside
+func vectorFrame(sl int, nonce, witness []byte) []byte {
+	return srv6Frame(sl, potTLV(nonce, witness))
+}
+
+// tlvType is the PoT TLV type of the packets, objects built before the TLV walker used 0x04
+var tlvType byte = potTLVType
+
+// hopTS flags the TLV as carrying the hop timestamps of a HOPTS=1 object, the
+// witness then holds the slots after the digest
+var hopTS bool
+
+func potTLV(nonce, witness []byte) []byte {
+	tlv := []byte{tlvType, byte(potTLVHdrLen + potNonceLen + len(witness) - 2), 0, 0}
+	if hopTS {
+		tlv[2] = 0x40 // POT_TLV_F_HOPTS
+	}
+	tlv = append(tlv, nonce...)
+	return append(tlv, witness...)
+}
+
+// srv6Frame is the packet of vectorFrame with any TLV, or none as the
+// head-end receives it from the kernel encapsulation
+func srv6Frame(sl int, tlv []byte) []byte {
+	return srhFrame(vectorSIDs, sl, vectorSIDs[len(vectorSIDs)-1-sl], tlv)
+}
+
+// srhFrame is an SRv6 packet on segments, in path order, sent to daddr
+func srhFrame(segments []net.IP, sl int, daddr net.IP, tlv []byte) []byte {
+	n := len(segments)
+	srhLen := srhHdrLen + 16*n + len(tlv)
+
+	inner := make([]byte, ipv6HdrLen+udpHdrLen+16)
+	binary.BigEndian.PutUint32(inner[0:], 6<<28)
+	binary.BigEndian.PutUint16(inner[4:], udpHdrLen+16)
+	inner[6] = nextHdrUDP
+	inner[7] = 64
+	copy(inner[8:], net.ParseIP("2001:db8:1::1").To16())
+	copy(inner[24:], net.ParseIP("2001:db8:5::1").To16())
+	binary.BigEndian.PutUint16(inner[ipv6HdrLen:], 1024)
+	binary.BigEndian.PutUint16(inner[ipv6HdrLen+2:], 5201)
+	binary.BigEndian.PutUint16(inner[ipv6HdrLen+4:], udpHdrLen+16)
+
+	frame := make([]byte, ethHdrLen+ipv6HdrLen, ethHdrLen+ipv6HdrLen+srhLen+len(inner))
+	binary.BigEndian.PutUint16(frame[12:], 0x86dd) // ETH_P_IPV6
+	ip := frame[ethHdrLen:]
+	binary.BigEndian.PutUint32(ip[0:], 6<<28)
+	binary.BigEndian.PutUint16(ip[4:], uint16(srhLen+len(inner)))
+	ip[6] = nextHdrSRH
+	ip[7] = 64
+	copy(ip[8:], net.ParseIP("2001:db8:ff:1::1").To16())
+	copy(ip[24:], daddr.To16())
+
+	// Segments are stored in reverse order, the TLV right after them
+	frame = append(frame, nextHdrIPv6, byte(srhLen/8-1), 4, byte(sl), byte(n-1), 0, 0, 0)
+	for i := n - 1; i >= 0; i-- {
+		frame = append(frame, segments[i].To16()...)
+	}
+	frame = append(frame, tlv...)
+
+	return append(frame, inner...)
+}
+
+// vlanFrame tags an untagged frame, the outer tag of two is 802.1ad (QinQ)
+func vlanFrame(frame []byte, vids ...uint16) []byte {
+	out := append([]byte(nil), frame[:12]...)
+	for i, vid := range vids {
+		tpid := uint16(0x8100)
+		if i == 0 && len(vids) > 1 {
+			tpid = 0x88a8
+		}
+		out = binary.BigEndian.AppendUint16(out, tpid)
+		out = binary.BigEndian.AppendUint16(out, vid)
+	}
+	return append(out, frame[12:]...)
+}
+
+// hbhFrame puts a Hop-by-Hop Options header, padded with PadN, right after
+// the IPv6 header of an untagged frame
+func hbhFrame(frame []byte) []byte {
+	out := append([]byte(nil), frame[:ethHdrLen+ipv6HdrLen]...)
+	out = append(out, frame[ethHdrLen+6], 0, 1, 4, 0, 0, 0, 0)
+	ip := out[ethHdrLen:]
+	ip[6] = nextHdrHopOpts
+	binary.BigEndian.PutUint16(ip[4:], binary.BigEndian.Uint16(ip[4:])+8)
+	return append(out, frame[ethHdrLen+ipv6HdrLen:]...)
+}
+
+func randomBytes(n int) []byte {
+	b := make([]byte, n)
+	if _, err := rand.Read(b); err != nil {
+		panic(err)
+	}
+	return b
+}
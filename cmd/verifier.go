@@ -0,0 +1,225 @@
+package main
+
+import (
+	"bytes"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"regexp"
+	"sort"
+	"strconv"
+	"strings"
+	"text/tabwriter"
+
+	"github.com/cilium/ebpf"
+)
+
+// verifierCost is the load-time cost of a single program of an object.
+type verifierCost struct {
+	Kernel         string `json:"kernel"`
+	Object         string `json:"object"`
+	Program        string `json:"program"`
+	VerifiedInsns  uint32 `json:"verified_insns"`
+	ProcessedInsns uint32 `json:"processed_insns"`
+	TotalStates    uint32 `json:"total_states"`
+	PeakStates     uint32 `json:"peak_states"`
+	StackDepth     uint32 `json:"stack_depth"`
+	XlatedBytes    uint32 `json:"xlated_bytes"`
+	JitedBytes     uint32 `json:"jited_bytes"`
+	Error          string `json:"error,omitempty"`
+}
+
+var (
+	processedRe  = regexp.MustCompile(`processed (\d+) insns \(limit \d+\) max_states_per_insn \d+ total_states (\d+) peak_states (\d+)`)
+	stackDepthRe = regexp.MustCompile(`stack depth ([0-9+]+)`)
+)
+
+// verifierReport loads every object into the kernel without pinning or attaching
+// anything, so production maps and links are never touched, and collects the
+// verifier statistics and image sizes of each program.
+func verifierReport(objects []string, baselinePath, outputPath string) error {
+	var costs []verifierCost
+
+	// Verifier and JIT costs move with the kernel as much as with the code
+	kernel := kernelRelease()
+
+	if len(objects) == 0 {
+		c, err := objectCost(kernel, fmt.Sprintf("seg6_pot_tlv_%s.o", algorithm), bpfObj)
+		if err != nil {
+			return err
+		}
+		costs = append(costs, c...)
+	}
+
+	for _, path := range objects {
+		obj, err := os.ReadFile(path)
+		if err != nil {
+			return fmt.Errorf("read object: %w", err)
+		}
+		c, err := objectCost(kernel, filepath.Base(path), obj)
+		if err != nil {
+			return err
+		}
+		costs = append(costs, c...)
+	}
+
+	var baseline map[string]verifierCost
+	if baselinePath != "" {
+		var err error
+		if baseline, err = loadVerifierBaseline(baselinePath, kernel); err != nil {
+			return err
+		}
+	}
+
+	printVerifierCosts(costs, baseline)
+
+	if outputPath == "" {
+		return nil
+	}
+
+	out, err := json.MarshalIndent(costs, "", "  ")
+	if err != nil {
+		return fmt.Errorf("encode report: %w", err)
+	}
+	if err := os.MkdirAll(filepath.Dir(outputPath), 0o755); err != nil {
+		return fmt.Errorf("create report dir: %w", err)
+	}
+	return os.WriteFile(outputPath, append(out, '\n'), 0o644)
+}
+
+func objectCost(kernel, name string, obj []byte) ([]verifierCost, error) {
+	spec, err := ebpf.LoadCollectionSpecFromReader(bytes.NewReader(obj))
+	if err != nil {
+		return nil, fmt.Errorf("parse %s: %w", name, err)
+	}
+
+	// Throwaway load: private maps only, nothing reaches the bpffs
+	for _, m := range spec.Maps {
+		m.Pinning = ebpf.PinNone
+	}
+
+	coll, err := ebpf.NewCollectionWithOptions(spec, ebpf.CollectionOptions{
+		Programs: ebpf.ProgramOptions{LogLevel: ebpf.LogLevelStats},
+	})
+	if err != nil {
+		var verr *ebpf.VerifierError
+		msg := err.Error()
+		if errors.As(err, &verr) && len(verr.Log) > 0 {
+			msg = verr.Log[len(verr.Log)-1]
+		}
+		return []verifierCost{{Kernel: kernel, Object: name, Program: "*", Error: msg}}, nil
+	}
+	defer coll.Close()
+
+	names := make([]string, 0, len(coll.Programs))
+	for n := range coll.Programs {
+		names = append(names, n)
+	}
+	sort.Strings(names)
+
+	costs := make([]verifierCost, 0, len(names))
+	for _, n := range names {
+		prog := coll.Programs[n]
+		c := verifierCost{Kernel: kernel, Object: name, Program: n}
+
+		if m := processedRe.FindStringSubmatch(prog.VerifierLog); m != nil {
+			c.ProcessedInsns = parseU32(m[1])
+			c.TotalStates = parseU32(m[2])
+			c.PeakStates = parseU32(m[3])
+		}
+		if m := stackDepthRe.FindStringSubmatch(prog.VerifierLog); m != nil {
+			for _, frame := range strings.Split(m[1], "+") {
+				c.StackDepth += parseU32(frame)
+			}
+		}
+
+		info, err := prog.Info()
+		if err != nil {
+			return nil, fmt.Errorf("program info %s/%s: %w", name, n, err)
+		}
+		if v, ok := info.VerifiedInstructions(); ok {
+			c.VerifiedInsns = v
+		}
+		if v, err := info.TranslatedSize(); err == nil {
+			c.XlatedBytes = uint32(v)
+		}
+		if v, err := info.JitedSize(); err == nil {
+			c.JitedBytes = v
+		}
+
+		costs = append(costs, c)
+	}
+
+	return costs, nil
+}
+
+func parseU32(s string) uint32 {
+	v, _ := strconv.ParseUint(s, 10, 32)
+	return uint32(v)
+}
+
+func kernelRelease() string {
+	raw, err := os.ReadFile("/proc/sys/kernel/osrelease")
+	if err != nil {
+		return "unknown"
+	}
+	return strings.TrimSpace(string(raw))
+}
+
+func loadVerifierBaseline(path, kernel string) (map[string]verifierCost, error) {
+	raw, err := os.ReadFile(path)
+	if errors.Is(err, os.ErrNotExist) {
+		fmt.Fprintf(os.Stderr, "[*] no verifier baseline at %s, skipping comparison\n", path)
+		return nil, nil
+	}
+	if err != nil {
+		return nil, fmt.Errorf("read baseline: %w", err)
+	}
+
+	var costs []verifierCost
+	if err := json.Unmarshal(raw, &costs); err != nil {
+		return nil, fmt.Errorf("decode baseline: %w", err)
+	}
+
+	baseline := make(map[string]verifierCost, len(costs))
+	for i, c := range costs {
+		if i == 0 && c.Kernel != kernel {
+			fmt.Fprintf(os.Stderr, "[*] verifier baseline recorded on kernel %q, running %q, deltas include the kernel change\n", c.Kernel, kernel)
+		}
+		baseline[c.Object+"/"+c.Program] = c
+	}
+	return baseline, nil
+}
+
+func printVerifierCosts(costs []verifierCost, baseline map[string]verifierCost) {
+	w := tabwriter.NewWriter(os.Stdout, 0, 0, 2, ' ', 0)
+	fmt.Fprintln(w, "OBJECT\tPROGRAM\tVERIFIED\tPROCESSED\tSTATES\tPEAK\tSTACK\tXLATED\tJITED")
+
+	for _, c := range costs {
+		if c.Error != "" {
+			fmt.Fprintf(w, "%s\t%s\tFAILED: %s\n", c.Object, c.Program, c.Error)
+			continue
+		}
+
+		base, ok := baseline[c.Object+"/"+c.Program]
+		fmt.Fprintf(w, "%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\n", c.Object, c.Program,
+			costDelta(c.VerifiedInsns, base.VerifiedInsns, ok),
+			costDelta(c.ProcessedInsns, base.ProcessedInsns, ok),
+			costDelta(c.TotalStates, base.TotalStates, ok),
+			costDelta(c.PeakStates, base.PeakStates, ok),
+			costDelta(c.StackDepth, base.StackDepth, ok),
+			costDelta(c.XlatedBytes, base.XlatedBytes, ok),
+			costDelta(c.JitedBytes, base.JitedBytes, ok))
+	}
+
+	w.Flush()
+}
+
+func costDelta(cur, base uint32, ok bool) string {
+	if !ok || cur == base {
+		return strconv.FormatUint(uint64(cur), 10)
+	}
+	return fmt.Sprintf("%d (%+d)", cur, int64(cur)-int64(base))
+}
@@ -0,0 +1,991 @@
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pot.h"
+
+/*
+    Offline PoT auditor of pcap and pcapng captures, e.g. the output of
+    tcpdump -pni any "ip6[6]==43" -w capture.pcap.
+
+    Every SRv6 packet carrying the PoT TLV is an observation of a witness
+    somewhere along its path. Captured with segments left s, the witness
+    holds the hops of segments[last]..segments[s+1], or segments[s] as well
+    when the capture point is after the validator of the active SID (XDP
+    runs before the taps on ingress). Observations sharing a nonce are the
+    same packet seen at several points, the first failing one after the
+    last passing one tells which hop broke the chain.
+
+    The captures are mapped, never copied: a single pass indexes the
+    packets, a thread pool verifies them in batches of the same path and
+    segments left through pot_chain_batch, then the verdicts are grouped
+    per path and per flow.
+
+    Usage: seg6-pot-audit -a <algo> -k <keys> [-j threads] [-s] [-l flows] <capture>...
+           seg6-pot-audit -a <algo> -k <keys> [-s] -g <capture> [-n packets] [-f flows]
+                          [-p payload] [-r tampered-percent]
+
+    The key file holds one "<sid> <key>" per line, as printed by
+    seg6-pot-tlv --keys. The generator uses its SIDs in file order as the
+    path, with -s the first one is the head-end source address (ISADDR).
+*/
+
+#define POT_MAX_SEGMENTS 8 // SRH_MAX_ALLOWED_SEGMENTS of the datapath
+#define MAX_KEYS 256
+#define MAX_IFACES 64
+#define CHUNK 4096
+
+#define IPV6_HDR_LEN 40
+#define SRH_HDR_LEN 8
+#define NEXTHDR_HOP 0
+#define NEXTHDR_TCP 6
+#define NEXTHDR_UDP 17
+#define NEXTHDR_IPV6 41
+#define NEXTHDR_SRH 43
+#define NEXTHDR_DEST 60
+#define POT_MAX_EXT_HDRS 2 // Hop-by-Hop and Destination Options walked before the SRH, as the datapath does
+#define SRH_TYPE 4
+#define POT_TLV_TYPE 0xFC
+#define POT_TLV_HDR_LEN 4
+
+#define LINKTYPE_ETHERNET 1
+#define LINKTYPE_RAW 101
+#define LINKTYPE_LINUX_SLL 113
+#define LINKTYPE_IPV6 229
+#define LINKTYPE_LINUX_SLL2 276
+#define DLT_RAW 12
+
+#define PCAP_MAGIC 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define PCAPNG_SHB 0x0a0d0d0a
+#define PCAPNG_IDB 1
+#define PCAPNG_SPB 3
+#define PCAPNG_EPB 6
+#define PCAPNG_BYTE_ORDER 0x1a2b3c4d
+
+enum obs_verdict {
+    OBS_UNCHECKED = 0,
+    OBS_PASS,
+    OBS_FAIL,
+    OBS_NO_KEY,
+};
+
+struct key_entry {
+    uint8_t sid[16];
+    uint8_t key[POT_KEY_LEN];
+};
+
+/* One captured SRv6 packet with the PoT TLV, pointers into the mapping */
+struct obs {
+    const uint8_t *ip6;
+    const uint8_t *srh;
+    const uint8_t *tlv;
+    uint32_t len;
+    uint8_t n;       // segments in the SRH
+    uint8_t sl;      // segments left
+    uint8_t hops;    // path SIDs in the witness, an upper bound when it failed
+    uint8_t verdict;
+};
+
+struct obs_vec {
+    struct obs *v;
+    size_t len, cap;
+};
+
+struct capture_stats {
+    size_t packets;
+    size_t ipv6;
+    size_t malformed;
+};
+
+struct auditor {
+    enum pot_algo algo;
+    enum pot_simd simd;
+    size_t wlen;
+    int isaddr;
+
+    struct key_entry keys[MAX_KEYS];
+    size_t nkeys;
+
+    struct obs *obs;
+    size_t nobs;
+    atomic_size_t next;
+};
+
+static const uint8_t *srh_of(const struct obs *o)
+{
+    return o->srh;
+}
+
+static const uint8_t *segment(const struct obs *o, unsigned i)
+{
+    return srh_of(o) + SRH_HDR_LEN + 16 * i;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int parse_hex(const char *hex, uint8_t *out, size_t len)
+{
+    if (strlen(hex) != 2 * len)
+        return -1;
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1)
+            return -1;
+        out[i] = byte;
+    }
+    return 0;
+}
+
+static int cmp_key_entry(const void *a, const void *b)
+{
+    return memcmp(((const struct key_entry *)a)->sid, ((const struct key_entry *)b)->sid, 16);
+}
+
+static int load_keys(struct auditor *a, const char *path, struct key_entry *ordered)
+{
+    char line[512], sid[64], key[128];
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "%63s %127s", sid, key) != 2 || sid[0] == '#' || strcmp(sid, "SID") == 0)
+            continue;
+
+        if (a->nkeys == MAX_KEYS) {
+            fprintf(stderr, "[-] %s: more than %d keys\n", path, MAX_KEYS);
+            goto err;
+        }
+
+        struct key_entry *e = &a->keys[a->nkeys];
+        if (inet_pton(AF_INET6, sid, e->sid) != 1 || parse_hex(key, e->key, POT_KEY_LEN) < 0) {
+            fprintf(stderr, "[-] %s: invalid entry %s %s\n", path, sid, key);
+            goto err;
+        }
+        ordered[a->nkeys++] = *e;
+    }
+    fclose(f);
+
+    qsort(a->keys, a->nkeys, sizeof(a->keys[0]), cmp_key_entry);
+    return 0;
+err:
+    fclose(f);
+    return -1;
+}
+
+static const uint8_t *lookup_key(const struct auditor *a, const uint8_t *sid)
+{
+    struct key_entry *e = bsearch(sid, a->keys, a->nkeys, sizeof(a->keys[0]), cmp_key_entry);
+    return e ? e->key : NULL;
+}
+
+/*
+    Fills o when ip6 is an SRv6 packet with a PoT TLV of the algorithm, the
+    TLVs after the segment list are walked as the datapath does.
+*/
+static int parse_pot(const uint8_t *ip6, uint32_t len, size_t wlen, struct obs *o)
+{
+    if (len < IPV6_HDR_LEN + SRH_HDR_LEN || (ip6[0] >> 4) != 6)
+        return -1;
+
+    uint32_t off = IPV6_HDR_LEN;
+    uint8_t nexthdr = ip6[6];
+    for (int i = 0; i < POT_MAX_EXT_HDRS && (nexthdr == NEXTHDR_HOP || nexthdr == NEXTHDR_DEST); i++) {
+        if (off + 2 > len)
+            return -1;
+        nexthdr = ip6[off];
+        off += (ip6[off + 1] + 1u) * 8;
+    }
+    if (nexthdr != NEXTHDR_SRH || off + SRH_HDR_LEN > len)
+        return -1;
+
+    const uint8_t *srh = ip6 + off;
+    uint32_t srh_len = (srh[1] + 1) * 8;
+    unsigned n = srh[4] + 1u;
+
+    if (srh[2] != SRH_TYPE || n > POT_MAX_SEGMENTS || srh[3] >= n ||
+        off + srh_len > len || SRH_HDR_LEN + 16 * n > srh_len)
+        return -1;
+
+    const uint8_t *p = srh + SRH_HDR_LEN + 16 * n, *end = srh + srh_len;
+    while (p < end) {
+        if (p[0] == 0) { // Pad1
+            p++;
+            continue;
+        }
+        if (p + 2 > end || p + 2 + p[1] > end)
+            return -1;
+        if (p[0] == POT_TLV_TYPE && p[1] == POT_TLV_HDR_LEN - 2 + POT_NONCE_LEN + wlen)
+            break;
+        p += 2 + p[1];
+    }
+    if (p >= end)
+        return -1;
+
+    *o = (struct obs){.ip6 = ip6, .srh = srh, .tlv = p, .len = len, .n = n, .sl = srh[3]};
+    return 0;
+}
+
+static int obs_push(struct obs_vec *v, const struct obs *o)
+{
+    if (v->len == v->cap) {
+        size_t cap = v->cap ? 2 * v->cap : 1 << 16;
+        struct obs *n = realloc(v->v, cap * sizeof(*n));
+        if (!n)
+            return -1;
+        v->v = n;
+        v->cap = cap;
+    }
+    v->v[v->len++] = *o;
+    return 0;
+}
+
+/* IPv6 header of a captured frame, NULL when it isn't IPv6 */
+static const uint8_t *link_l3(uint32_t linktype, const uint8_t *pkt, uint32_t caplen, uint32_t *l3len)
+{
+    uint32_t off, proto;
+
+    switch (linktype) {
+    case LINKTYPE_ETHERNET:
+        off = 12;
+        if (caplen < off + 2)
+            return NULL;
+        proto = (uint32_t)pkt[off] << 8 | pkt[off + 1];
+        while ((proto == 0x8100 || proto == 0x88a8) && caplen >= off + 6) {
+            off += 4;
+            proto = (uint32_t)pkt[off] << 8 | pkt[off + 1];
+        }
+        off += 2;
+        break;
+    case LINKTYPE_LINUX_SLL:
+        if (caplen < 16)
+            return NULL;
+        proto = (uint32_t)pkt[14] << 8 | pkt[15];
+        off = 16;
+        break;
+    case LINKTYPE_LINUX_SLL2:
+        if (caplen < 20)
+            return NULL;
+        proto = (uint32_t)pkt[0] << 8 | pkt[1];
+        off = 20;
+        break;
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV6:
+    case DLT_RAW:
+        proto = 0x86dd;
+        off = 0;
+        break;
+    default:
+        return NULL;
+    }
+
+    if (proto != 0x86dd || caplen <= off)
+        return NULL;
+    *l3len = caplen - off;
+    return pkt + off;
+}
+
+static void index_frame(struct auditor *a, struct obs_vec *v, struct capture_stats *st, uint32_t linktype,
+                        const uint8_t *pkt, uint32_t caplen)
+{
+    uint32_t len;
+    struct obs o;
+
+    st->packets++;
+    const uint8_t *ip6 = link_l3(linktype, pkt, caplen, &len);
+    if (!ip6)
+        return;
+    st->ipv6++;
+
+    if (parse_pot(ip6, len, a->wlen, &o) < 0) {
+        if (len > 6 && ip6[6] == NEXTHDR_SRH)
+            st->malformed++;
+        return;
+    }
+    if (obs_push(v, &o) < 0) {
+        perror("realloc");
+        exit(2);
+    }
+}
+
+static uint32_t rd32(const uint8_t *p, int swap)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return swap ? __builtin_bswap32(v) : v;
+}
+
+static uint16_t rd16(const uint8_t *p, int swap)
+{
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return swap ? __builtin_bswap16(v) : v;
+}
+
+static int index_pcap(struct auditor *a, struct obs_vec *v, struct capture_stats *st, const uint8_t *base,
+                      size_t size)
+{
+    uint32_t magic = rd32(base, 0);
+    int swap = magic == __builtin_bswap32(PCAP_MAGIC) || magic == __builtin_bswap32(PCAP_MAGIC_NS);
+    uint32_t linktype = rd32(base + 20, swap) & 0xffff;
+    size_t off = 24;
+
+    while (off + 16 <= size) {
+        uint32_t caplen = rd32(base + off + 8, swap);
+        if (off + 16 + caplen > size)
+            return -1;
+        index_frame(a, v, st, linktype, base + off + 16, caplen);
+        off += 16 + caplen;
+    }
+    return 0;
+}
+
+static int index_pcapng(struct auditor *a, struct obs_vec *v, struct capture_stats *st, const uint8_t *base,
+                        size_t size)
+{
+    uint32_t linktypes[MAX_IFACES];
+    unsigned nifaces = 0;
+    size_t off = 0;
+    int swap = 0;
+
+    while (off + 12 <= size) {
+        uint32_t type = rd32(base + off, swap);
+
+        // The section header decides the byte order of everything after it
+        if (type == PCAPNG_SHB) {
+            swap = rd32(base + off + 8, 0) != PCAPNG_BYTE_ORDER;
+            nifaces = 0;
+        }
+
+        uint32_t blen = rd32(base + off + 4, swap);
+        if (blen < 12 || off + blen > size)
+            return -1;
+        const uint8_t *body = base + off + 8;
+
+        if (type == PCAPNG_IDB && nifaces < MAX_IFACES) {
+            linktypes[nifaces++] = rd16(body, swap);
+        } else if (type == PCAPNG_EPB && blen >= 32) {
+            uint32_t iface = rd32(body, swap), caplen = rd32(body + 12, swap);
+            if (iface < nifaces && caplen <= blen - 32)
+                index_frame(a, v, st, linktypes[iface], body + 20, caplen);
+        } else if (type == PCAPNG_SPB && blen >= 16 && nifaces > 0) {
+            uint32_t caplen = rd32(body, swap);
+            if (caplen > blen - 16)
+                caplen = blen - 16;
+            index_frame(a, v, st, linktypes[0], body + 4, caplen);
+        }
+        off += blen;
+    }
+    return 0;
+}
+
+static int index_capture(struct auditor *a, struct obs_vec *v, struct capture_stats *st, const uint8_t *base,
+                         size_t size)
+{
+    if (size < 24)
+        return -1;
+
+    uint32_t magic = rd32(base, 0);
+    if (magic == PCAPNG_SHB)
+        return index_pcapng(a, v, st, base, size);
+    if (magic == PCAP_MAGIC || magic == PCAP_MAGIC_NS || magic == __builtin_bswap32(PCAP_MAGIC) ||
+        magic == __builtin_bswap32(PCAP_MAGIC_NS))
+        return index_pcap(a, v, st, base, size);
+    return -1;
+}
+
+/* Observations verified together share the source (ISADDR), segments left and segment list */
+static int cmp_batch(const void *x, const void *y, void *arg)
+{
+    const struct obs *a = *(const struct obs *const *)x, *b = *(const struct obs *const *)y;
+    const struct auditor *au = arg;
+    int r;
+
+    if (au->isaddr && (r = memcmp(a->ip6 + 8, b->ip6 + 8, 16)) != 0)
+        return r;
+    if (a->sl != b->sl)
+        return a->sl - b->sl;
+    if (a->n != b->n)
+        return a->n - b->n;
+    return memcmp(segment(a, 0), segment(b, 0), 16 * a->n);
+}
+
+/*
+    Chains the keys of one batch over the nonces of every observation. The
+    ones that don't match may have been captured after the validator of the
+    active SID, they get its key as well before being failed.
+*/
+static void verify_batch(struct auditor *a, struct obs **batch, size_t m, uint8_t *msgs)
+{
+    uint8_t keys[POT_MAX_SEGMENTS + 1][POT_KEY_LEN];
+    const struct obs *o = batch[0];
+    size_t stride = pot_msg_len(a->algo), nkeys = 0;
+    const uint8_t *key, *active = lookup_key(a, segment(o, o->sl));
+    int verdict = OBS_UNCHECKED;
+
+    if (a->isaddr) {
+        if ((key = lookup_key(a, o->ip6 + 8)))
+            memcpy(keys[nkeys++], key, POT_KEY_LEN);
+        else
+            verdict = OBS_NO_KEY;
+    }
+    for (int i = o->n - 1; i > o->sl; i--) {
+        if ((key = lookup_key(a, segment(o, i))))
+            memcpy(keys[nkeys++], key, POT_KEY_LEN);
+        else
+            verdict = OBS_NO_KEY;
+    }
+
+    if (verdict == OBS_NO_KEY) {
+        for (size_t i = 0; i < m; i++)
+            batch[i]->verdict = OBS_NO_KEY;
+        return;
+    }
+
+    for (size_t i = 0; i < m; i++)
+        memcpy(msgs + i * stride, batch[i]->tlv + POT_TLV_HDR_LEN, POT_NONCE_LEN);
+    pot_chain_batch(a->algo, a->simd, (const uint8_t (*)[POT_KEY_LEN])keys, nkeys, msgs, stride, m);
+
+    unsigned hops = o->n - 1 - o->sl;
+    for (size_t i = 0; i < m; i++) {
+        uint8_t *msg = msgs + i * stride;
+        const uint8_t *witness = batch[i]->tlv + POT_TLV_HDR_LEN + POT_NONCE_LEN;
+
+        if (memcmp(msg + POT_NONCE_LEN, witness, a->wlen) == 0) {
+            batch[i]->verdict = OBS_PASS;
+            batch[i]->hops = hops;
+            continue;
+        }
+
+        batch[i]->verdict = OBS_FAIL;
+        batch[i]->hops = hops + 1;
+        if (active) {
+            pot_witness(a->algo, active, msg);
+            if (memcmp(msg + POT_NONCE_LEN, witness, a->wlen) == 0)
+                batch[i]->verdict = OBS_PASS;
+        }
+    }
+}
+
+static void *verify_worker(void *arg)
+{
+    struct auditor *a = arg;
+    struct obs **batch = malloc(CHUNK * sizeof(*batch));
+    uint8_t *msgs = malloc(CHUNK * pot_msg_len(a->algo));
+
+    if (!batch || !msgs) {
+        perror("malloc");
+        exit(2);
+    }
+
+    for (;;) {
+        size_t start = atomic_fetch_add(&a->next, CHUNK);
+        if (start >= a->nobs)
+            break;
+        size_t m = a->nobs - start < CHUNK ? a->nobs - start : CHUNK;
+
+        for (size_t i = 0; i < m; i++)
+            batch[i] = &a->obs[start + i];
+        qsort_r(batch, m, sizeof(*batch), cmp_batch, a);
+
+        for (size_t i = 0, j; i < m; i = j) {
+            for (j = i + 1; j < m && cmp_batch(&batch[i], &batch[j], a) == 0; j++)
+                ;
+            verify_batch(a, batch + i, j - i, msgs);
+        }
+    }
+
+    free(batch);
+    free(msgs);
+    return NULL;
+}
+
+/* Open addressing table of fixed-size entries, a non-zero first byte marks them used */
+struct table {
+    uint8_t *entries;
+    size_t cap, len, entry_size, key_off, key_size;
+};
+
+static uint64_t hash_bytes(const uint8_t *p, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ p[i]) * 0x100000001b3ull;
+    return h;
+}
+
+static uint8_t *table_slot(const struct table *t, uint8_t *entries, size_t cap, const void *key)
+{
+    for (size_t i = hash_bytes(key, t->key_size) & (cap - 1);; i = (i + 1) & (cap - 1)) {
+        uint8_t *e = entries + i * t->entry_size;
+        if (!e[0] || memcmp(e + t->key_off, key, t->key_size) == 0)
+            return e;
+    }
+}
+
+static void *table_get(struct table *t, const void *key)
+{
+    if (2 * (t->len + 1) > t->cap) {
+        size_t cap = t->cap ? 2 * t->cap : 1024;
+        uint8_t *entries = calloc(cap, t->entry_size);
+        if (!entries) {
+            perror("calloc");
+            exit(2);
+        }
+        for (size_t i = 0; i < t->cap; i++) {
+            uint8_t *e = t->entries + i * t->entry_size;
+            if (e[0])
+                memcpy(table_slot(t, entries, cap, e + t->key_off), e, t->entry_size);
+        }
+        free(t->entries);
+        t->entries = entries;
+        t->cap = cap;
+    }
+
+    uint8_t *e = table_slot(t, t->entries, t->cap, key);
+    if (!e[0]) {
+        e[0] = 1;
+        memcpy(e + t->key_off, key, t->key_size);
+        t->len++;
+    }
+    return e;
+}
+
+struct path_key {
+    uint8_t n;
+    uint8_t segments[POT_MAX_SEGMENTS][16]; // path order
+};
+
+struct path_stat {
+    uint8_t used;
+    struct path_key key;
+    size_t packets, pass, fail;
+    // culprit[p][h], failed between the last pass with p hops and the first fail with h
+    size_t culprit[POT_MAX_SEGMENTS + 1][POT_MAX_SEGMENTS + 1];
+};
+
+struct flow_key {
+    uint8_t outer_src[16];
+    uint8_t src[16], dst[16];
+    uint16_t sport, dport;
+    uint8_t proto;
+};
+
+struct flow_stat {
+    uint8_t used;
+    struct flow_key key;
+    size_t packets, pass, fail;
+};
+
+static int cmp_nonce(const void *x, const void *y)
+{
+    const struct obs *a = x, *b = y;
+    int r = memcmp(a->tlv + POT_TLV_HDR_LEN, b->tlv + POT_TLV_HDR_LEN, POT_NONCE_LEN);
+    return r ? r : a->hops - b->hops;
+}
+
+static void path_of(const struct obs *o, struct path_key *k)
+{
+    memset(k, 0, sizeof(*k));
+    k->n = o->n;
+    for (unsigned i = 0; i < o->n; i++)
+        memcpy(k->segments[i], segment(o, o->n - 1 - i), 16);
+}
+
+static void flow_of(const struct obs *o, struct flow_key *k)
+{
+    const uint8_t *srh = srh_of(o), *inner = srh + (srh[1] + 1) * 8;
+    const uint8_t *end = o->ip6 + o->len;
+
+    memset(k, 0, sizeof(*k));
+    memcpy(k->outer_src, o->ip6 + 8, 16);
+    k->proto = srh[0];
+
+    if (srh[0] != NEXTHDR_IPV6 || inner + IPV6_HDR_LEN > end)
+        return;
+
+    memcpy(k->src, inner + 8, 16);
+    memcpy(k->dst, inner + 24, 16);
+    k->proto = inner[6];
+    if ((k->proto == NEXTHDR_TCP || k->proto == NEXTHDR_UDP) && inner + IPV6_HDR_LEN + 4 <= end) {
+        k->sport = (uint16_t)(inner[40] << 8 | inner[41]);
+        k->dport = (uint16_t)(inner[42] << 8 | inner[43]);
+    }
+}
+
+static const char *ip6_str(const uint8_t *addr, char *buf)
+{
+    return inet_ntop(AF_INET6, addr, buf, INET6_ADDRSTRLEN);
+}
+
+static int cmp_flow_fail(const void *x, const void *y)
+{
+    const struct flow_stat *a = *(const struct flow_stat *const *)x, *b = *(const struct flow_stat *const *)y;
+    if (a->fail != b->fail)
+        return a->fail < b->fail ? 1 : -1;
+    return a->packets < b->packets ? 1 : a->packets > b->packets ? -1 : 0;
+}
+
+/* Packets are the observations of one nonce, they fail if any observation does */
+static size_t report(struct auditor *a, size_t max_flows)
+{
+    struct table paths = {.entry_size = sizeof(struct path_stat), .key_off = offsetof(struct path_stat, key),
+                          .key_size = sizeof(struct path_key)};
+    struct table flows = {.entry_size = sizeof(struct flow_stat), .key_off = offsetof(struct flow_stat, key),
+                          .key_size = sizeof(struct flow_key)};
+    size_t no_key = 0, total_fail = 0, total = 0;
+    char b1[INET6_ADDRSTRLEN], b2[INET6_ADDRSTRLEN], b3[INET6_ADDRSTRLEN];
+
+    qsort(a->obs, a->nobs, sizeof(*a->obs), cmp_nonce);
+
+    for (size_t i = 0, j; i < a->nobs; i = j) {
+        int first_fail = -1, last_pass = 0, checked = 0;
+
+        for (j = i; j < a->nobs && memcmp(a->obs[i].tlv + POT_TLV_HDR_LEN, a->obs[j].tlv + POT_TLV_HDR_LEN,
+                                          POT_NONCE_LEN) == 0; j++) {
+            const struct obs *o = &a->obs[j];
+            if (o->verdict == OBS_NO_KEY)
+                continue;
+            checked = 1;
+            if (o->verdict == OBS_FAIL && first_fail < 0)
+                first_fail = o->hops;
+            else if (o->verdict == OBS_PASS && first_fail < 0)
+                last_pass = o->hops;
+        }
+        if (!checked) {
+            no_key++;
+            continue;
+        }
+
+        struct path_key pk;
+        struct flow_key fk;
+        path_of(&a->obs[i], &pk);
+        flow_of(&a->obs[i], &fk);
+
+        struct path_stat *ps = table_get(&paths, &pk);
+        struct flow_stat *fs = table_get(&flows, &fk);
+        ps->packets++;
+        fs->packets++;
+        total++;
+
+        if (first_fail < 0) {
+            ps->pass++;
+            fs->pass++;
+            continue;
+        }
+        ps->fail++;
+        fs->fail++;
+        total_fail++;
+        if (first_fail > pk.n)
+            first_fail = pk.n;
+        if (last_pass >= first_fail)
+            last_pass = first_fail - 1;
+        ps->culprit[last_pass][first_fail]++;
+    }
+
+    printf("%-10s %10s %10s  %s\n", "PACKETS", "PASS", "FAIL", "PATH");
+    for (size_t i = 0; i < paths.cap; i++) {
+        struct path_stat *ps = (struct path_stat *)(paths.entries + i * paths.entry_size);
+        if (!ps->used)
+            continue;
+
+        printf("%-10zu %10zu %10zu  ", ps->packets, ps->pass, ps->fail);
+        for (unsigned s = 0; s < ps->key.n; s++)
+            printf("%s%s", s ? "," : "", ip6_str(ps->key.segments[s], b1));
+        printf("\n");
+
+        // The hop that broke the chain, a range when it wasn't captured in between
+        for (unsigned p = 0; p <= ps->key.n; p++) {
+            for (unsigned h = p + 1; h <= ps->key.n; h++) {
+                if (!ps->culprit[p][h])
+                    continue;
+                if (h == p + 1)
+                    printf("%-10s %10s %10zu    failed at hop %u %s\n", "", "", ps->culprit[p][h], h,
+                           ip6_str(ps->key.segments[h - 1], b1));
+                else
+                    printf("%-10s %10s %10zu    failed between hops %u %s and %u %s\n", "", "", ps->culprit[p][h],
+                           p + 1, ip6_str(ps->key.segments[p], b1), h, ip6_str(ps->key.segments[h - 1], b2));
+            }
+        }
+    }
+
+    struct flow_stat **sorted = malloc((flows.len + 1) * sizeof(*sorted));
+    size_t nflows = 0;
+    for (size_t i = 0; i < flows.cap; i++) {
+        struct flow_stat *fs = (struct flow_stat *)(flows.entries + i * flows.entry_size);
+        if (fs->used)
+            sorted[nflows++] = fs;
+    }
+    qsort(sorted, nflows, sizeof(*sorted), cmp_flow_fail);
+
+    printf("\n%-10s %10s %10s  %s\n", "PACKETS", "PASS", "FAIL", "FLOW");
+    for (size_t i = 0; i < nflows && (!max_flows || i < max_flows); i++) {
+        struct flow_key *k = &sorted[i]->key;
+        printf("%-10zu %10zu %10zu  %s.%u > %s.%u proto %u via %s\n", sorted[i]->packets, sorted[i]->pass,
+               sorted[i]->fail, ip6_str(k->src, b1), k->sport, ip6_str(k->dst, b2), k->dport, k->proto,
+               ip6_str(k->outer_src, b3));
+    }
+    if (max_flows && nflows > max_flows)
+        printf("... %zu more flows, -l 0 lists them all\n", nflows - max_flows);
+
+    printf("\n[+] %zu packets, %zu passed, %zu failed, %zu without keys\n", total, total - total_fail, total_fail,
+           no_key);
+
+    free(sorted);
+    free(paths.entries);
+    free(flows.entries);
+    return total_fail;
+}
+
+static int audit(struct auditor *a, char **files, int nfiles, int threads, size_t max_flows)
+{
+    struct obs_vec v = {0};
+    struct capture_stats st = {0};
+    size_t bytes = 0;
+    double start = now();
+
+    for (int i = 0; i < nfiles; i++) {
+        struct stat sb;
+        int fd = open(files[i], O_RDONLY);
+        if (fd < 0 || fstat(fd, &sb) < 0) {
+            perror(files[i]);
+            return 2;
+        }
+
+        // The observations point into the mappings, they stay until exit
+        const uint8_t *base = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            perror("mmap");
+            return 2;
+        }
+        madvise((void *)base, sb.st_size, MADV_SEQUENTIAL);
+
+        if (index_capture(a, &v, &st, base, sb.st_size) < 0) {
+            fprintf(stderr, "[-] %s: not a pcap or pcapng capture, or truncated\n", files[i]);
+            return 2;
+        }
+        bytes += sb.st_size;
+    }
+
+    a->obs = v.v;
+    a->nobs = v.len;
+    atomic_store(&a->next, 0);
+
+    pthread_t tids[threads];
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, verify_worker, a) != 0) {
+            perror("pthread_create");
+            return 2;
+        }
+    }
+    for (int i = 0; i < threads; i++)
+        pthread_join(tids[i], NULL);
+    double verified = now();
+
+    size_t failed = report(a, max_flows);
+    double elapsed = now() - start;
+
+    fprintf(stderr, "[+] %zu frames, %zu IPv6, %zu PoT observations, %zu malformed SRH\n", st.packets, st.ipv6,
+            a->nobs, st.malformed);
+    fprintf(stderr, "[+] %.1f MB in %.3f s (%.1f MB/s), verified by %d %s threads in %.3f s\n", bytes / 1e6, elapsed,
+            bytes / 1e6 / elapsed, threads, pot_simd_name(a->simd), verified - start);
+
+    free(v.v);
+    return failed ? 1 : 0;
+}
+
+/* xorshift64*, the synthetic capture only needs fast and distinct nonces */
+static uint64_t rnd(uint64_t *s)
+{
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 0x2545f4914f6cdd1dull;
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v >> 8;
+    p[1] = v & 0xff;
+}
+
+/*
+    Writes a pcap where every packet is captured as tcpdump on every node
+    would, leaving a node and entering the next one after its validator
+    updated the witness. Tampered packets get a witness bit flipped by a
+    random transit hop and fail from there on.
+*/
+static int generate(struct auditor *a, const struct key_entry *ordered, const char *path, size_t packets,
+                    unsigned nflows, unsigned payload, unsigned tampered)
+{
+    const struct key_entry *src = a->isaddr ? &ordered[0] : NULL;
+    const struct key_entry *sids = ordered + (a->isaddr ? 1 : 0);
+    unsigned n = a->nkeys - (a->isaddr ? 1 : 0);
+    uint8_t head[16] = {0x20, 0x01, 0x0d, 0xb8, 0x00, 0xff, 0x00, 0x01, [15] = 1};
+    uint64_t seed = (uint64_t)time(NULL) | 1;
+
+    if (n < 2 || n > POT_MAX_SEGMENTS) {
+        fprintf(stderr, "[-] the path needs 2 to %d SIDs with keys\n", POT_MAX_SEGMENTS);
+        return 2;
+    }
+
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return 2;
+    }
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+
+    uint32_t ghdr[6] = {PCAP_MAGIC, 2 | 4 << 16, 0, 0, 65535, LINKTYPE_ETHERNET};
+    fwrite(ghdr, sizeof(ghdr), 1, f);
+
+    size_t tlv_len = POT_TLV_HDR_LEN + POT_NONCE_LEN + a->wlen;
+    size_t srh_len = SRH_HDR_LEN + 16 * n + tlv_len;
+    size_t inner_len = IPV6_HDR_LEN + 8 + payload;
+    size_t frame_len = 14 + IPV6_HDR_LEN + srh_len + inner_len;
+    uint8_t *frame = calloc(1, frame_len);
+    uint8_t msg[POT_MAX_MSG_LEN];
+
+    uint8_t *eth = frame, *ip6 = eth + 14, *srh = ip6 + IPV6_HDR_LEN, *tlv = srh + SRH_HDR_LEN + 16 * n;
+    uint8_t *inner = srh + srh_len, *udp = inner + IPV6_HDR_LEN;
+
+    put16(eth + 12, 0x86dd);
+    ip6[0] = 0x60;
+    put16(ip6 + 4, (uint16_t)(srh_len + inner_len));
+    ip6[6] = NEXTHDR_SRH;
+    ip6[7] = 64;
+    memcpy(ip6 + 8, src ? src->sid : head, 16);
+
+    srh[0] = NEXTHDR_IPV6;
+    srh[1] = (uint8_t)(srh_len / 8 - 1);
+    srh[2] = SRH_TYPE;
+    srh[4] = (uint8_t)(n - 1);
+    for (unsigned i = 0; i < n; i++)
+        memcpy(srh + SRH_HDR_LEN + 16 * i, sids[n - 1 - i].sid, 16);
+    tlv[0] = POT_TLV_TYPE;
+    tlv[1] = (uint8_t)(tlv_len - 2);
+
+    inner[0] = 0x60;
+    put16(inner + 4, (uint16_t)(8 + payload));
+    inner[6] = NEXTHDR_UDP;
+    inner[7] = 64;
+    memcpy(inner + 8, (uint8_t[16]){0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01, [15] = 1}, 16);
+    memcpy(inner + 24, (uint8_t[16]){0x20, 0x01, 0x0d, 0xb8, 0x00, 0x05, [15] = 1}, 16);
+    put16(udp + 2, 5201);
+    put16(udp + 4, (uint16_t)(8 + payload));
+
+    for (size_t p = 0; p < packets; p++) {
+        unsigned broken = rnd(&seed) % 100 < tampered ? 1 + rnd(&seed) % (n - 1) : 0;
+
+        for (int i = 0; i < POT_NONCE_LEN; i += 4) {
+            uint32_t r = (uint32_t)rnd(&seed);
+            memcpy(msg + i, &r, 4);
+        }
+        memset(msg + POT_NONCE_LEN, 0, a->wlen);
+        if (src)
+            pot_witness(a->algo, src->key, msg);
+        put16(udp, (uint16_t)(1024 + p % nflows));
+
+        for (unsigned hops = 0;; hops++) {
+            unsigned sl = n - 1 - hops;
+            srh[3] = (uint8_t)sl;
+            memcpy(ip6 + 24, sids[hops].sid, 16);
+
+            // Leaving the previous node, then entering the active SID after its validator
+            for (int side = 0; side < 2; side++) {
+                uint32_t rec[4] = {(uint32_t)(p / 1000000), (uint32_t)(p % 1000000), (uint32_t)frame_len,
+                                   (uint32_t)frame_len};
+
+                memcpy(tlv + POT_TLV_HDR_LEN, msg, POT_NONCE_LEN + a->wlen);
+                fwrite(rec, sizeof(rec), 1, f);
+                fwrite(frame, frame_len, 1, f);
+
+                // The egress validates and strips the TLV before any tap
+                if (side || sl == 0)
+                    break;
+                pot_witness(a->algo, sids[hops].key, msg);
+                if (hops + 1 == broken)
+                    msg[POT_NONCE_LEN] ^= 1;
+            }
+            if (sl == 0)
+                break;
+        }
+    }
+
+    free(frame);
+    if (fclose(f) != 0) {
+        perror(path);
+        return 2;
+    }
+    fprintf(stderr, "[+] Wrote %zu packets on %u flows, %u hops each, to %s\n", packets, nflows, n, path);
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s -a <algo> -k <keys> [-j threads] [-s] [-l flows] <capture>...\n"
+            "       %s -a <algo> -k <keys> [-s] -g <capture> [-n packets] [-f flows] [-p payload] [-r percent]\n",
+            prog, prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static struct auditor a;
+    static struct key_entry ordered[MAX_KEYS];
+    const char *algo = NULL, *keys = NULL, *gen = NULL;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN), opt;
+    size_t max_flows = 20, packets = 1000000;
+    unsigned nflows = 64, payload = 1024, tampered = 1;
+
+    while ((opt = getopt(argc, argv, "a:k:j:sl:g:n:f:p:r:")) != -1) {
+        switch (opt) {
+        case 'a': algo = optarg; break;
+        case 'k': keys = optarg; break;
+        case 'j': threads = atoi(optarg); break;
+        case 's': a.isaddr = 1; break;
+        case 'l': max_flows = strtoul(optarg, NULL, 0); break;
+        case 'g': gen = optarg; break;
+        case 'n': packets = strtoul(optarg, NULL, 0); break;
+        case 'f': nflows = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'p': payload = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'r': tampered = (unsigned)strtoul(optarg, NULL, 0); break;
+        default: usage(argv[0]);
+        }
+    }
+
+    int id = algo ? pot_algo_parse(algo) : -1;
+    if (id < 0 || !keys || threads < 1 || !nflows || payload > 8192 || (!gen && optind == argc))
+        usage(argv[0]);
+
+    a.algo = id;
+    a.simd = pot_simd_best(a.algo);
+    a.wlen = pot_witness_len(a.algo);
+    if (load_keys(&a, keys, ordered) < 0)
+        return 2;
+
+    if (gen)
+        return generate(&a, ordered, gen, packets, nflows, payload, tampered);
+    return audit(&a, argv + optind, argc - optind, threads, max_flows);
+}
@@ -0,0 +1,139 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "internal.h"
+
+/* The datapath implementation itself, it only needs the kernel types */
+#include "crypto/blake3.h"
+
+#if POT_X86
+#include <immintrin.h>
+#endif
+
+#define BLAKE3_MSG_LEN (POT_NONCE_LEN + BLAKE3_DIGEST_LEN)
+#define BLAKE3_MSG_WORDS (BLAKE3_MSG_LEN / 4)
+#define BLAKE3_FLAGS (BLAKE3_CHUNK_START | BLAKE3_CHUNK_END | BLAKE3_ROOT | BLAKE3_KEYED_HASH)
+
+static void blake3_witness(const uint8_t *key, uint8_t *msg)
+{
+    // blake3_keyed_hash loads words, give it aligned copies
+    uint32_t k[8], m[16] = {0};
+    uint8_t out[BLAKE3_DIGEST_LEN];
+
+    memcpy(k, key, sizeof(k));
+    memcpy(m, msg, BLAKE3_MSG_LEN);
+    blake3_keyed_hash((const uint8_t *)m, BLAKE3_MSG_LEN, (const uint8_t *)k, out);
+    memcpy(msg + POT_NONCE_LEN, out, sizeof(out));
+}
+
+/* Same as the sigma table of blake3_keyed_hash */
+static const uint8_t blake3_sigma[7][16] = {
+    { 0, 1, 2, 3,   4, 5, 6, 7,   8, 9,10,11,  12,13,14,15 },
+    { 2, 6, 3,10,   7, 0, 4,13,   1,11,12, 5,   9,14,15, 8 },
+    { 3, 4,10,12,  13, 2, 7,14,   6,15, 9, 0,  11, 8, 5, 1 },
+    {10, 7,12, 9,  14, 3, 6, 5,  15,11, 8, 2,   4, 1, 0,13 },
+    {12, 6, 9,14,  11,10,15, 4,   3, 7, 0, 5,  13, 2, 8, 1 },
+    { 9,15,14,13,   6,12, 2,10,   7, 8, 1, 4,   5, 3,11, 0 },
+    {14,10, 8, 1,  15, 9, 3,13,   4, 0, 5, 6,   2,12,11, 7 }
+};
+
+#if POT_X86
+/*
+    The kernels keep one state word of every lane per register, so the
+    gfunction of one message is the same code on 8 or 16 messages at once.
+*/
+#define BLAKE3_G(V, ADD, XOR, ROR, a, b, c, d, x, y)  \
+    do {                                              \
+        V[a] = ADD(ADD(V[a], V[b]), x);               \
+        V[d] = ROR(XOR(V[d], V[a]), 16);              \
+        V[c] = ADD(V[c], V[d]);                       \
+        V[b] = ROR(XOR(V[b], V[c]), 12);              \
+        V[a] = ADD(ADD(V[a], V[b]), y);               \
+        V[d] = ROR(XOR(V[d], V[a]), 8);               \
+        V[c] = ADD(V[c], V[d]);                       \
+        V[b] = ROR(XOR(V[b], V[c]), 7);               \
+    } while (0)
+
+#define BLAKE3_ROUNDS(V, M, ADD, XOR, ROR)                                            \
+    for (int r = 0; r < 7; r++) {                                                     \
+        const uint8_t *s = blake3_sigma[r];                                           \
+        BLAKE3_G(V, ADD, XOR, ROR, 0, 4,  8, 12, M[s[ 0]], M[s[ 1]]);                 \
+        BLAKE3_G(V, ADD, XOR, ROR, 1, 5,  9, 13, M[s[ 2]], M[s[ 3]]);                 \
+        BLAKE3_G(V, ADD, XOR, ROR, 2, 6, 10, 14, M[s[ 4]], M[s[ 5]]);                 \
+        BLAKE3_G(V, ADD, XOR, ROR, 3, 7, 11, 15, M[s[ 6]], M[s[ 7]]);                 \
+        BLAKE3_G(V, ADD, XOR, ROR, 0, 5, 10, 15, M[s[ 8]], M[s[ 9]]);                 \
+        BLAKE3_G(V, ADD, XOR, ROR, 1, 6, 11, 12, M[s[10]], M[s[11]]);                 \
+        BLAKE3_G(V, ADD, XOR, ROR, 2, 7,  8, 13, M[s[12]], M[s[13]]);                 \
+        BLAKE3_G(V, ADD, XOR, ROR, 3, 4,  9, 14, M[s[14]], M[s[15]]);                 \
+    }
+
+#define AVX2_ROR32(x, r) _mm256_or_si256(_mm256_srli_epi32(x, r), _mm256_slli_epi32(x, 32 - (r)))
+
+POT_TARGET_AVX2 static void blake3_x8(const uint8_t *key, uint8_t *msgs, size_t stride)
+{
+    __m256i v[16], m[16];
+    uint32_t k[8];
+    uint32_t out[8][8];
+
+    memcpy(k, key, sizeof(k));
+    const __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                           _mm256_set1_epi32((int)stride));
+
+    for (int i = 0; i < 16; i++)
+        m[i] = i < BLAKE3_MSG_WORDS ? _mm256_i32gather_epi32((const int *)(msgs + 4 * i), idx, 1)
+                                    : _mm256_setzero_si256();
+
+    for (int i = 0; i < 8; i++) {
+        v[i] = _mm256_set1_epi32((int)k[i]);
+        v[i + 8] = _mm256_setzero_si256();
+    }
+    v[12] = _mm256_set1_epi32(BLAKE3_MSG_LEN);
+    v[14] = _mm256_set1_epi32(BLAKE3_FLAGS);
+
+    BLAKE3_ROUNDS(v, m, _mm256_add_epi32, _mm256_xor_si256, AVX2_ROR32);
+
+    for (int i = 0; i < 8; i++)
+        _mm256_storeu_si256((__m256i *)out[i], _mm256_xor_si256(v[i], v[i + 8]));
+
+    for (int lane = 0; lane < 8; lane++) {
+        uint8_t *witness = msgs + lane * stride + POT_NONCE_LEN;
+        for (int i = 0; i < 8; i++)
+            memcpy(witness + 4 * i, &out[i][lane], 4);
+    }
+}
+
+POT_TARGET_AVX512 static void blake3_x16(const uint8_t *key, uint8_t *msgs, size_t stride)
+{
+    __m512i v[16], m[16];
+    uint32_t k[8];
+
+    memcpy(k, key, sizeof(k));
+    const __m512i idx = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                                           _mm512_set1_epi32((int)stride));
+
+    for (int i = 0; i < 16; i++)
+        m[i] = i < BLAKE3_MSG_WORDS ? _mm512_i32gather_epi32(idx, msgs + 4 * i, 1) : _mm512_setzero_si512();
+
+    for (int i = 0; i < 8; i++) {
+        v[i] = _mm512_set1_epi32((int)k[i]);
+        v[i + 8] = _mm512_setzero_si512();
+    }
+    v[12] = _mm512_set1_epi32(BLAKE3_MSG_LEN);
+    v[14] = _mm512_set1_epi32(BLAKE3_FLAGS);
+
+    BLAKE3_ROUNDS(v, m, _mm512_add_epi32, _mm512_xor_si512, _mm512_ror_epi32);
+
+    for (int i = 0; i < 8; i++)
+        _mm512_i32scatter_epi32(msgs + POT_NONCE_LEN + 4 * i, idx, _mm512_xor_si512(v[i], v[i + 8]), 1);
+}
+#endif
+
+const struct pot_algo_ops pot_blake3_ops = {
+    .name = "blake3",
+    .witness_len = BLAKE3_DIGEST_LEN,
+    .witness = blake3_witness,
+#if POT_X86
+    .kernels = {[POT_SIMD_AVX2] = blake3_x8, [POT_SIMD_AVX512] = blake3_x16},
+    .lanes = {[POT_SIMD_SCALAR] = 1, [POT_SIMD_AVX2] = 8, [POT_SIMD_AVX512] = 16},
+#endif
+};
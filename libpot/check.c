@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pot.h"
+
+/*
+    Replays the vectors recorded from the datapath (seg6-pot-tlv
+    --test-vectors) against the library, every hop through the scalar and
+    every SIMD kernel the CPU has.
+
+    hop  <algo> <key> <nonce> <witness-in> <witness-out>
+    path <algo> <pass|drop> <nonce> <witness> <key>[,<key>...]
+
+    A path carries the witness the egress received and the keys in path
+    order, its verdict must be pass exactly when the library chain matches.
+
+    Usage: seg6-pot-check <vectors>
+*/
+
+#define MAX_PATH_KEYS 16
+#define MAX_LINE 4096
+
+static int parse_hex(const char *hex, uint8_t *out, size_t len)
+{
+    if (strlen(hex) != 2 * len)
+        return -1;
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1)
+            return -1;
+        out[i] = byte;
+    }
+    return 0;
+}
+
+static int check_hop(int algo, const char *key_hex, const char *nonce_hex, const char *in_hex, const char *out_hex)
+{
+    uint8_t key[POT_KEY_LEN], msg[POT_MAX_MSG_LEN], expected[POT_MAX_WITNESS_LEN];
+    size_t wlen = pot_witness_len(algo);
+    int ret = 0;
+
+    if (parse_hex(key_hex, key, sizeof(key)) < 0 || parse_hex(nonce_hex, msg, POT_NONCE_LEN) < 0 ||
+        parse_hex(in_hex, msg + POT_NONCE_LEN, wlen) < 0 || parse_hex(out_hex, expected, wlen) < 0)
+        return -1;
+
+    for (int simd = 0; simd < POT_SIMD_MAX; simd++) {
+        unsigned lanes = pot_simd_lanes(algo, simd);
+        if (!lanes)
+            continue;
+
+        // A full batch of copies so the kernel is used and not its scalar tail
+        size_t stride = pot_msg_len(algo);
+        uint8_t batch[16 * POT_MAX_MSG_LEN];
+        for (unsigned i = 0; i < lanes; i++)
+            memcpy(batch + i * stride, msg, stride);
+
+        pot_witness_batch(algo, simd, key, batch, stride, lanes);
+        for (unsigned i = 0; i < lanes; i++) {
+            if (memcmp(batch + i * stride + POT_NONCE_LEN, expected, wlen) != 0) {
+                fprintf(stderr, "[-] %s %s hop mismatch on lane %u\n", pot_algo_name(algo), pot_simd_name(simd), i);
+                ret = -1;
+                break;
+            }
+        }
+    }
+    return ret;
+}
+
+static int check_path(int algo, const char *verdict, const char *nonce_hex, const char *witness_hex, char *keys_hex)
+{
+    uint8_t keys[MAX_PATH_KEYS][POT_KEY_LEN], msg[POT_MAX_MSG_LEN];
+    size_t nkeys = 0, wlen = pot_witness_len(algo);
+    int pass;
+
+    if (strcmp(verdict, "pass") == 0)
+        pass = 1;
+    else if (strcmp(verdict, "drop") == 0)
+        pass = 0;
+    else
+        return -1;
+
+    if (parse_hex(nonce_hex, msg, POT_NONCE_LEN) < 0 || parse_hex(witness_hex, msg + POT_NONCE_LEN, wlen) < 0)
+        return -1;
+
+    for (char *tok = strtok(keys_hex, ","); tok; tok = strtok(NULL, ",")) {
+        if (nkeys == MAX_PATH_KEYS || parse_hex(tok, keys[nkeys++], POT_KEY_LEN) < 0)
+            return -1;
+    }
+    if (!nkeys)
+        return -1;
+
+    // The egress hashes the received witness with its own key before comparing
+    pot_witness(algo, keys[nkeys - 1], msg);
+
+    if ((pot_verify(algo, (const uint8_t (*)[POT_KEY_LEN])keys, nkeys, msg) == 0) != pass) {
+        fprintf(stderr, "[-] %s path verdict %s disagrees with the library\n", pot_algo_name(algo), verdict);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    char line[MAX_LINE];
+    int hops = 0, paths = 0, failed = 0, lineno = 0;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <vectors>\n", argv[0]);
+        return 2;
+    }
+
+    FILE *f = fopen(argv[1], "r");
+    if (!f) {
+        perror(argv[1]);
+        return 2;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        char kind[8], name[16], a[256], b[256], c[256], d[MAX_LINE];
+        int algo, ret;
+
+        lineno++;
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+
+        if (sscanf(line, "%7s %15s %255s %255s %255s %4095s", kind, name, a, b, c, d) != 6 ||
+            (algo = pot_algo_parse(name)) < 0) {
+            fprintf(stderr, "[-] %s:%d: malformed vector\n", argv[1], lineno);
+            failed++;
+            continue;
+        }
+
+        if (strcmp(kind, "hop") == 0) {
+            ret = check_hop(algo, a, b, c, d);
+            hops++;
+        } else if (strcmp(kind, "path") == 0) {
+            ret = check_path(algo, a, b, c, d);
+            paths++;
+        } else {
+            ret = -1;
+        }
+
+        if (ret < 0) {
+            fprintf(stderr, "[-] %s:%d: vector failed\n", argv[1], lineno);
+            failed++;
+        }
+    }
+    fclose(f);
+
+    printf("[+] %d hops, %d paths, %d failed\n", hops, paths, failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "internal.h"
+
+/* The datapath implementation itself, it only needs the kernel types */
+#include "crypto/halfsiphash.h"
+
+#if POT_X86
+#include <immintrin.h>
+#endif
+
+static void halfsiphash_witness(const uint8_t *key, uint8_t *msg)
+{
+    struct halfsiphash_key skey;
+    memcpy(&skey, key, sizeof(skey));
+
+    uint64_t hash = halfsiphash(&skey, msg);
+    memcpy(msg + POT_NONCE_LEN, &hash, HALFSIPHASH_TAG_LEN);
+}
+
+#if POT_X86
+/* One halfsiphash_round on a register of lanes */
+#define HALFSIPROUND(ADD, XOR, ROL, v0, v1, v2, v3)   \
+    do {                                              \
+        v0 = ADD(v0, v1);                             \
+        v1 = ROL(v1, 13);                             \
+        v1 = XOR(v1, v0);                             \
+        v0 = ROL(v0, 32);                             \
+        v2 = ADD(v2, v3);                             \
+        v3 = ROL(v3, 16);                             \
+        v3 = XOR(v3, v2);                             \
+        v0 = ADD(v0, v3);                             \
+        v3 = ROL(v3, 21);                             \
+        v3 = XOR(v3, v0);                             \
+        v2 = ADD(v2, v1);                             \
+        v1 = ROL(v1, 17);                             \
+        v1 = XOR(v1, v2);                             \
+        v2 = ROL(v2, 32);                             \
+    } while (0)
+
+#define HALFSIPHASH_LANES(ADD, XOR, ROL, SET1, k, m0, m1, out)                        \
+    do {                                                                              \
+        __typeof__(m0) v0 = SET1((long long)(HALFSIPH_CONST_0 ^ k[0]));               \
+        __typeof__(m0) v1 = SET1((long long)(HALFSIPH_CONST_1 ^ k[1]));               \
+        __typeof__(m0) v2 = SET1((long long)(HALFSIPH_CONST_2 ^ k[0]));               \
+        __typeof__(m0) v3 = SET1((long long)(HALFSIPH_CONST_3 ^ k[1]));               \
+        __typeof__(m0) ms[2] = {m0, m1};                                              \
+        for (int i = 0; i < 2; i++) {                                                 \
+            v3 = XOR(v3, ms[i]);                                                      \
+            for (int r = 0; r < HALFSIPHASH_CROUNDS; r++)                             \
+                HALFSIPROUND(ADD, XOR, ROL, v0, v1, v2, v3);                          \
+            v0 = XOR(v0, ms[i]);                                                      \
+        }                                                                             \
+        v2 = XOR(v2, SET1(0xff));                                                     \
+        for (int r = 0; r < HALFSIPHASH_FROUNDS; r++)                                 \
+            HALFSIPROUND(ADD, XOR, ROL, v0, v1, v2, v3);                              \
+        out = XOR(v1, v3);                                                            \
+    } while (0)
+
+#define AVX2_ROL64(x, r) _mm256_or_si256(_mm256_slli_epi64(x, r), _mm256_srli_epi64(x, 64 - (r)))
+
+POT_TARGET_AVX2 static void halfsiphash_x4(const uint8_t *key, uint8_t *msgs, size_t stride)
+{
+    uint64_t k[2], out[4];
+    __m256i hash;
+
+    memcpy(k, key, sizeof(k));
+    const __m128i idx = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32((int)stride));
+
+    __m256i m0 = _mm256_i32gather_epi64((const long long *)msgs, idx, 1);
+    __m256i m1 = _mm256_i32gather_epi64((const long long *)(msgs + 8), idx, 1);
+
+    HALFSIPHASH_LANES(_mm256_add_epi64, _mm256_xor_si256, AVX2_ROL64, _mm256_set1_epi64x, k, m0, m1, hash);
+
+    _mm256_storeu_si256((__m256i *)out, hash);
+    for (int lane = 0; lane < 4; lane++)
+        memcpy(msgs + lane * stride + POT_NONCE_LEN, &out[lane], HALFSIPHASH_TAG_LEN);
+}
+
+POT_TARGET_AVX512 static void halfsiphash_x8(const uint8_t *key, uint8_t *msgs, size_t stride)
+{
+    uint64_t k[2];
+    __m512i hash;
+
+    memcpy(k, key, sizeof(k));
+    const __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)stride));
+
+    __m512i m0 = _mm512_i32gather_epi64(idx, msgs, 1);
+    __m512i m1 = _mm512_i32gather_epi64(idx, msgs + 8, 1);
+
+    HALFSIPHASH_LANES(_mm512_add_epi64, _mm512_xor_si512, _mm512_rol_epi64, _mm512_set1_epi64, k, m0, m1, hash);
+
+    _mm512_i32scatter_epi64(msgs + POT_NONCE_LEN, idx, hash, 1);
+}
+#endif
+
+const struct pot_algo_ops pot_halfsiphash_ops = {
+    .name = "halfsiphash",
+    .witness_len = HALFSIPHASH_TAG_LEN,
+    .witness = halfsiphash_witness,
+#if POT_X86
+    .kernels = {[POT_SIMD_AVX2] = halfsiphash_x4, [POT_SIMD_AVX512] = halfsiphash_x8},
+    .lanes = {[POT_SIMD_SCALAR] = 1, [POT_SIMD_AVX2] = 4, [POT_SIMD_AVX512] = 8},
+#endif
+};
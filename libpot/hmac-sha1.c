@@ -0,0 +1,139 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "internal.h"
+
+/*
+    Port of crypto/hmac-sha1.h with the map scratch moved to the stack. The
+    compression keeps the 5 rounds of the datapath, so this is not SHA-1 and
+    must not be checked against a standard implementation.
+*/
+
+#define HMAC_SHA1_BLOCK_SIZE 64
+#define HMAC_SHA1_DIGEST_LEN 20
+#define HMAC_SHA1_WITNESS_LEN (HMAC_SHA1_DIGEST_LEN + 4)
+#define HMAC_SHA1_ROUNDS 5
+
+#define ROL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+struct sha1 {
+    uint32_t state[5];
+    uint64_t count;
+    uint8_t buf[HMAC_SHA1_BLOCK_SIZE];
+};
+
+static void sha1_init(struct sha1 *c)
+{
+    c->state[0] = 0x67452301ul;
+    c->state[1] = 0xEFCDAB89ul;
+    c->state[2] = 0x98BADCFEul;
+    c->state[3] = 0x10325476ul;
+    c->state[4] = 0xC3D2E1F0ul;
+    c->count = 0;
+}
+
+static void sha1_compress(struct sha1 *c, const uint8_t data[HMAC_SHA1_BLOCK_SIZE])
+{
+    uint32_t w[16];
+    uint32_t A, B, C, D, E, T;
+
+    for (int i = 0; i < 16; i++)
+        w[i] = ((uint32_t)data[4 * i] << 24) | ((uint32_t)data[4 * i + 1] << 16) |
+               ((uint32_t)data[4 * i + 2] << 8) | ((uint32_t)data[4 * i + 3]);
+
+    A = c->state[0];
+    B = c->state[1];
+    C = c->state[2];
+    D = c->state[3];
+    E = c->state[4];
+
+    // Every reduced round is in the first quarter of the real schedule
+    for (int i = 0; i < HMAC_SHA1_ROUNDS; i++) {
+        T = ROL32(A, 5) + ((B & C) | ((~B) & D)) + E + 0x5A827999ul + w[i];
+        E = D;
+        D = C;
+        C = ROL32(B, 30);
+        B = A;
+        A = T;
+    }
+
+    c->state[0] += A;
+    c->state[1] += B;
+    c->state[2] += C;
+    c->state[3] += D;
+    c->state[4] += E;
+}
+
+static void sha1_update(struct sha1 *c, const uint8_t *data, uint32_t len)
+{
+    uint32_t idx = c->count & 63;
+    uint32_t part = HMAC_SHA1_BLOCK_SIZE - idx;
+    c->count += len;
+
+    if (len >= part) {
+        memcpy(c->buf + idx, data, part);
+        sha1_compress(c, c->buf);
+        data += part;
+        len -= part;
+
+        for (; len >= HMAC_SHA1_BLOCK_SIZE; len -= HMAC_SHA1_BLOCK_SIZE, data += HMAC_SHA1_BLOCK_SIZE)
+            sha1_compress(c, data);
+        idx = 0;
+    }
+
+    memcpy(c->buf + idx, data, len);
+}
+
+static void sha1_final(struct sha1 *c, uint8_t digest[HMAC_SHA1_DIGEST_LEN])
+{
+    uint8_t pad[HMAC_SHA1_BLOCK_SIZE] = {0x80};
+    uint64_t bitlen = c->count << 3;
+    uint32_t idx = c->count & 63;
+    uint32_t padlen = (idx < 56) ? (56 - idx) : (120 - idx);
+
+    sha1_update(c, pad, padlen);
+
+    for (int i = 0; i < 8; i++)
+        c->buf[56 + i] = (bitlen >> (56 - 8 * i)) & 0xFF;
+    sha1_compress(c, c->buf);
+
+    for (int i = 0; i < 5; i++) {
+        uint32_t t = c->state[i];
+        digest[4 * i] = (t >> 24) & 0xFF;
+        digest[4 * i + 1] = (t >> 16) & 0xFF;
+        digest[4 * i + 2] = (t >> 8) & 0xFF;
+        digest[4 * i + 3] = t & 0xFF;
+    }
+}
+
+static void hmac_sha1_witness(const uint8_t *key, uint8_t *msg)
+{
+    uint8_t ipad[HMAC_SHA1_BLOCK_SIZE] = {0}, opad[HMAC_SHA1_BLOCK_SIZE] = {0};
+    uint8_t tmp[HMAC_SHA1_DIGEST_LEN];
+    struct sha1 ctx;
+
+    memcpy(ipad, key, POT_KEY_LEN);
+    memcpy(opad, key, POT_KEY_LEN);
+    for (int i = 0; i < HMAC_SHA1_BLOCK_SIZE; i++) {
+        ipad[i] ^= 0x36;
+        opad[i] ^= 0x5c;
+    }
+
+    sha1_init(&ctx);
+    sha1_update(&ctx, ipad, HMAC_SHA1_BLOCK_SIZE);
+    sha1_update(&ctx, msg, POT_NONCE_LEN + HMAC_SHA1_WITNESS_LEN);
+    sha1_final(&ctx, tmp);
+
+    // Only the digest is written, the last 4 bytes of the witness carry over
+    sha1_init(&ctx);
+    sha1_update(&ctx, opad, HMAC_SHA1_BLOCK_SIZE);
+    sha1_update(&ctx, tmp, HMAC_SHA1_DIGEST_LEN);
+    sha1_final(&ctx, msg + POT_NONCE_LEN);
+}
+
+const struct pot_algo_ops pot_hmac_sha1_ops = {
+    .name = "hmac-sha1",
+    .witness_len = HMAC_SHA1_WITNESS_LEN,
+    .witness = hmac_sha1_witness,
+    .lanes = {[POT_SIMD_SCALAR] = 1},
+};
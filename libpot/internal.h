@@ -0,0 +1,32 @@
+#ifndef __LIBPOT_INTERNAL_H
+#define __LIBPOT_INTERNAL_H
+
+#include "pot.h"
+
+/* Multi-buffer kernel, hashes exactly lanes messages */
+typedef void (*pot_kernel_fn)(const uint8_t *key, uint8_t *msgs, size_t stride);
+
+struct pot_algo_ops {
+    const char *name;
+    size_t witness_len;
+    void (*witness)(const uint8_t *key, uint8_t *msg);
+    pot_kernel_fn kernels[POT_SIMD_MAX];
+    unsigned lanes[POT_SIMD_MAX];
+};
+
+extern const struct pot_algo_ops pot_blake3_ops;
+extern const struct pot_algo_ops pot_siphash_ops;
+extern const struct pot_algo_ops pot_halfsiphash_ops;
+extern const struct pot_algo_ops pot_poly1305_ops;
+extern const struct pot_algo_ops pot_hmac_sha1_ops;
+extern const struct pot_algo_ops pot_hmac_sha256_ops;
+
+#if defined(__x86_64__)
+#define POT_X86 1
+#define POT_TARGET_AVX2 __attribute__((target("avx2")))
+#define POT_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define POT_X86 0
+#endif
+
+#endif /* __LIBPOT_INTERNAL_H */
@@ -0,0 +1,136 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "internal.h"
+
+/*
+    Port of crypto/poly1305.h, the datapath keeps its scratch in a percpu
+    map so the header cannot be built here. The arithmetic is kept word for
+    word, including its reduction, so both sides produce the same tags.
+*/
+
+#define POLY1305_TAG_LEN 16
+#define POLY1305_MSG_LEN (POT_NONCE_LEN + POLY1305_TAG_LEN)
+
+static const uint32_t poly1305_p[5] = {0xFFFFFFFB, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000003};
+
+static inline uint32_t load32_le(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void add_130(uint32_t acc[5], const uint32_t b[5])
+{
+    uint64_t sum = 0;
+
+    for (int i = 0; i < 5; i++) {
+        sum = (uint64_t)acc[i] + b[i] + (sum >> 32);
+        acc[i] = sum & 0xFFFFFFFF;
+    }
+}
+
+static inline void mul_mod_p(uint32_t acc[5], const uint32_t r[5])
+{
+    uint64_t t[10] = {0};
+    uint64_t carry;
+
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 5; j++) {
+            uint64_t prod = (uint64_t)acc[i] * r[j];
+            t[i + j] += prod & 0xFFFFFFFF;
+            t[i + j + 1] += prod >> 32;
+        }
+    }
+
+    for (int i = 0; i < 9; i++) {
+        t[i + 1] += t[i] >> 32;
+        t[i] &= 0xFFFFFFFF;
+    }
+    t[9] &= 0xFFFFFFFF;
+
+    for (int i = 0; i < 5; i++)
+        acc[i] = (uint32_t)t[i];
+    for (int i = 5; i < 10; i++) {
+        uint64_t v = t[i] * 5;
+        acc[i - 5] += (uint32_t)(v & 0xFFFFFFFF);
+        if (i - 5 + 1 < 5)
+            acc[i - 5 + 1] += (uint32_t)(v >> 32);
+    }
+
+    carry = 0;
+    for (int i = 0; i < 5; i++) {
+        uint64_t sum = (uint64_t)acc[i] + carry;
+        acc[i] = (uint32_t)sum;
+        carry = sum >> 32;
+    }
+}
+
+static inline void reduce_final(uint32_t acc[5])
+{
+    const uint32_t *p = poly1305_p;
+
+    if (acc[4] < p[4] ||
+        (acc[4] == p[4] && acc[3] < p[3]) ||
+        (acc[4] == p[4] && acc[3] == p[3] && acc[2] < p[2]) ||
+        (acc[4] == p[4] && acc[3] == p[3] && acc[2] == p[2] && acc[1] < p[1]) ||
+        (acc[4] == p[4] && acc[3] == p[3] && acc[2] == p[2] && acc[1] == p[1] && acc[0] < p[0]))
+        return;
+
+    uint64_t borrow = 0;
+    for (int i = 0; i < 5; i++) {
+        uint64_t diff = (uint64_t)acc[i] - p[i] - borrow;
+        acc[i] = diff & 0xFFFFFFFF;
+        borrow = diff >> 63;
+    }
+}
+
+static void poly1305_witness(const uint8_t *key, uint8_t *msg)
+{
+    uint32_t acc[5] = {0}, r[5] = {0}, s[4];
+    uint64_t carry = 0;
+
+    for (int i = 0; i < 4; i++) {
+        r[i] = load32_le(key + 4 * i);
+        s[i] = load32_le(key + 16 + 4 * i);
+    }
+    r[0] &= 0x0FFFFFFF;
+    r[1] &= 0x0FFFFFFC;
+    r[2] &= 0x0FFFFFFC;
+    r[3] &= 0x0FFFFFFC;
+
+    for (uint32_t off = 0; off < POLY1305_MSG_LEN; off += 16) {
+        uint32_t block[5] = {0};
+        uint32_t block_len = POLY1305_MSG_LEN - off < 16 ? POLY1305_MSG_LEN - off : 16;
+        uint8_t *p = (uint8_t *)block;
+
+        memcpy(p, msg + off, block_len);
+        if (block_len < 16)
+            p[block_len] = 1;
+        block[4] = (block_len == 16);
+
+        add_130(acc, block);
+        mul_mod_p(acc, r);
+    }
+
+    reduce_final(acc);
+
+    for (int i = 0; i < 4; i++) {
+        carry = (uint64_t)acc[i] + s[i] + (carry >> 32);
+        acc[i] = carry & 0xFFFFFFFF;
+    }
+
+    uint8_t *tag = msg + POT_NONCE_LEN;
+    for (int i = 0; i < 4; i++) {
+        tag[i * 4 + 0] = acc[i] & 0xFF;
+        tag[i * 4 + 1] = (acc[i] >> 8) & 0xFF;
+        tag[i * 4 + 2] = (acc[i] >> 16) & 0xFF;
+        tag[i * 4 + 3] = (acc[i] >> 24) & 0xFF;
+    }
+}
+
+const struct pot_algo_ops pot_poly1305_ops = {
+    .name = "poly1305",
+    .witness_len = POLY1305_TAG_LEN,
+    .witness = poly1305_witness,
+    .lanes = {[POT_SIMD_SCALAR] = 1},
+};
@@ -0,0 +1,142 @@
+#include <string.h>
+
+#include "internal.h"
+
+static const struct pot_algo_ops *const pot_algos[POT_ALGO_MAX] = {
+    [POT_ALGO_BLAKE3] = &pot_blake3_ops,
+    [POT_ALGO_SIPHASH] = &pot_siphash_ops,
+    [POT_ALGO_HALFSIPHASH] = &pot_halfsiphash_ops,
+    [POT_ALGO_POLY1305] = &pot_poly1305_ops,
+    [POT_ALGO_HMAC_SHA1] = &pot_hmac_sha1_ops,
+    [POT_ALGO_HMAC_SHA256] = &pot_hmac_sha256_ops,
+};
+
+static const char *const pot_simd_names[POT_SIMD_MAX] = {
+    [POT_SIMD_SCALAR] = "scalar",
+    [POT_SIMD_AVX2] = "avx2",
+    [POT_SIMD_AVX512] = "avx512",
+};
+
+int pot_algo_parse(const char *name)
+{
+    for (int i = 0; i < POT_ALGO_MAX; i++) {
+        if (strcmp(pot_algos[i]->name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+const char *pot_algo_name(enum pot_algo algo)
+{
+    return pot_algos[algo]->name;
+}
+
+size_t pot_witness_len(enum pot_algo algo)
+{
+    return pot_algos[algo]->witness_len;
+}
+
+size_t pot_msg_len(enum pot_algo algo)
+{
+    return POT_NONCE_LEN + pot_algos[algo]->witness_len;
+}
+
+const char *pot_simd_name(enum pot_simd simd)
+{
+    return pot_simd_names[simd];
+}
+
+static int pot_cpu_has(enum pot_simd simd)
+{
+#if POT_X86
+    switch (simd) {
+    case POT_SIMD_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case POT_SIMD_AVX512:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        return 1;
+    }
+#else
+    return simd == POT_SIMD_SCALAR;
+#endif
+}
+
+unsigned pot_simd_lanes(enum pot_algo algo, enum pot_simd simd)
+{
+    if (simd == POT_SIMD_SCALAR)
+        return 1;
+    if (!pot_algos[algo]->kernels[simd] || !pot_cpu_has(simd))
+        return 0;
+    return pot_algos[algo]->lanes[simd];
+}
+
+enum pot_simd pot_simd_best(enum pot_algo algo)
+{
+    for (int simd = POT_SIMD_MAX - 1; simd > POT_SIMD_SCALAR; simd--) {
+        if (pot_simd_lanes(algo, (enum pot_simd)simd))
+            return (enum pot_simd)simd;
+    }
+    return POT_SIMD_SCALAR;
+}
+
+void pot_witness(enum pot_algo algo, const uint8_t key[POT_KEY_LEN], uint8_t *msg)
+{
+    pot_algos[algo]->witness(key, msg);
+}
+
+int pot_witness_batch(enum pot_algo algo, enum pot_simd simd, const uint8_t key[POT_KEY_LEN],
+                      uint8_t *msgs, size_t stride, size_t n)
+{
+    const struct pot_algo_ops *ops = pot_algos[algo];
+    unsigned lanes = pot_simd_lanes(algo, simd);
+    size_t i = 0;
+
+    if (!lanes)
+        return -1;
+
+    // The kernels gather with 32-bit offsets
+    if (lanes > 1 && stride * lanes <= INT32_MAX) {
+        for (; i + lanes <= n; i += lanes)
+            ops->kernels[simd](key, msgs + i * stride, stride);
+    }
+
+    for (; i < n; i++)
+        ops->witness(key, msgs + i * stride);
+    return 0;
+}
+
+void pot_chain(enum pot_algo algo, const uint8_t (*keys)[POT_KEY_LEN], size_t nkeys, uint8_t *msg)
+{
+    memset(msg + POT_NONCE_LEN, 0, pot_witness_len(algo));
+    for (size_t k = 0; k < nkeys; k++)
+        pot_witness(algo, keys[k], msg);
+}
+
+int pot_chain_batch(enum pot_algo algo, enum pot_simd simd, const uint8_t (*keys)[POT_KEY_LEN], size_t nkeys,
+                    uint8_t *msgs, size_t stride, size_t n)
+{
+    if (!pot_simd_lanes(algo, simd))
+        return -1;
+
+    for (size_t i = 0; i < n; i++)
+        memset(msgs + i * stride + POT_NONCE_LEN, 0, pot_witness_len(algo));
+
+    for (size_t k = 0; k < nkeys; k++) {
+        if (pot_witness_batch(algo, simd, keys[k], msgs, stride, n) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+int pot_verify(enum pot_algo algo, const uint8_t (*keys)[POT_KEY_LEN], size_t nkeys, const uint8_t *msg)
+{
+    uint8_t expected[POT_MAX_MSG_LEN];
+
+    memcpy(expected, msg, POT_NONCE_LEN);
+    pot_chain(algo, keys, nkeys, expected);
+
+    if (memcmp(expected + POT_NONCE_LEN, msg + POT_NONCE_LEN, pot_witness_len(algo)) != 0)
+        return -1;
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef __LIBPOT_H
+#define __LIBPOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    Userspace reference of the PoT witness computed by the datapath, bit for
+    bit the same as compute_tlv of bpf/tlv.h for every algorithm build.
+
+    A message is what the datapath hashes, the nonce followed by the witness,
+    i.e. the TLV after its reserved field. Every hop replaces the witness by
+    the keyed-hash of the whole message with the key of its SID.
+*/
+
+#define POT_KEY_LEN 32
+#define POT_NONCE_LEN 12
+#define POT_MAX_WITNESS_LEN 32
+#define POT_MAX_MSG_LEN (POT_NONCE_LEN + POT_MAX_WITNESS_LEN)
+
+enum pot_algo {
+    POT_ALGO_BLAKE3 = 0,
+    POT_ALGO_SIPHASH,
+    POT_ALGO_HALFSIPHASH,
+    POT_ALGO_POLY1305,
+    POT_ALGO_HMAC_SHA1,
+    POT_ALGO_HMAC_SHA256,
+    POT_ALGO_MAX,
+};
+
+/* Kernels of pot_witness_batch, the multi-buffer ones hash one message per lane */
+enum pot_simd {
+    POT_SIMD_SCALAR = 0,
+    POT_SIMD_AVX2,
+    POT_SIMD_AVX512,
+    POT_SIMD_MAX,
+};
+
+/* Algorithm of a build name (blake3, hmac-sha1...), -1 when unknown */
+int pot_algo_parse(const char *name);
+const char *pot_algo_name(enum pot_algo algo);
+
+/* DIGEST_LEN of the algorithm build, the TLV wire length is 4 + nonce + witness */
+size_t pot_witness_len(enum pot_algo algo);
+size_t pot_msg_len(enum pot_algo algo);
+
+const char *pot_simd_name(enum pot_simd simd);
+
+/* Messages hashed at once by a kernel, 0 when it doesn't exist or the CPU lacks it */
+unsigned pot_simd_lanes(enum pot_algo algo, enum pot_simd simd);
+
+/* Widest kernel the CPU runs for the algorithm */
+enum pot_simd pot_simd_best(enum pot_algo algo);
+
+/* One hop, replaces the witness of msg as the node owning key does */
+void pot_witness(enum pot_algo algo, const uint8_t key[POT_KEY_LEN], uint8_t *msg);
+
+/*
+    One hop over n messages spread stride bytes apart, all with the same key
+    as for many packets crossing the same SID. Returns -1 when the kernel is
+    unavailable, the messages that don't fill the lanes are hashed by the
+    scalar one.
+*/
+int pot_witness_batch(enum pot_algo algo, enum pot_simd simd, const uint8_t key[POT_KEY_LEN],
+                      uint8_t *msgs, size_t stride, size_t n);
+
+/*
+    Witness expected at the egress, as chain_pot_tlv computes it: the witness
+    is zeroed and every key is applied in path order, the first SID visited
+    first, which is the reverse of the SRH segment list.
+*/
+void pot_chain(enum pot_algo algo, const uint8_t (*keys)[POT_KEY_LEN], size_t nkeys, uint8_t *msg);
+int pot_chain_batch(enum pot_algo algo, enum pot_simd simd, const uint8_t (*keys)[POT_KEY_LEN], size_t nkeys,
+                    uint8_t *msgs, size_t stride, size_t n);
+
+/* 0 when the witness of msg is the one of pot_chain, -1 otherwise */
+int pot_verify(enum pot_algo algo, const uint8_t (*keys)[POT_KEY_LEN], size_t nkeys, const uint8_t *msg);
+
+#endif /* __LIBPOT_H */
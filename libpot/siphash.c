@@ -0,0 +1,111 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "internal.h"
+
+/* The datapath implementation itself, it only needs the kernel types */
+#include "crypto/siphash.h"
+
+#if POT_X86
+#include <immintrin.h>
+#endif
+
+static void siphash_witness(const uint8_t *key, uint8_t *msg)
+{
+    struct siphash_key skey;
+    memcpy(&skey, key, sizeof(skey));
+
+    uint64_t hash = siphash(&skey, msg);
+    memcpy(msg + POT_NONCE_LEN, &hash, SIPHASH_WORD_LEN);
+}
+
+#if POT_X86
+/* One siphash_round on a register of lanes */
+#define SIPROUND(ADD, XOR, ROL, v0, v1, v2, v3)   \
+    do {                                          \
+        v0 = ADD(v0, v1);                         \
+        v1 = ROL(v1, 13);                         \
+        v1 = XOR(v1, v0);                         \
+        v0 = ROL(v0, 32);                         \
+        v2 = ADD(v2, v3);                         \
+        v3 = ROL(v3, 16);                         \
+        v3 = XOR(v3, v2);                         \
+        v2 = ADD(v2, v1);                         \
+        v1 = ROL(v1, 17);                         \
+        v1 = XOR(v1, v2);                         \
+        v2 = ROL(v2, 32);                         \
+        v0 = ADD(v0, v3);                         \
+        v3 = ROL(v3, 21);                         \
+        v3 = XOR(v3, v0);                         \
+    } while (0)
+
+#define SIPHASH_LANES(ADD, XOR, ROL, SET1, k, m0, m1, m2, out)                        \
+    do {                                                                              \
+        __typeof__(m0) v0 = SET1((long long)(SIPHASH_CONST_0 ^ k[0]));                \
+        __typeof__(m0) v1 = SET1((long long)(SIPHASH_CONST_1 ^ k[1]));                \
+        __typeof__(m0) v2 = SET1((long long)(SIPHASH_CONST_2 ^ k[2]));                \
+        __typeof__(m0) v3 = SET1((long long)(SIPHASH_CONST_3 ^ k[3]));                \
+        __typeof__(m0) ms[3] = {m0, m1, m2};                                          \
+        for (int i = 0; i < 3; i++) {                                                 \
+            v3 = XOR(v3, ms[i]);                                                      \
+            for (int r = 0; r < SIPHASH_CROUNDS; r++)                                 \
+                SIPROUND(ADD, XOR, ROL, v0, v1, v2, v3);                              \
+            v0 = XOR(v0, ms[i]);                                                      \
+        }                                                                             \
+        v2 = XOR(v2, SET1(0xff));                                                     \
+        for (int r = 0; r < SIPHASH_FROUNDS; r++)                                     \
+            SIPROUND(ADD, XOR, ROL, v0, v1, v2, v3);                                  \
+        out = XOR(XOR(v0, v1), XOR(v2, v3));                                          \
+    } while (0)
+
+#define AVX2_ROL64(x, r) _mm256_or_si256(_mm256_slli_epi64(x, r), _mm256_srli_epi64(x, 64 - (r)))
+
+POT_TARGET_AVX2 static void siphash_x4(const uint8_t *key, uint8_t *msgs, size_t stride)
+{
+    uint64_t k[4], out[4];
+    __m256i hash;
+
+    memcpy(k, key, sizeof(k));
+    const __m128i idx = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32((int)stride));
+
+    __m256i m0 = _mm256_i32gather_epi64((const long long *)msgs, idx, 1);
+    __m256i m1 = _mm256_i32gather_epi64((const long long *)(msgs + 8), idx, 1);
+    // The last 4 bytes and the length, never read past the 20 bytes message
+    __m256i m2 = _mm256_cvtepu32_epi64(_mm_i32gather_epi32((const int *)(msgs + 16), idx, 1));
+    m2 = _mm256_or_si256(m2, _mm256_set1_epi64x((long long)((uint64_t)SIPHASH_INJEST_LEN << 56)));
+
+    SIPHASH_LANES(_mm256_add_epi64, _mm256_xor_si256, AVX2_ROL64, _mm256_set1_epi64x, k, m0, m1, m2, hash);
+
+    _mm256_storeu_si256((__m256i *)out, hash);
+    for (int lane = 0; lane < 4; lane++)
+        memcpy(msgs + lane * stride + POT_NONCE_LEN, &out[lane], SIPHASH_WORD_LEN);
+}
+
+POT_TARGET_AVX512 static void siphash_x8(const uint8_t *key, uint8_t *msgs, size_t stride)
+{
+    uint64_t k[4];
+    __m512i hash;
+
+    memcpy(k, key, sizeof(k));
+    const __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)stride));
+
+    __m512i m0 = _mm512_i32gather_epi64(idx, msgs, 1);
+    __m512i m1 = _mm512_i32gather_epi64(idx, msgs + 8, 1);
+    __m512i m2 = _mm512_cvtepu32_epi64(_mm256_i32gather_epi32((const int *)(msgs + 16), idx, 1));
+    m2 = _mm512_or_si512(m2, _mm512_set1_epi64((long long)((uint64_t)SIPHASH_INJEST_LEN << 56)));
+
+    SIPHASH_LANES(_mm512_add_epi64, _mm512_xor_si512, _mm512_rol_epi64, _mm512_set1_epi64, k, m0, m1, m2, hash);
+
+    _mm512_i32scatter_epi64(msgs + POT_NONCE_LEN, idx, hash, 1);
+}
+#endif
+
+const struct pot_algo_ops pot_siphash_ops = {
+    .name = "siphash",
+    .witness_len = SIPHASH_WORD_LEN,
+    .witness = siphash_witness,
+#if POT_X86
+    .kernels = {[POT_SIMD_AVX2] = siphash_x4, [POT_SIMD_AVX512] = siphash_x8},
+    .lanes = {[POT_SIMD_SCALAR] = 1, [POT_SIMD_AVX2] = 4, [POT_SIMD_AVX512] = 8},
+#endif
+};
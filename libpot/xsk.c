@@ -0,0 +1,880 @@
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_tun.h>
+#include <linux/if_xdp.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include "pot.h"
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+/*
+    AF_XDP validation engine of the egress node, for objects built with
+    AFXDP=1. Their XDP entry redirects the SRv6 packets whose last SID is
+    active into the AF_XDP socket bound to the receive queue, when there is
+    one, instead of chaining the keys in the datapath. Queues without a
+    socket keep the in-kernel validation, so the engine can be started and
+    stopped under traffic.
+
+    One thread per queue batches the received packets by path and verifies
+    them with the multi-buffer kernels of pot_chain_batch. The passing ones
+    get the TLV stripped in place, as remove_pot_tlv does, and are reinjected
+    into the kernel through a multi-queue TAP device, which then runs the
+    SRv6 behaviour of the SID (e.g. End.DT6). The failing ones are dropped.
+
+    Usage: seg6-pot-xsk -i <iface> -a <algo> [-q queues] [-t tap] [-c|-z] [-s]
+                        [-b batch] [-k keys-map] [-l latency.json]
+
+    The keys are read from the pinned seg6_pot_keys map and reloaded every
+    second, reopening the pin since seg6-pot-tlv --daemon replaces the map. The socket map is found through the XDP program attached to the
+    interface, it is private to every loaded object.
+*/
+
+#define DEFAULT_KEYS_MAP "/sys/fs/bpf/seg6_pot_keys"
+#define DEFAULT_TAP "pot0"
+#define XSKS_MAP_NAME "seg6_pot_xsks"
+
+#define POT_MAX_SEGMENTS 8 // SRH_MAX_ALLOWED_SEGMENTS of the datapath
+#define MAX_QUEUES 64      // POT_MAX_QUEUES of bpf/pot/xsk.h
+#define MAX_KEYS 64
+#define MAX_BATCH 256
+
+#define FRAME_SIZE 2048
+#define NUM_FRAMES 4096
+#define RX_RING_SIZE 2048
+#define FILL_RING_SIZE NUM_FRAMES
+#define COMP_RING_SIZE 64
+
+#define ETH_HDR_LEN 14
+#define IPV6_HDR_LEN 40
+#define SRH_HDR_LEN 8
+#define NEXTHDR_SRH 43
+#define SRH_TYPE 4
+#define POT_TLV_TYPE 0xFC
+#define POT_MAX_SRH_TLVS 8 // of bpf/tlv.h
+#define POT_TLV_HDR_LEN 4
+
+#define LAT_SLOTS 32 // POT_LAT_SLOTS of bpf/pot/latency.h
+
+struct key_entry {
+    uint8_t sid[16];
+    uint8_t key[POT_KEY_LEN];
+};
+
+struct key_table {
+    struct key_entry keys[MAX_KEYS];
+    size_t len;
+};
+
+/* Producer and consumer view of one ring mapped from the socket */
+struct ring {
+    uint32_t *producer;
+    uint32_t *consumer;
+    uint32_t *flags;
+    void *desc;
+    uint32_t size;
+};
+
+struct lat_hist {
+    uint64_t slots[LAT_SLOTS];
+    uint64_t count;
+    uint64_t sum_ns;
+};
+
+struct stats {
+    uint64_t rx;
+    uint64_t passed;
+    uint64_t failed;
+    uint64_t invalid;
+};
+
+struct engine;
+
+struct queue {
+    struct engine *e;
+    uint32_t id;
+    int fd;
+    int tap;
+    uint8_t *umem;
+    struct ring rx, fill, comp;
+
+    struct stats stats;
+    struct lat_hist lat;
+    pthread_t thread;
+};
+
+struct engine {
+    enum pot_algo algo;
+    enum pot_simd simd;
+    size_t wlen, tlv_len;
+    int isaddr;
+    int latency;
+    unsigned batch;
+
+    const char *keys_path;
+    uint8_t tap_mac[6];
+
+    struct queue queues[MAX_QUEUES];
+    unsigned nqueues;
+};
+
+/* Pending packet of a batch */
+struct pkt {
+    uint8_t *frame;
+    uint32_t len;
+    uint32_t tlv_off; // From the start of the frame
+    uint8_t n;
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int bpf_sys(int cmd, union bpf_attr *attr)
+{
+    return (int)syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static int bpf_obj_get(const char *path)
+{
+    union bpf_attr attr = {.pathname = (uint64_t)(uintptr_t)path};
+    return bpf_sys(BPF_OBJ_GET, &attr);
+}
+
+static int bpf_obj_info(int fd, void *info, uint32_t len)
+{
+    union bpf_attr attr = {.info = {.bpf_fd = (uint32_t)fd, .info_len = len, .info = (uint64_t)(uintptr_t)info}};
+    return bpf_sys(BPF_OBJ_GET_INFO_BY_FD, &attr);
+}
+
+/* Copies the pinned SID→key map into t, the map holds a handful of keys */
+static int load_keys(int map_fd, struct key_table *t)
+{
+    uint8_t sid[16], next[16];
+    union bpf_attr attr;
+    void *prev = NULL;
+
+    t->len = 0;
+    for (;;) {
+        attr = (union bpf_attr){.map_fd = (uint32_t)map_fd,
+                                .key = (uint64_t)(uintptr_t)prev,
+                                .next_key = (uint64_t)(uintptr_t)next};
+        if (bpf_sys(BPF_MAP_GET_NEXT_KEY, &attr) < 0)
+            return errno == ENOENT ? 0 : -1;
+
+        memcpy(sid, next, sizeof(sid));
+        prev = sid;
+        if (t->len == MAX_KEYS)
+            continue;
+
+        struct key_entry *e = &t->keys[t->len];
+        attr = (union bpf_attr){.map_fd = (uint32_t)map_fd,
+                                .key = (uint64_t)(uintptr_t)sid,
+                                .value = (uint64_t)(uintptr_t)e->key};
+        // Deleted in between, skip it
+        if (bpf_sys(BPF_MAP_LOOKUP_ELEM, &attr) < 0)
+            continue;
+        memcpy(e->sid, sid, sizeof(sid));
+        t->len++;
+    }
+}
+
+static const uint8_t *lookup_key(const struct key_table *t, const uint8_t *sid)
+{
+    for (size_t i = 0; i < t->len; i++)
+        if (memcmp(t->keys[i].sid, sid, 16) == 0)
+            return t->keys[i].key;
+    return NULL;
+}
+
+/* Id of the XDP program attached to ifindex, asked over rtnetlink as it is namespace local */
+static int xdp_prog_id(int ifindex, uint32_t *id)
+{
+    struct {
+        struct nlmsghdr nh;
+        struct ifinfomsg ifi;
+    } req = {
+        .nh = {.nlmsg_len = sizeof(req), .nlmsg_type = RTM_GETLINK, .nlmsg_flags = NLM_F_REQUEST, .nlmsg_seq = 1},
+        .ifi = {.ifi_family = AF_UNSPEC, .ifi_index = ifindex},
+    };
+    char buf[32768];
+
+    int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0)
+        return -1;
+
+    ssize_t len = -1;
+    if (send(fd, &req, sizeof(req), 0) == sizeof(req))
+        len = recv(fd, buf, sizeof(buf), 0);
+    close(fd);
+
+    struct nlmsghdr *nh = (struct nlmsghdr *)buf;
+    if (len < 0 || !NLMSG_OK(nh, (size_t)len) || nh->nlmsg_type != RTM_NEWLINK)
+        return -1;
+
+    *id = 0;
+    int attrs = (int)IFLA_PAYLOAD(nh);
+    for (struct rtattr *rta = IFLA_RTA(NLMSG_DATA(nh)); RTA_OK(rta, attrs); rta = RTA_NEXT(rta, attrs)) {
+        if ((rta->rta_type & NLA_TYPE_MASK) != IFLA_XDP)
+            continue;
+
+        int nested = (int)RTA_PAYLOAD(rta);
+        for (struct rtattr *x = RTA_DATA(rta); RTA_OK(x, nested); x = RTA_NEXT(x, nested))
+            if ((x->rta_type & NLA_TYPE_MASK) == IFLA_XDP_PROG_ID)
+                memcpy(id, RTA_DATA(x), sizeof(*id));
+    }
+    return *id ? 0 : -1;
+}
+
+/* The seg6_pot_xsks map of the XDP program attached to ifindex */
+static int find_xsks_map(int ifindex)
+{
+    uint32_t prog_id, map_ids[64];
+    struct bpf_prog_info prog_info = {.nr_map_ids = 64, .map_ids = (uint64_t)(uintptr_t)map_ids};
+    union bpf_attr attr;
+
+    if (xdp_prog_id(ifindex, &prog_id) < 0) {
+        fprintf(stderr, "[-] no XDP program attached\n");
+        return -1;
+    }
+
+    attr = (union bpf_attr){.prog_id = prog_id};
+    int prog = bpf_sys(BPF_PROG_GET_FD_BY_ID, &attr);
+    if (prog < 0 || bpf_obj_info(prog, &prog_info, sizeof(prog_info)) < 0) {
+        perror("[-] XDP program info");
+        if (prog >= 0)
+            close(prog);
+        return -1;
+    }
+    close(prog);
+
+    uint32_t nr = prog_info.nr_map_ids < 64 ? prog_info.nr_map_ids : 64;
+    for (uint32_t i = 0; i < nr; i++) {
+        struct bpf_map_info info = {0};
+
+        attr = (union bpf_attr){.map_id = map_ids[i]};
+        int fd = bpf_sys(BPF_MAP_GET_FD_BY_ID, &attr);
+        if (fd < 0)
+            continue;
+        if (bpf_obj_info(fd, &info, sizeof(info)) == 0 && info.type == BPF_MAP_TYPE_XSKMAP &&
+            strcmp(info.name, XSKS_MAP_NAME) == 0)
+            return fd;
+        close(fd);
+    }
+
+    fprintf(stderr, "[-] the XDP program has no %s map, build it with AFXDP=1 and without --cpus\n",
+            XSKS_MAP_NAME);
+    return -1;
+}
+
+static unsigned rx_queues(const char *iface)
+{
+    char path[128];
+    unsigned n = 0;
+
+    snprintf(path, sizeof(path), "/sys/class/net/%s/queues", iface);
+    DIR *dir = opendir(path);
+    if (!dir)
+        return 1;
+
+    for (struct dirent *d; (d = readdir(dir));)
+        n += strncmp(d->d_name, "rx-", 3) == 0;
+    closedir(dir);
+    return n ? n : 1;
+}
+
+/* One queue of the multi-queue TAP, the kernel receives what is written to it */
+static int tap_open(const char *name)
+{
+    struct ifreq ifr = {.ifr_flags = IFF_TAP | IFF_NO_PI | IFF_MULTI_QUEUE};
+    strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+
+    int fd = open("/dev/net/tun", O_RDWR | O_CLOEXEC);
+    if (fd < 0 || ioctl(fd, TUNSETIFF, &ifr) < 0) {
+        perror("[-] TAP queue");
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Brings the TAP up and returns its MAC, the reinjected frames are addressed to it */
+static int tap_up(const char *name, uint8_t mac[6])
+{
+    struct ifreq ifr = {0};
+    strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    int ret = -1;
+    if (ioctl(fd, SIOCGIFHWADDR, &ifr) == 0) {
+        memcpy(mac, ifr.ifr_hwaddr.sa_data, 6);
+        if (ioctl(fd, SIOCGIFFLAGS, &ifr) == 0) {
+            ifr.ifr_flags |= IFF_UP;
+            ret = ioctl(fd, SIOCSIFFLAGS, &ifr);
+        }
+    }
+    if (ret < 0)
+        perror("[-] TAP up");
+    close(fd);
+    return ret;
+}
+
+static int map_ring(int fd, struct ring *r, const struct xdp_ring_offset *off, uint32_t size,
+                    size_t desc_size, off_t pgoff)
+{
+    uint8_t *map = mmap(NULL, off->desc + size * desc_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, pgoff);
+    if (map == MAP_FAILED)
+        return -1;
+
+    r->producer = (uint32_t *)(map + off->producer);
+    r->consumer = (uint32_t *)(map + off->consumer);
+    r->flags = (uint32_t *)(map + off->flags);
+    r->desc = map + off->desc;
+    r->size = size;
+    return 0;
+}
+
+/* Hands n frames back to the driver */
+static void fill_frames(struct ring *fill, const uint64_t *addrs, uint32_t n)
+{
+    uint32_t prod = *fill->producer;
+    uint64_t *ring = fill->desc;
+
+    // Every frame is owned by the fill ring, the rx ring or this thread, so there's always room
+    for (uint32_t i = 0; i < n; i++)
+        ring[(prod + i) & (fill->size - 1)] = addrs[i];
+    __atomic_store_n(fill->producer, prod + n, __ATOMIC_RELEASE);
+}
+
+/*
+    Creates the socket of one queue with its own UMEM, binds it zero-copy
+    when allowed and the driver supports it, and fills the fill ring.
+*/
+static int queue_open(struct queue *q, int ifindex, int copy, int zerocopy)
+{
+    struct xdp_mmap_offsets off;
+    socklen_t optlen = sizeof(off);
+    size_t umem_len = (size_t)NUM_FRAMES * FRAME_SIZE;
+
+    q->fd = socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (q->fd < 0) {
+        perror("[-] AF_XDP socket");
+        return -1;
+    }
+
+    q->umem = mmap(NULL, umem_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (q->umem == MAP_FAILED) {
+        perror("[-] UMEM");
+        return -1;
+    }
+
+    struct xdp_umem_reg reg = {.addr = (uint64_t)(uintptr_t)q->umem, .len = umem_len, .chunk_size = FRAME_SIZE};
+    uint32_t rx_size = RX_RING_SIZE, fill_size = FILL_RING_SIZE, comp_size = COMP_RING_SIZE;
+
+    if (setsockopt(q->fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0 ||
+        setsockopt(q->fd, SOL_XDP, XDP_UMEM_FILL_RING, &fill_size, sizeof(fill_size)) < 0 ||
+        setsockopt(q->fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &comp_size, sizeof(comp_size)) < 0 ||
+        setsockopt(q->fd, SOL_XDP, XDP_RX_RING, &rx_size, sizeof(rx_size)) < 0 ||
+        getsockopt(q->fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) < 0) {
+        perror("[-] AF_XDP rings");
+        return -1;
+    }
+
+    if (map_ring(q->fd, &q->rx, &off.rx, rx_size, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) < 0 ||
+        map_ring(q->fd, &q->fill, &off.fr, fill_size, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) < 0 ||
+        map_ring(q->fd, &q->comp, &off.cr, comp_size, sizeof(uint64_t), XDP_UMEM_PGOFF_COMPLETION_RING) < 0) {
+        perror("[-] AF_XDP ring mmap");
+        return -1;
+    }
+
+    uint64_t addrs[NUM_FRAMES];
+    for (uint32_t i = 0; i < NUM_FRAMES; i++)
+        addrs[i] = (uint64_t)i * FRAME_SIZE;
+    fill_frames(&q->fill, addrs, NUM_FRAMES);
+
+    struct sockaddr_xdp sxdp = {.sxdp_family = AF_XDP, .sxdp_ifindex = (uint32_t)ifindex, .sxdp_queue_id = q->id};
+    int ret = -1;
+
+    if (!copy) {
+        sxdp.sxdp_flags = XDP_ZEROCOPY | XDP_USE_NEED_WAKEUP;
+        ret = bind(q->fd, (struct sockaddr *)&sxdp, sizeof(sxdp));
+        if (ret < 0 && zerocopy) {
+            perror("[-] AF_XDP zero-copy bind");
+            return -1;
+        }
+    }
+    if (ret < 0) {
+        sxdp.sxdp_flags = XDP_COPY | XDP_USE_NEED_WAKEUP;
+        if (bind(q->fd, (struct sockaddr *)&sxdp, sizeof(sxdp)) < 0) {
+            perror("[-] AF_XDP bind");
+            return -1;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/*
+    Checks the frame as parse_pot_tlv does: an SRv6 packet at its last SID
+    carrying the TLV of the algorithm once, among at most POT_MAX_SRH_TLVS
+    TLVs after the segment list, which the SRH length covers.
+*/
+static int parse_frame(const struct engine *e, uint8_t *frame, uint32_t len, struct pkt *p)
+{
+    if (len < ETH_HDR_LEN + IPV6_HDR_LEN + SRH_HDR_LEN || frame[12] != 0x86 || frame[13] != 0xdd)
+        return -1;
+
+    const uint8_t *ip6 = frame + ETH_HDR_LEN, *srh = ip6 + IPV6_HDR_LEN;
+    unsigned n = srh[4] + 1u;
+    size_t srh_len = (srh[1] + 1u) * 8u;
+
+    if ((ip6[0] >> 4) != 6 || ip6[6] != NEXTHDR_SRH || srh[2] != SRH_TYPE || srh[3] != 0 ||
+        n > POT_MAX_SEGMENTS || srh_len < SRH_HDR_LEN + 16 * n + e->tlv_len ||
+        ETH_HDR_LEN + IPV6_HDR_LEN + srh_len > len)
+        return -1;
+
+    const uint8_t *q = srh + SRH_HDR_LEN + 16 * n, *end = srh + srh_len, *tlv = NULL;
+    for (int i = 0; i < POT_MAX_SRH_TLVS && q < end; i++) {
+        if (q[0] == 0) { // Pad1
+            q++;
+            continue;
+        }
+        if (q + 2 > end || q + 2 + q[1] > end)
+            return -1;
+        if (q[0] == POT_TLV_TYPE) {
+            if (tlv || q[1] != e->tlv_len - 2)
+                return -1;
+            tlv = q;
+        }
+        q += 2 + q[1];
+    }
+    if (q < end || !tlv)
+        return -1;
+
+    p->frame = frame;
+    p->len = len;
+    p->tlv_off = (uint32_t)(tlv - frame);
+    p->n = (uint8_t)n;
+    return 0;
+}
+
+static uint8_t *pkt_srh(const struct pkt *p)
+{
+    return p->frame + ETH_HDR_LEN + IPV6_HDR_LEN;
+}
+
+static uint8_t *pkt_tlv(const struct pkt *p)
+{
+    return p->frame + p->tlv_off;
+}
+
+static int same_path(const struct engine *e, const struct pkt *a, const struct pkt *b)
+{
+    if (e->isaddr && memcmp(a->frame + ETH_HDR_LEN + 8, b->frame + ETH_HDR_LEN + 8, 16) != 0)
+        return 0;
+    return a->n == b->n && memcmp(pkt_srh(a) + SRH_HDR_LEN, pkt_srh(b) + SRH_HDR_LEN, 16 * a->n) == 0;
+}
+
+/*
+    The datapath hashes the witness once more with the key of segments[0]
+    and compares it with the chain of every SID. Hashing the same message
+    gives the same witness, so comparing the received one with the chain
+    of segments[last]..segments[1] is the same check with one hash less.
+    The key of segments[0] must still exist, as the datapath needs it.
+*/
+static void verify_run(const struct engine *e, const struct key_table *t, struct pkt *run, size_t m,
+                       uint8_t *msgs, uint8_t *pass)
+{
+    uint8_t keys[POT_MAX_SEGMENTS + 1][POT_KEY_LEN];
+    const uint8_t *key, *srh = pkt_srh(&run[0]);
+    size_t stride = pot_msg_len(e->algo), nkeys = 0;
+    int missing = 0;
+
+    if (e->isaddr) {
+        if ((key = lookup_key(t, run[0].frame + ETH_HDR_LEN + 8)))
+            memcpy(keys[nkeys++], key, POT_KEY_LEN);
+        else
+            missing = 1;
+    }
+    for (int i = run[0].n - 1; i > 0; i--) {
+        if ((key = lookup_key(t, srh + SRH_HDR_LEN + 16 * i)))
+            memcpy(keys[nkeys++], key, POT_KEY_LEN);
+        else
+            missing = 1;
+    }
+
+    if (missing || !lookup_key(t, srh + SRH_HDR_LEN)) {
+        memset(pass, 0, m);
+        return;
+    }
+
+    for (size_t i = 0; i < m; i++)
+        memcpy(msgs + i * stride, pkt_tlv(&run[i]) + POT_TLV_HDR_LEN, POT_NONCE_LEN);
+    pot_chain_batch(e->algo, e->simd, (const uint8_t (*)[POT_KEY_LEN])keys, nkeys, msgs, stride, m);
+
+    for (size_t i = 0; i < m; i++)
+        pass[i] = memcmp(msgs + i * stride + POT_NONCE_LEN, pkt_tlv(&run[i]) + POT_TLV_HDR_LEN + POT_NONCE_LEN,
+                         e->wlen) == 0;
+}
+
+/*
+    Shifts the headers in front of the TLV over it, as remove_pot_tlv does,
+    and addresses the frame to the TAP. Returns the new start of the frame.
+*/
+static uint8_t *strip_tlv(const struct engine *e, struct pkt *p)
+{
+    uint8_t *frame = p->frame + e->tlv_len;
+
+    memmove(frame, p->frame, p->tlv_off);
+    p->len -= (uint32_t)e->tlv_len;
+
+    uint8_t *ip6 = frame + ETH_HDR_LEN;
+    uint16_t payload_len = (uint16_t)(((ip6[4] << 8) | ip6[5]) - e->tlv_len);
+    ip6[4] = (uint8_t)(payload_len >> 8);
+    ip6[5] = (uint8_t)payload_len;
+    ip6[IPV6_HDR_LEN + 1] -= (uint8_t)(e->tlv_len / 8);
+
+    memcpy(frame, e->tap_mac, 6);
+    return frame;
+}
+
+static void lat_record(struct lat_hist *h, uint64_t delta)
+{
+    unsigned slot = delta ? 63u - (unsigned)__builtin_clzll(delta) : 0;
+    h->slots[slot < LAT_SLOTS ? slot : LAT_SLOTS - 1]++;
+    h->count++;
+    h->sum_ns += delta;
+}
+
+static void *queue_worker(void *arg)
+{
+    struct queue *q = arg;
+    const struct engine *e = q->e;
+    struct key_table keys;
+    struct pkt pkts[MAX_BATCH];
+    uint64_t addrs[MAX_BATCH];
+    uint8_t pass[MAX_BATCH];
+    uint8_t *msgs = malloc(MAX_BATCH * pot_msg_len(e->algo));
+    struct pollfd pfd = {.fd = q->fd, .events = POLLIN};
+    const struct xdp_desc *descs = q->rx.desc;
+    uint64_t reload = 0;
+
+    if (!msgs) {
+        perror("malloc");
+        exit(2);
+    }
+
+    while (!stop) {
+        uint64_t start = now_ns();
+        if (start >= reload) {
+            int keys_fd = bpf_obj_get(e->keys_path);
+            if (keys_fd < 0 || load_keys(keys_fd, &keys) < 0)
+                perror("[-] reading the keys map");
+            if (keys_fd >= 0)
+                close(keys_fd);
+            reload = start + 1000000000ull;
+        }
+
+        uint32_t cons = *q->rx.consumer;
+        uint32_t avail = __atomic_load_n(q->rx.producer, __ATOMIC_ACQUIRE) - cons;
+        if (!avail) {
+            // Sleeps until the driver fills the rx ring, which wakes it up when asked to
+            poll(&pfd, 1, 100);
+            continue;
+        }
+        if (e->latency)
+            start = now_ns();
+
+        uint32_t n = avail < e->batch ? avail : e->batch, m = 0;
+        uint64_t invalid = 0, passed = 0;
+
+        for (uint32_t i = 0; i < n; i++) {
+            const struct xdp_desc *d = &descs[(cons + i) & (q->rx.size - 1)];
+            addrs[i] = d->addr & ~(uint64_t)(FRAME_SIZE - 1);
+
+            if (parse_frame(e, q->umem + d->addr, d->len, &pkts[m]) == 0)
+                m++;
+            else
+                invalid++;
+        }
+        __atomic_store_n(q->rx.consumer, cons + n, __ATOMIC_RELEASE);
+
+        // Consecutive packets of the same path share the keys and the SIMD lanes
+        for (uint32_t i = 0, j; i < m; i = j) {
+            for (j = i + 1; j < m && same_path(e, &pkts[i], &pkts[j]); j++)
+                ;
+            verify_run(e, &keys, pkts + i, j - i, msgs, pass + i);
+        }
+
+        for (uint32_t i = 0; i < m; i++) {
+            if (!pass[i])
+                continue;
+
+            uint8_t *frame = strip_tlv(e, &pkts[i]);
+            // A full TAP queue drops it as a full rx ring would, it counts as failed
+            if (write(q->tap, frame, pkts[i].len) < 0)
+                continue;
+            passed++;
+            if (e->latency)
+                lat_record(&q->lat, now_ns() - start);
+        }
+
+        if (__atomic_load_n(q->fill.flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP)
+            recvfrom(q->fd, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+        fill_frames(&q->fill, addrs, n);
+
+        __atomic_fetch_add(&q->stats.rx, n, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&q->stats.passed, passed, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&q->stats.failed, m - passed, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&q->stats.invalid, invalid, __ATOMIC_RELAXED);
+    }
+
+    free(msgs);
+    return NULL;
+}
+
+static struct stats total_stats(struct engine *e)
+{
+    struct stats s = {0};
+    for (unsigned i = 0; i < e->nqueues; i++) {
+        struct stats *q = &e->queues[i].stats;
+        s.rx += __atomic_load_n(&q->rx, __ATOMIC_RELAXED);
+        s.passed += __atomic_load_n(&q->passed, __ATOMIC_RELAXED);
+        s.failed += __atomic_load_n(&q->failed, __ATOMIC_RELAXED);
+        s.invalid += __atomic_load_n(&q->invalid, __ATOMIC_RELAXED);
+    }
+    return s;
+}
+
+/* Upper bound in ns of the slot holding the q quantile, as cmd/latency.go */
+static uint64_t percentile(const struct lat_hist *h, double q)
+{
+    uint64_t target = (uint64_t)(q * (double)h->count + 0.999999), cum = 0;
+    for (int i = 0; i < LAT_SLOTS; i++) {
+        cum += h->slots[i];
+        if (cum >= target)
+            return (1ull << (i + 1)) - 1;
+    }
+    return UINT64_MAX;
+}
+
+/*
+    Writes the time from taking a packet off the rx ring to its reinjection
+    in the report format of seg6-pot-tlv --latency, as the remove/total
+    stage it stands for.
+*/
+static int write_latency(struct engine *e, const char *path)
+{
+    struct lat_hist h = {0};
+    for (unsigned i = 0; i < e->nqueues; i++) {
+        for (int s = 0; s < LAT_SLOTS; s++)
+            h.slots[s] += e->queues[i].lat.slots[s];
+        h.count += e->queues[i].lat.count;
+        h.sum_ns += e->queues[i].lat.sum_ns;
+    }
+
+    if (!h.count) {
+        fprintf(stderr, "[*] no latency samples recorded\n");
+        return 0;
+    }
+
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    fprintf(f, "[\n  {\n    \"algorithm\": \"%s\",\n    \"path\": \"remove\",\n    \"stage\": \"total\",\n",
+            pot_algo_name(e->algo));
+    fprintf(f, "    \"count\": %llu,\n    \"mean_ns\": %.1f,\n", (unsigned long long)h.count,
+            (double)h.sum_ns / (double)h.count);
+    fprintf(f, "    \"p50_ns\": %llu,\n    \"p99_ns\": %llu,\n    \"p999_ns\": %llu,\n    \"slots\": [",
+            (unsigned long long)percentile(&h, 0.50), (unsigned long long)percentile(&h, 0.99),
+            (unsigned long long)percentile(&h, 0.999));
+    for (int s = 0; s < LAT_SLOTS; s++)
+        fprintf(f, "%s%llu", s ? ", " : "", (unsigned long long)h.slots[s]);
+    fprintf(f, "]\n  }\n]\n");
+    fclose(f);
+
+    fprintf(stderr, "[+] latency p50 %llu ns, p99 %llu ns, p999 %llu ns over %llu packets\n",
+            (unsigned long long)percentile(&h, 0.50), (unsigned long long)percentile(&h, 0.99),
+            (unsigned long long)percentile(&h, 0.999), (unsigned long long)h.count);
+    return 0;
+}
+
+static int update_xsks(int map_fd, uint32_t queue, int fd)
+{
+    union bpf_attr attr = {.map_fd = (uint32_t)map_fd,
+                           .key = (uint64_t)(uintptr_t)&queue,
+                           .value = (uint64_t)(uintptr_t)&fd};
+    return bpf_sys(BPF_MAP_UPDATE_ELEM, &attr);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s -i <iface> -a <algo> [-q queues] [-t tap] [-c|-z] [-s] [-b batch]\n"
+            "       %*s [-k keys-map] [-l latency.json]\n",
+            prog, (int)strlen(prog), "");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static struct engine e;
+    const char *iface = NULL, *algo = NULL, *tap = DEFAULT_TAP, *keys = DEFAULT_KEYS_MAP, *latency = NULL;
+    unsigned queues = 0;
+    int copy = 0, zerocopy = 0, opt;
+
+    e.batch = 64;
+    while ((opt = getopt(argc, argv, "i:a:q:t:czsb:k:l:")) != -1) {
+        switch (opt) {
+        case 'i': iface = optarg; break;
+        case 'a': algo = optarg; break;
+        case 'q': queues = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 't': tap = optarg; break;
+        case 'c': copy = 1; break;
+        case 'z': zerocopy = 1; break;
+        case 's': e.isaddr = 1; break;
+        case 'b': e.batch = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'k': keys = optarg; break;
+        case 'l': latency = optarg; break;
+        default: usage(argv[0]);
+        }
+    }
+
+    int id = algo ? pot_algo_parse(algo) : -1;
+    if (!iface || id < 0 || (copy && zerocopy) || !e.batch || e.batch > MAX_BATCH || optind != argc)
+        usage(argv[0]);
+
+    e.algo = id;
+    e.simd = pot_simd_best(e.algo);
+    e.wlen = pot_witness_len(e.algo);
+    e.tlv_len = POT_TLV_HDR_LEN + pot_msg_len(e.algo);
+    e.latency = latency != NULL;
+
+    int ifindex = (int)if_nametoindex(iface);
+    if (!ifindex) {
+        perror(iface);
+        return 2;
+    }
+
+    if (!queues)
+        queues = rx_queues(iface);
+    if (queues > MAX_QUEUES) {
+        fprintf(stderr, "[-] at most %d queues\n", MAX_QUEUES);
+        return 2;
+    }
+
+    int keys_fd = bpf_obj_get(keys);
+    if (keys_fd < 0) {
+        perror(keys);
+        return 2;
+    }
+    close(keys_fd);
+    e.keys_path = keys;
+
+    int xsks = find_xsks_map(ifindex);
+    if (xsks < 0)
+        return 2;
+
+    struct sigaction sa = {.sa_handler = on_signal};
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    // The socket map entries go away with the sockets when the engine exits
+    for (e.nqueues = 0; e.nqueues < queues; e.nqueues++) {
+        struct queue *q = &e.queues[e.nqueues];
+        q->e = &e;
+        q->id = e.nqueues;
+
+        if ((q->tap = tap_open(tap)) < 0)
+            return 2;
+        if (e.nqueues == 0 && tap_up(tap, e.tap_mac) < 0)
+            return 2;
+
+        int mode = queue_open(q, ifindex, copy, zerocopy);
+        if (mode < 0)
+            return 2;
+
+        if (update_xsks(xsks, q->id, q->fd) < 0) {
+            perror("[-] adding the socket to " XSKS_MAP_NAME);
+            return 2;
+        }
+        if (pthread_create(&q->thread, NULL, queue_worker, q) != 0) {
+            perror("pthread_create");
+            return 2;
+        }
+        fprintf(stderr, "[+] %s queue %u bound in %s mode\n", iface, q->id, mode ? "copy" : "zero-copy");
+    }
+
+    fprintf(stderr, "[+] Validating %s with %s kernels, reinjecting into %s — press Ctrl-C to exit\n",
+            pot_algo_name(e.algo), pot_simd_name(e.simd), tap);
+
+    struct stats last = {0};
+    uint64_t last_ns = now_ns();
+    while (!stop) {
+        sleep(1);
+
+        struct stats s = total_stats(&e);
+        uint64_t t = now_ns();
+        double secs = (double)(t - last_ns) / 1e9;
+        printf("[+] rx %.3f Mpps, passed %.3f Mpps, failed %llu, invalid %llu\n",
+               (double)(s.rx - last.rx) / secs / 1e6, (double)(s.passed - last.passed) / secs / 1e6,
+               (unsigned long long)(s.failed - last.failed), (unsigned long long)(s.invalid - last.invalid));
+        fflush(stdout);
+        last = s;
+        last_ns = t;
+    }
+
+    for (unsigned i = 0; i < e.nqueues; i++)
+        pthread_join(e.queues[i].thread, NULL);
+
+    struct stats s = total_stats(&e);
+    fprintf(stderr, "[+] %llu packets, %llu passed, %llu failed, %llu invalid\n", (unsigned long long)s.rx,
+            (unsigned long long)s.passed, (unsigned long long)s.failed, (unsigned long long)s.invalid);
+
+    if (latency && write_latency(&e, latency) < 0)
+        return 2;
+    return 0;
+}
@@ -16,8 +16,115 @@
 #include "srh.h"
 
 #include "pot/add.h"
+#include "pot/capture.h"
+#include "pot/flow.h"
+#include "pot/forward.h"
+#include "pot/pipeline.h"
 #include "pot/remove.h"
 #include "pot/update.h"
+#if POT_AFXDP
+#include "pot/xsk.h"
+#endif
+#if POT_CSID
+#include "csid.h"
+#if POT_AFXDP
+#error "seg6-pot-xsk validates uncompressed SID lists only, build without CSID=1"
+#endif
+#endif
+#if POT_HOPTS
+#if POT_CSID
+#error "Hop timestamps take one slot per SID, build without CSID=1"
+#endif
+#if POT_AFXDP
+#error "seg6-pot-xsk validates TLVs without hop timestamps, build without AFXDP=1"
+#endif
+#endif
+
+/*
+    Algorithm of the object, found by name in the BTF of its programs by
+    --profile. Nothing reads the value.
+*/
+#if POLY1305
+const volatile __u8 seg6_pot_alg_poly1305 = 1;
+#elif HMAC_SHA1
+const volatile __u8 seg6_pot_alg_hmac_sha1 = 1;
+#elif HMAC_SHA256
+const volatile __u8 seg6_pot_alg_hmac_sha256 = 1;
+#elif SIPHASH
+const volatile __u8 seg6_pot_alg_siphash = 1;
+#elif HALFSIPHASH
+const volatile __u8 seg6_pot_alg_halfsiphash = 1;
+#else
+const volatile __u8 seg6_pot_alg_blake3 = 1;
+#endif
+
+int seg6_pot_tlv_d_witness(struct xdp_md *ctx);
+int seg6_pot_tlv_d_chain(struct xdp_md *ctx);
+int seg6_pot_tlv_d_strip(struct xdp_md *ctx);
+int seg6_pot_tlv_d_forward(struct xdp_md *ctx);
+int seg6_pot_tlv_d_decap(struct xdp_md *ctx);
+int seg6_pot_tlv_i_witness(struct __sk_buff *skb);
+int seg6_pot_tlv_i_chain(struct __sk_buff *skb);
+int seg6_pot_tlv_i_strip(struct __sk_buff *skb);
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PROG_ARRAY);
+    __uint(max_entries, POT_STAGE_MAX);
+    __uint(key_size, sizeof(__u32));
+    __array(values, int (void *));
+} seg6_pot_stages SEC(".maps") = {
+    .values = {
+        [POT_STAGE_WITNESS] = (void *)&seg6_pot_tlv_d_witness,
+        [POT_STAGE_CHAIN] = (void *)&seg6_pot_tlv_d_chain,
+        [POT_STAGE_STRIP] = (void *)&seg6_pot_tlv_d_strip,
+        [POT_STAGE_FORWARD] = (void *)&seg6_pot_tlv_d_forward,
+        [POT_STAGE_DECAP] = (void *)&seg6_pot_tlv_d_decap,
+    },
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PROG_ARRAY);
+    __uint(max_entries, POT_STAGE_MAX);
+    __uint(key_size, sizeof(__u32));
+    __array(values, int (void *));
+} seg6_pot_tc_stages SEC(".maps") = {
+    .values = {
+        [POT_STAGE_WITNESS] = (void *)&seg6_pot_tlv_i_witness,
+        [POT_STAGE_CHAIN] = (void *)&seg6_pot_tlv_i_chain,
+        [POT_STAGE_STRIP] = (void *)&seg6_pot_tlv_i_strip,
+    },
+};
+
+/*
+    Attached instead of seg6_pot_tlv_d when the loader spreads the validation
+    over several CPUs, seg6_pot_tlv_d and its stages then run as the cpumap
+    program on the CPU picked by the inner flow hash.
+*/
+SEC("xdp")
+int seg6_pot_tlv_d_steer(struct xdp_md *ctx)
+{
+    void *end = (void *)(long)ctx->data_end;
+    void *data = (void *)(long)ctx->data;
+
+    struct pot_hdrs hdrs;
+
+    // SRv6 packets must never reach the kernel without being validated
+    int parsed = parse_srv6_hdrs(data, end, &hdrs);
+    if (parsed == POT_HDRS_TOO_DEEP) {
+        bpf_printk("[seg6_pot_tlv][-] Too many options headers to find the SRH\n");
+        return XDP_DROP;
+    }
+    if (parsed < 0)
+        return XDP_PASS;
+
+    __u32 cpu = 0;
+    if (pot_flow_cpu(ctx, &hdrs, &cpu) != 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to pick a CPU for the flow\n");
+        return XDP_DROP;
+    }
+
+    return (int)bpf_redirect_map(&seg6_pot_cpumap, cpu, XDP_DROP);
+}
 
 SEC("xdp")
 int seg6_pot_tlv_d(struct xdp_md *ctx)
@@ -25,93 +132,351 @@ int seg6_pot_tlv_d(struct xdp_md *ctx)
     void *end = (void *)(long)ctx->data_end;
     void *data = (void *)(long)ctx->data;
 
-    struct ethhdr *eth = ETH_HDR_PTR;
+    struct pot_hdrs hdrs;
     struct ipv6hdr *ipv6;
     struct srh *srh;
+    struct pot_scratch *scratch;
 
-    if (eth_hdr_cb(eth, end) < 0)
+    // VLAN tags and extension headers may come before the SRH, anything else isn't SRv6
+    int parsed = parse_srv6_hdrs(data, end, &hdrs);
+    if (parsed == POT_HDRS_TOO_DEEP) {
+        bpf_printk("[seg6_pot_tlv][-] Too many options headers to find the SRH\n");
+        return XDP_DROP;
+    }
+    if (parsed < 0)
         return XDP_PASS;
 
-    if (eth->h_proto != bpf_htons(ETH_P_IPV6))
+    ipv6 = ip6_hdr_at(data, end, &hdrs);
+    srh = srh_hdr_at(data, end, &hdrs);
+    if (!ipv6 || !srh)
         return XDP_PASS;
 
-    ipv6 = IPV6_HDR_PTR;
-
-    if (ip6_hdr_cb(ipv6, end) < 0)
+    scratch = pot_scratch_get();
+    if (!scratch)
         return XDP_PASS;
 
-    switch (ipv6->nexthdr) {
-    case SRH_NEXT_HEADER:
-        srh = SRH_HDR_PTR;
+    // Endpoint Node when the last SID is active, otherwise Transit Node
+    __u32 endpoint = seg6_last_sid(srh) == 0;
+#if POT_CSID
+    // Unless the destination address still carries C-SIDs after the active one
+    endpoint = endpoint && !csid_has_next(&ipv6->daddr);
+#endif
 
-        if (srh_hdr_cb(srh, end) < 0)
-            return XDP_PASS;
+#if POT_AFXDP
+    // Every endpoint packet, whatever the behaviour of its SID, the engine
+    // validates it and the kernel then runs the SID on the reinjected packet
+    if (endpoint && pot_hdrs_fixed(&hdrs)) {
+        int action = pot_xsk_redirect(ctx);
+        if (action >= 0)
+            return action;
+    }
+#endif
 
-        // Endpoint Node
-        if (seg6_last_sid(srh) == 0) {
-            if (remove_pot_tlv(ctx) != 0) {
-                bpf_printk("[seg6_pot_tlv][-] Failed to remove TLV\n");
-                return XDP_DROP;
-            }
+    POT_LAT_START(start);
+    if (parse_pot_tlv(data, end, &hdrs, scratch, endpoint, ctx->ingress_ifindex) != 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to parse TLV\n");
+        pot_path_account(data, end, &hdrs, &scratch->path, (__u64)(end - data), 1);
+        pot_capture_xdp(ctx, scratch, POT_CAP_REJECT);
+        return XDP_DROP;
+    }
+    POT_LAT_RECORD(endpoint ? POT_LAT_REMOVE : POT_LAT_UPDATE, POT_LAT_PARSE, start);
+    POT_LAT_SAVE(scratch, start);
 
-            bpf_printk("[seg6_pot_tlv][+] TLV removed successfully\n");
-            return XDP_PASS;
-        }
-        // Transit Nodes
-        else {
-            if (update_pot_tlv(ctx) != 0) {
-                bpf_printk("[seg6_pot_tlv][-] Failed to update TLV\n");
-                return XDP_DROP;
-            }
-
-            bpf_printk("[seg6_pot_tlv][+] TLV updated successfully\n");
-        }
-    default:
+    bpf_tail_call(ctx, &seg6_pot_stages, POT_STAGE_WITNESS);
+    bpf_printk("[seg6_pot_tlv][-] Failed to tail call the witness stage\n");
+    return XDP_DROP;
+}
+
+SEC("xdp")
+int seg6_pot_tlv_d_witness(struct xdp_md *ctx)
+{
+    void *data = (void *)(long)ctx->data;
+    void *end = (void *)(long)ctx->data_end;
+
+    struct pot_scratch *scratch = pot_scratch_get();
+    if (!scratch)
+        return XDP_DROP;
+
+    if (update_pot_tlv(data, end, scratch) != 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to update TLV\n");
+        return XDP_DROP;
+    }
+
+    // Transit Nodes
+    if (!scratch->endpoint) {
+        bpf_printk("[seg6_pot_tlv][+] TLV updated successfully\n");
+        POT_LAT_RECORD_TOTAL(POT_LAT_UPDATE, scratch);
+
+        // The TLV is already consistent, the kernel forwards it if the fast-path is unavailable
+        bpf_tail_call(ctx, &seg6_pot_stages, POT_STAGE_FORWARD);
         return XDP_PASS;
     }
 
+    // Endpoint Node
+    bpf_tail_call(ctx, &seg6_pot_stages, POT_STAGE_CHAIN);
+    bpf_printk("[seg6_pot_tlv][-] Failed to tail call the chain stage\n");
+    return XDP_DROP;
+}
+
+SEC("xdp")
+int seg6_pot_tlv_d_chain(struct xdp_md *ctx)
+{
+    void *data = (void *)(long)ctx->data;
+    void *end = (void *)(long)ctx->data_end;
+
+    struct pot_scratch *scratch = pot_scratch_get();
+    if (!scratch)
+        return XDP_DROP;
+
+    int ret = chain_pot_tlv(scratch);
+    if (ret < 0)
+        return XDP_DROP;
+
+    // One keyed-hash per call, keeps every SID under the verifier limits
+    if (ret > 0) {
+        bpf_tail_call(ctx, &seg6_pot_stages, POT_STAGE_CHAIN);
+        bpf_printk("[seg6_pot_tlv][-] Failed to tail call the chain stage\n");
+        return XDP_DROP;
+    }
+
+    int failed = verify_pot_tlv(data, end, scratch) != 0;
+    pot_path_account(data, end, &scratch->hdrs, &scratch->path, (__u64)(end - data), (__u32)failed);
+    pot_capture_xdp(ctx, scratch, failed ? POT_CAP_WITNESS : POT_CAP_PASS);
+    if (failed)
+        return XDP_DROP;
+
+    bpf_tail_call(ctx, &seg6_pot_stages, POT_STAGE_DECAP);
+    bpf_printk("[seg6_pot_tlv][-] Failed to tail call the decap stage\n");
+    return XDP_DROP;
+}
+
+SEC("xdp")
+int seg6_pot_tlv_d_decap(struct xdp_md *ctx)
+{
+    struct pot_scratch *scratch = pot_scratch_get();
+    if (!scratch)
+        return XDP_DROP;
+
+    POT_LAT_START(start);
+    __u32 ifindex = 0;
+    if (end_dt6_decap(ctx, &scratch->hdrs, scratch->srh_len, &ifindex) == 0) {
+        bpf_printk("[seg6_pot_tlv][+] TLV validated and packet decapsulated\n");
+        POT_LAT_RECORD(POT_LAT_REMOVE, POT_LAT_REWRITE, start);
+        POT_LAT_RECORD_TOTAL(POT_LAT_REMOVE, scratch);
+        return (int)bpf_redirect_map(&seg6_pot_devmap, ifindex, XDP_DROP);
+    }
+
+    // Not a local End.DT6 SID or no inner route, the kernel decapsulates it
+    bpf_tail_call(ctx, &seg6_pot_stages, POT_STAGE_STRIP);
+    bpf_printk("[seg6_pot_tlv][-] Failed to tail call the strip stage\n");
+    return XDP_DROP;
+}
+
+SEC("xdp")
+int seg6_pot_tlv_d_strip(struct xdp_md *ctx)
+{
+    struct pot_scratch *scratch = pot_scratch_get();
+    if (!scratch)
+        return XDP_DROP;
+
+    if (remove_pot_tlv(ctx, scratch) != 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to remove TLV\n");
+        return XDP_DROP;
+    }
+
+    bpf_printk("[seg6_pot_tlv][+] TLV removed successfully\n");
+    POT_LAT_RECORD_TOTAL(POT_LAT_REMOVE, scratch);
     return XDP_PASS;
 }
 
+SEC("xdp")
+int seg6_pot_tlv_d_forward(struct xdp_md *ctx)
+{
+    struct pot_scratch *scratch = pot_scratch_get();
+    if (!scratch)
+        return XDP_PASS;
+
+    return end_forward(ctx, &scratch->hdrs);
+}
+
+/* tc ingress fallback of seg6_pot_tlv_d, attached instead of it where native XDP is unavailable */
 SEC("tc")
-int seg6_pot_tlv(struct __sk_buff *skb)
+int seg6_pot_tlv_i(struct __sk_buff *skb)
 {
     void *data = (void *)(long)skb->data;
     void *end = (void *)(long)skb->data_end;
 
-    struct ethhdr *eth = ETH_HDR_PTR;
+    struct pot_hdrs hdrs;
     struct ipv6hdr *ipv6;
     struct srh *srh;
+    struct pot_scratch *scratch;
+    __u32 pull_len;
+
+    int parsed = parse_srv6_hdrs(data, end, &hdrs);
+    if (parsed == POT_HDRS_TOO_DEEP) {
+        bpf_printk("[seg6_pot_tlv][-] Too many options headers to find the SRH\n");
+        return TC_ACT_SHOT;
+    }
+    if (parsed < 0)
+        return TC_ACT_OK;
+
+    // The stages write the SRH and TLV in place, keep them in the linear area
+    pull_len = skb->len < POT_TC_PULL_LEN ? skb->len : (__u32)POT_TC_PULL_LEN;
+    if (bpf_skb_pull_data(skb, pull_len) < 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to pull SRv6 headers\n");
+        return TC_ACT_SHOT;
+    }
+
+    data = (void *)(long)skb->data;
+    end = (void *)(long)skb->data_end;
 
-    if (eth_hdr_cb(eth, end) < 0)
+    ipv6 = ip6_hdr_at(data, end, &hdrs);
+    srh = srh_hdr_at(data, end, &hdrs);
+    if (!ipv6 || !srh)
         return TC_ACT_OK;
 
-    if (eth->h_proto != bpf_htons(ETH_P_IPV6))
+    scratch = pot_scratch_get();
+    if (!scratch)
         return TC_ACT_OK;
 
-    ipv6 = IPV6_HDR_PTR;
+    // Endpoint Node when the last SID is active, otherwise Transit Node
+    __u32 endpoint = seg6_last_sid(srh) == 0;
+#if POT_CSID
+    // Unless the destination address still carries C-SIDs after the active one
+    endpoint = endpoint && !csid_has_next(&ipv6->daddr);
+#endif
+
+    POT_LAT_START(start);
+    if (parse_pot_tlv(data, end, &hdrs, scratch, endpoint, skb->ingress_ifindex) != 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to parse TLV\n");
+        pot_path_account(data, end, &hdrs, &scratch->path, skb->len, 1);
+        pot_capture_skb(skb, scratch, POT_CAP_REJECT);
+        return TC_ACT_SHOT;
+    }
+    POT_LAT_RECORD(endpoint ? POT_LAT_REMOVE : POT_LAT_UPDATE, POT_LAT_PARSE, start);
+    POT_LAT_SAVE(scratch, start);
+
+    bpf_tail_call(skb, &seg6_pot_tc_stages, POT_STAGE_WITNESS);
+    bpf_printk("[seg6_pot_tlv][-] Failed to tail call the witness stage\n");
+    return TC_ACT_SHOT;
+}
 
-    if (ip6_hdr_cb(ipv6, end) < 0)
+SEC("tc")
+int seg6_pot_tlv_i_witness(struct __sk_buff *skb)
+{
+    void *data = (void *)(long)skb->data;
+    void *end = (void *)(long)skb->data_end;
+
+    struct pot_scratch *scratch = pot_scratch_get();
+    if (!scratch)
+        return TC_ACT_SHOT;
+
+    if (update_pot_tlv(data, end, scratch) != 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to update TLV\n");
+        return TC_ACT_SHOT;
+    }
+
+    // Transit Nodes
+    if (!scratch->endpoint) {
+        bpf_printk("[seg6_pot_tlv][+] TLV updated successfully\n");
+        POT_LAT_RECORD_TOTAL(POT_LAT_UPDATE, scratch);
         return TC_ACT_OK;
+    }
 
-    switch (ipv6->nexthdr) {
-    case SRH_NEXT_HEADER:
-        srh = SRH_HDR_PTR;
+    // Endpoint Node
+    bpf_tail_call(skb, &seg6_pot_tc_stages, POT_STAGE_CHAIN);
+    bpf_printk("[seg6_pot_tlv][-] Failed to tail call the chain stage\n");
+    return TC_ACT_SHOT;
+}
 
-        if (srh_hdr_cb(srh, end) < 0)
-            return TC_ACT_OK;
+SEC("tc")
+int seg6_pot_tlv_i_chain(struct __sk_buff *skb)
+{
+    void *data = (void *)(long)skb->data;
+    void *end = (void *)(long)skb->data_end;
 
-        // SRouting Node
-        if (seg6_first_sid(srh) == 0) {
-            if (add_pot_tlv(skb) != 0) {
-                bpf_printk("[seg6_pot_tlv][-] Failed to add TLV\n");
-                return TC_ACT_SHOT;
-            }
+    struct pot_scratch *scratch = pot_scratch_get();
+    if (!scratch)
+        return TC_ACT_SHOT;
 
-            bpf_printk("[seg6_pot_tlv][+] TLV added successfully\n");
-        }
-    default:
+    int ret = chain_pot_tlv(scratch);
+    if (ret < 0)
+        return TC_ACT_SHOT;
+
+    // One keyed-hash per call, keeps every SID under the verifier limits
+    if (ret > 0) {
+        bpf_tail_call(skb, &seg6_pot_tc_stages, POT_STAGE_CHAIN);
+        bpf_printk("[seg6_pot_tlv][-] Failed to tail call the chain stage\n");
+        return TC_ACT_SHOT;
+    }
+
+    int failed = verify_pot_tlv(data, end, scratch) != 0;
+    pot_path_account(data, end, &scratch->hdrs, &scratch->path, skb->len, (__u32)failed);
+    pot_capture_skb(skb, scratch, failed ? POT_CAP_WITNESS : POT_CAP_PASS);
+    if (failed)
+        return TC_ACT_SHOT;
+
+    bpf_tail_call(skb, &seg6_pot_tc_stages, POT_STAGE_STRIP);
+    bpf_printk("[seg6_pot_tlv][-] Failed to tail call the strip stage\n");
+    return TC_ACT_SHOT;
+}
+
+SEC("tc")
+int seg6_pot_tlv_i_strip(struct __sk_buff *skb)
+{
+    struct pot_scratch *scratch = pot_scratch_get();
+    if (!scratch)
+        return TC_ACT_SHOT;
+
+    if (remove_pot_tlv_skb(skb, scratch) != 0) {
+        bpf_printk("[seg6_pot_tlv][-] Failed to remove TLV\n");
+        return TC_ACT_SHOT;
+    }
+
+    bpf_printk("[seg6_pot_tlv][+] TLV removed successfully\n");
+    POT_LAT_RECORD_TOTAL(POT_LAT_REMOVE, scratch);
+    return TC_ACT_OK;
+}
+
+SEC("tc")
+int seg6_pot_tlv(struct __sk_buff *skb)
+{
+    void *data = (void *)(long)skb->data;
+    void *end = (void *)(long)skb->data_end;
+
+    struct pot_hdrs hdrs;
+    struct srh *srh;
+
+    // Would leave without a TLV if it is SRv6
+    int parsed = parse_srv6_hdrs(data, end, &hdrs);
+    if (parsed == POT_HDRS_TOO_DEEP) {
+        bpf_printk("[seg6_pot_tlv][-] Too many options headers to find the SRH\n");
+        return TC_ACT_SHOT;
+    }
+    if (parsed < 0)
         return TC_ACT_OK;
+
+    srh = srh_hdr_at(data, end, &hdrs);
+    if (!srh)
+        return TC_ACT_OK;
+
+    // SRouting Node
+    if (seg6_first_sid(srh) == 0) {
+        struct pot_path_key path = {};
+        pot_path_hash(data, end, &hdrs, POT_PATH_HEADEND, &path);
+
+        // The TLV goes after the SID list, the offsets of the headers in front of it hold
+        int failed = add_pot_tlv(skb, &hdrs) != 0;
+        data = (void *)(long)skb->data;
+        end = (void *)(long)skb->data_end;
+        pot_path_account(data, end, &hdrs, &path, skb->len, (__u32)failed);
+
+        if (failed) {
+            bpf_printk("[seg6_pot_tlv][-] Failed to add TLV\n");
+            return TC_ACT_SHOT;
+        }
+
+        bpf_printk("[seg6_pot_tlv][+] TLV added successfully\n");
     }
 
     return TC_ACT_OK;
@@ -0,0 +1,122 @@
+import subprocess
+import secrets
+import signal
+import sys
+import time
+import argparse
+import os
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "topology", "scripts"))
+from netns_lab import run_ns, pinned_keys, valid_tlv
+
+def path_keys(loader, path):
+    """Keys of every SID of the path, the ones missing from the pinned map are created"""
+    keys = pinned_keys(loader)
+    for sid in path:
+        if sid not in keys:
+            keys[sid] = secrets.token_hex(32)
+            subprocess.run([loader, "--sid", sid, "--key", keys[sid]], stdout=subprocess.DEVNULL, check=True)
+    return [(sid, keys[sid]) for sid in path]
+
+def collect_afxdp_rate(args, segments):
+    path = PATHS[segments]
+    keys = path_keys(args.loader, path)
+    tlv = valid_tlv(args.auditor, args.label, keys).hex()
+    output_dir = os.path.join(args.output_dir, args.mode, f"segments-{segments}")
+    os.makedirs(output_dir, exist_ok=True)
+    latency_file = os.path.join(output_dir, f"latency_{args.label}.json")
+
+    engine = None
+    if args.mode == "xsk":
+        engine_cmd = [args.engine, "-i", args.iface, "-a", args.label, "-l", latency_file]
+        print(' '.join(engine_cmd))
+        engine = subprocess.Popen(run_ns(args.netns, engine_cmd))
+        time.sleep(1)
+        if engine.poll() is not None:
+            print(f"Error starting the engine. Return code: {engine.returncode}", file=sys.stderr)
+            return
+    else:
+        # Only a LATENCY=1 build has histograms to reset
+        subprocess.run([args.loader, "--latency", "--reset"], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+    collect_cmd = [sys.executable, PACKET_RATE, args.label, "--role", "egress",
+                   "--sids", ",".join(path), "--tlv", tlv,
+                   "--duration", str(args.duration), "--payload", str(args.payload), "--flows", str(args.flows),
+                   "--output-dir", output_dir]
+    try:
+        subprocess.run(collect_cmd, check=True)
+    except subprocess.CalledProcessError as e:
+        print(f"Error collecting {segments} segments. Return code: {e.returncode}", file=sys.stderr)
+    finally:
+        if engine:
+            engine.send_signal(signal.SIGINT)
+            engine.wait()
+
+    if args.mode == "kernel":
+        subprocess.run([args.loader, "--latency", "--output", latency_file], stdout=subprocess.DEVNULL)
+
+if __name__ == "__main__":
+    SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+    REPO_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+    BUILD_DIR = os.path.join(REPO_DIR, "cmd", "build")
+    PACKET_RATE = os.path.join(REPO_DIR, "tests", "packet-rate", "collect-packet-rate.py")
+    DEFAULT_SEGMENTS = [2, 4, 8]
+    DEFAULT_DURATION = 10
+    DEFAULT_PAYLOAD = 64
+    DEFAULT_FLOWS = 16
+    ALLOWED_LABELS = ["blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+
+    # Paths ending at the End.DT6 SID of r4, the 8 segments one fills the
+    # key map with 4 SIDs that only exist in the segment list
+    PATHS = {
+        2: ["2001:db8:ff:3::1", "2001:db8:ff:4::1"],
+        4: ["2001:db8:ff:1::1", "2001:db8:ff:2::1", "2001:db8:ff:3::1", "2001:db8:ff:4::1"],
+        8: ["2001:db8:fe:1::1", "2001:db8:fe:2::1", "2001:db8:fe:3::1", "2001:db8:fe:4::1",
+            "2001:db8:ff:1::1", "2001:db8:ff:2::1", "2001:db8:ff:3::1", "2001:db8:ff:4::1"],
+    }
+
+    parser = argparse.ArgumentParser(description="Collect the egress packet rate and latency of the in-kernel validator or the AF_XDP engine.")
+    parser.add_argument("label",
+                        help="Algorithm of the AFXDP=1 build loaded on the LAB.",
+                        choices=ALLOWED_LABELS)
+    parser.add_argument("-m", "--mode",
+                        default="kernel",
+                        choices=["kernel", "xsk"],
+                        help="Validate in XDP or in seg6-pot-xsk (default: kernel)")
+    parser.add_argument("-s", "--segments",
+                        type=int,
+                        nargs="+",
+                        default=DEFAULT_SEGMENTS,
+                        choices=PATHS.keys(),
+                        help=f"Segment list lengths (default: {DEFAULT_SEGMENTS})")
+    parser.add_argument("-d", "--duration",
+                        type=int,
+                        default=DEFAULT_DURATION,
+                        help=f"Duration of each test in seconds (default: {DEFAULT_DURATION})")
+    parser.add_argument("-p", "--payload",
+                        type=int,
+                        default=DEFAULT_PAYLOAD,
+                        help=f"Inner UDP payload size in bytes (default: {DEFAULT_PAYLOAD})")
+    parser.add_argument("-f", "--flows",
+                        type=int,
+                        default=DEFAULT_FLOWS,
+                        help=f"Number of flows (default: {DEFAULT_FLOWS})")
+    parser.add_argument("--netns",
+                        default="pot-r4",
+                        help="Network namespace of the egress node (default: pot-r4)")
+    parser.add_argument("--iface",
+                        default="ens5",
+                        help="Ingress interface of the egress node (default: ens5)")
+    parser.add_argument("-o", "--output-dir",
+                        default=os.path.join(SCRIPT_DIR, "results"),
+                        help="Directory to save the output files (default: script's results directory)")
+
+    args = parser.parse_args()
+    args.loader = os.path.join(BUILD_DIR, f"seg6-pot-tlv-{args.label}")
+    args.auditor = os.path.join(BUILD_DIR, "seg6-pot-audit")
+    args.engine = os.path.join(BUILD_DIR, "seg6-pot-xsk")
+
+    for segments in sorted(set(args.segments)):
+        collect_afxdp_rate(args, segments)
+
+    print("AF_XDP rate data collection complete.")
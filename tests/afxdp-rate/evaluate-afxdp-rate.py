@@ -0,0 +1,123 @@
+import os
+import re
+import sys
+import json
+import numpy as np
+import matplotlib.pyplot as plt
+
+def load_packet_rate_data(filename):
+    rate_values = []
+    try:
+        with open(filename, 'r') as f:
+            for line in f:
+                try:
+                    rate_values.append(float(line.strip()) / 1e6)
+                except ValueError:
+                    print(f"Warning: Skipping invalid line in {filename}: {line.strip()}", file=sys.stderr)
+    except FileNotFoundError:
+        return None
+    except Exception as e:
+        print(f"An error occurred reading {filename}: {e}", file=sys.stderr)
+        return None
+    return rate_values
+
+def load_total_latency(filename):
+    """p50 and p99 of the total egress latency, in microseconds"""
+    try:
+        with open(filename, 'r') as f:
+            stats = json.load(f)
+    except FileNotFoundError:
+        return None
+    except Exception as e:
+        print(f"An error occurred reading {filename}: {e}", file=sys.stderr)
+        return None
+    for stat in stats:
+        if stat["path"] == "remove" and stat["stage"] == "total" and stat["count"]:
+            return stat["p50_ns"] / 1e3, stat["p99_ns"] / 1e3
+    return None
+
+if __name__ == "__main__":
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    labels = ["blake3", "halfsiphash", "siphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+    pretty_labels = ["BLAKE3", "HalfSipHash", "SipHash", "Poly1305", "HMAC-SHA1", "HMAC-SHA256"]
+    colors = ['#55a868', '#c44e52', '#8172b3', '#ccb974', '#64b5cd', '#8c8c8c']
+    modes = {"kernel": ("XDP", '-'), "xsk": ("AF_XDP", '--')}
+
+    rate_series = []
+    latency_series = []
+    segment_counts = set()
+    for i, label in enumerate(labels):
+        for mode, (mode_name, style) in modes.items():
+            mode_dir = os.path.join(results_dir, mode)
+            if not os.path.isdir(mode_dir):
+                continue
+            rates = []
+            latencies = []
+            for entry in os.listdir(mode_dir):
+                match = re.fullmatch(r"segments-(\d+)", entry)
+                if not match:
+                    continue
+                segments = int(match.group(1))
+                data_file = os.path.join(mode_dir, entry, f"packet_rate_data_egress_{label}.txt")
+                data = load_packet_rate_data(data_file)
+                if data:
+                    print(f"Loaded {len(data)} values from {data_file}")
+                    rates.append((segments, np.median(data)))
+                latency = load_total_latency(os.path.join(mode_dir, entry, f"latency_{label}.json"))
+                if latency:
+                    latencies.append((segments, latency))
+            name = f"{pretty_labels[i]} {mode_name}"
+            if rates:
+                rates.sort()
+                segment_counts.update(segments for segments, _ in rates)
+                rate_series.append((name, colors[i], style, rates))
+            if latencies:
+                latencies.sort()
+                latency_series.append((name, colors[i], style, latencies))
+
+    if not rate_series:
+        print(f"Error: No valid packet rate data found in {results_dir}. Cannot generate plot.", file=sys.stderr)
+        sys.exit(1)
+
+    print("Generating line plots...")
+    fig, (rate_ax, latency_ax) = plt.subplots(1, 2, figsize=(14, 6))
+
+    for name, color, style, points in rate_series:
+        x = [segments for segments, _ in points]
+        y = [rate for _, rate in points]
+        rate_ax.plot(x, y, marker='o', color=color, linestyle=style, label=name, linewidth=2)
+        for segments, rate in points:
+            rate_ax.annotate(f"{rate:.2f}", (segments, rate), textcoords="offset points", xytext=(0, 6),
+                             ha='center', fontsize=8)
+
+    # Only LATENCY=1 builds and the engine's -l report have histograms
+    for name, color, style, points in latency_series:
+        x = [segments for segments, _ in points]
+        latency_ax.plot(x, [p99 for _, (_, p99) in points], marker='o', color=color, linestyle=style,
+                        label=f"{name} p99", linewidth=2)
+        latency_ax.plot(x, [p50 for _, (p50, _) in points], marker='.', color=color, linestyle=style,
+                        alpha=0.5, label=f"{name} p50", linewidth=1)
+
+    for ax in (rate_ax, latency_ax):
+        ax.set_xticks(sorted(segment_counts))
+        ax.set_xlabel("Segments", fontsize=12)
+        ax.grid(True, linestyle='--', linewidth=0.5, alpha=0.7)
+    rate_ax.set_ylabel("Egress Packet Rate (Mpps, median)", fontsize=12)
+    rate_ax.legend()
+    latency_ax.set_ylabel("Validation Latency (µs, slot upper bound)", fontsize=12)
+    latency_ax.set_yscale('log')
+    if latency_series:
+        latency_ax.legend()
+    fig.suptitle("In-kernel vs AF_XDP Egress Validation", fontsize=16, fontweight='bold')
+    fig.tight_layout()
+
+    try:
+        plot_save_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, "afxdp-rate.png")
+        plt.savefig(plot_save_path, dpi=300)
+        print(f"Line plots saved to {plot_save_path}")
+    except Exception as e:
+        print(f"Error saving plot: {e}", file=sys.stderr)
+
+    print("Evaluation complete.")
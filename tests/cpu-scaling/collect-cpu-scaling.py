@@ -0,0 +1,66 @@
+import subprocess
+import sys
+import argparse
+import os
+
+def setup_lab(netns_script, label, cpus):
+    env = dict(os.environ, STEER_CPUS=f"0-{cpus - 1}")
+    print(f"Loading {label} steered over {cpus} CPU(s)...")
+    subprocess.run([netns_script, "setup", label], env=env, check=True)
+
+def collect_cpu_scaling(netns_script, collector, label, cpu_counts, flows, duration, output_dir):
+    for cpus in cpu_counts:
+        try:
+            setup_lab(netns_script, label, cpus)
+        except subprocess.CalledProcessError as e:
+            print(f"Error loading {label} on {cpus} CPU(s). Return code: {e.returncode}", file=sys.stderr)
+            return
+
+        # One packet-rate dataset per CPU count, e.g. ./results/cpus-4/packet_rate_data_transit_blake3.txt
+        # The transit role validates real packets without a pre-computed TLV
+        cmd = [sys.executable, collector, label, "--role", "transit", "--flows", str(flows),
+               "--duration", str(duration), "-o", os.path.join(output_dir, f"cpus-{cpus}")]
+        print(' '.join(cmd))
+        result = subprocess.run(cmd)
+        if result.returncode != 0:
+            print(f"Error collecting {cpus} CPU(s). Return code: {result.returncode}", file=sys.stderr)
+
+    subprocess.run([netns_script, "cleanup"])
+    print("CPU scaling data collection complete.")
+
+if __name__ == "__main__":
+    SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+    REPO_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+    DEFAULT_CPUS = [1, 2, 4, 8]
+    DEFAULT_FLOWS = 256
+    DEFAULT_DURATION = 10
+    ALLOWED_LABELS = ["blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+
+    parser = argparse.ArgumentParser(description="Collect the validated packet rate of one algorithm for each number of steering CPUs.")
+    parser.add_argument("label",
+                        help="Algorithm under test.",
+                        choices=ALLOWED_LABELS)
+    parser.add_argument("-c", "--cpus",
+                        type=int,
+                        nargs="+",
+                        default=DEFAULT_CPUS,
+                        help=f"Numbers of CPUs to steer to, starting at CPU 0 (default: {DEFAULT_CPUS})")
+    parser.add_argument("-f", "--flows",
+                        type=int,
+                        default=DEFAULT_FLOWS,
+                        help=f"Number of inner flows (default: {DEFAULT_FLOWS})")
+    parser.add_argument("-d", "--duration",
+                        type=int,
+                        default=DEFAULT_DURATION,
+                        help=f"Duration of each test in seconds (default: {DEFAULT_DURATION})")
+    parser.add_argument("-o", "--output-dir",
+                        default=os.path.join(SCRIPT_DIR, "results"),
+                        help="Directory to save the output files (default: script's results directory)")
+
+    args = parser.parse_args()
+
+    netns_script = os.path.join(REPO_DIR, "topology", "scripts", "netns.sh")
+    collector = os.path.join(REPO_DIR, "tests", "packet-rate", "collect-packet-rate.py")
+
+    collect_cpu_scaling(netns_script, collector, args.label, sorted(set(args.cpus)),
+                        args.flows, args.duration, args.output_dir)
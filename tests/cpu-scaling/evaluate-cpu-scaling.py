@@ -0,0 +1,81 @@
+import os
+import re
+import sys
+import numpy as np
+import matplotlib.pyplot as plt
+
+def load_packet_rate_data(filename):
+    rate_values = []
+    try:
+        with open(filename, 'r') as f:
+            for line in f:
+                try:
+                    rate_values.append(float(line.strip()) / 1e6)
+                except ValueError:
+                    print(f"Warning: Skipping invalid line in {filename}: {line.strip()}", file=sys.stderr)
+    except FileNotFoundError:
+        return None
+    except Exception as e:
+        print(f"An error occurred reading {filename}: {e}", file=sys.stderr)
+        return None
+    return rate_values
+
+if __name__ == "__main__":
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    labels = ["blake3", "halfsiphash", "siphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+    pretty_labels = ["BLAKE3", "HalfSipHash", "SipHash", "Poly1305", "HMAC-SHA1", "HMAC-SHA256"]
+    colors = ['#55a868', '#c44e52', '#8172b3', '#ccb974', '#64b5cd', '#8c8c8c']
+
+    cpu_counts = []
+    if os.path.isdir(results_dir):
+        for entry in os.listdir(results_dir):
+            match = re.fullmatch(r"cpus-(\d+)", entry)
+            if match:
+                cpu_counts.append(int(match.group(1)))
+    cpu_counts.sort()
+
+    series = []
+    for i, label in enumerate(labels):
+        points = []
+        for cpus in cpu_counts:
+            data_file = os.path.join(results_dir, f"cpus-{cpus}", f"packet_rate_data_transit_{label}.txt")
+            data = load_packet_rate_data(data_file)
+            if data:
+                print(f"Loaded {len(data)} values from {data_file}")
+                points.append((cpus, np.median(data)))
+        if points:
+            series.append((pretty_labels[i], colors[i], points))
+
+    if not series:
+        print(f"Error: No valid CPU scaling data found in {results_dir}. Cannot generate plot.", file=sys.stderr)
+        sys.exit(1)
+
+    print("Generating line plot...")
+    plt.figure(figsize=(10, 6))
+
+    for name, color, points in series:
+        x = [cpus for cpus, _ in points]
+        y = [rate for _, rate in points]
+        plt.plot(x, y, marker='o', color=color, label=name, linewidth=2)
+        for cpus, rate in points:
+            plt.annotate(f"{rate:.2f}", (cpus, rate), textcoords="offset points", xytext=(0, 6),
+                         ha='center', fontsize=8)
+
+    plt.xticks(cpu_counts)
+    plt.xlabel("Steering CPUs", fontsize=12)
+    plt.ylabel("Validated Packet Rate (Mpps, median)", fontsize=12)
+    plt.title("Transit Packet Rate Scaling With CPU Steering", fontsize=16, fontweight='bold')
+    plt.legend()
+    plt.grid(True, linestyle='--', linewidth=0.5, alpha=0.7)
+    plt.tight_layout()
+
+    try:
+        plot_save_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, "cpu-scaling.png")
+        plt.savefig(plot_save_path, dpi=300)
+        print(f"Line plot saved to {plot_save_path}")
+    except Exception as e:
+        print(f"Error saving plot: {e}", file=sys.stderr)
+
+    print("Evaluation complete.")
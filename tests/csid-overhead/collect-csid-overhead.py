@@ -0,0 +1,55 @@
+import subprocess
+import shutil
+import sys
+import glob
+import argparse
+import os
+
+def build_objects(repo_dir, build_dir, dest, csid):
+    """Builds every algorithm object, with CSID=1 or without, and keeps a copy in dest"""
+    command = ["make", "-C", repo_dir, "default_name", "all_objects"]
+    if csid:
+        command.append("CSID=1")
+    print(' '.join(command))
+    subprocess.run(command, check=True)
+
+    os.makedirs(dest, exist_ok=True)
+    objects = []
+    for obj in sorted(glob.glob(os.path.join(build_dir, "seg6_pot_tlv_*.o"))):
+        objects.append(shutil.copy(obj, dest))
+    return objects
+
+def run_bench(loader, output_filename, objects, csid):
+    command = [loader, "--test-run-bench", output_filename]
+    if csid:
+        command.append("--csid")
+    print(' '.join(command + objects))
+    subprocess.run(command + objects, check=True)
+
+if __name__ == "__main__":
+    SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+    REPO_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+    BUILD_DIR = os.path.join(REPO_DIR, "cmd", "build")
+
+    parser = argparse.ArgumentParser(description="Time the datapath on uncompressed and C-SID packets of the same path with BPF_PROG_TEST_RUN.")
+    parser.add_argument("-o", "--output-dir",
+                        default=os.path.join(SCRIPT_DIR, "results"),
+                        help="Directory to save the output files (default: script's results directory)")
+
+    args = parser.parse_args()
+    if os.geteuid() != 0:
+        print("Error: BPF_PROG_TEST_RUN requires root.", file=sys.stderr)
+        sys.exit(1)
+
+    objects_dir = os.path.join(args.output_dir, "objects")
+    loader = os.path.join(BUILD_DIR, "seg6-pot-tlv")
+
+    # Both builds reset cmd/build, every object set is copied out of it first
+    for label, csid in [("srh", False), ("csid", True)]:
+        objects = build_objects(REPO_DIR, BUILD_DIR, os.path.join(objects_dir, label), csid)
+        if not objects:
+            print(f"Error: no objects built for {label}.", file=sys.stderr)
+            sys.exit(1)
+        run_bench(loader, os.path.join(args.output_dir, f"test_run_{label}.json"), objects, csid)
+
+    print("C-SID data collection complete.")
@@ -0,0 +1,97 @@
+import os
+import sys
+import json
+import math
+import numpy as np
+import matplotlib.pyplot as plt
+
+# Wire length of the PoT TLV per algorithm, 16 bytes of header and nonce plus the witness
+TLV_LEN = {"blake3": 48, "siphash": 24, "halfsiphash": 24, "poly1305": 32, "hmac-sha1": 40, "hmac-sha256": 48}
+SRH_FIXED = 8
+SID_LEN = 16
+CSID_PER_CONTAINER = 6  # F3216
+MAX_SIDS = 8  # SRH_MAX_ALLOWED_SEGMENTS
+MAX_CSIDS = 16  # SEG6_MAX_KEYS of a CSID=1 build
+CASES = ["headend", "transit", "egress-pass", "egress-drop"]
+
+def srh_overhead(hops, tlv_len, csid):
+    """SRH and PoT TLV bytes carried by a packet of a path of hops SIDs"""
+    segments = math.ceil(hops / CSID_PER_CONTAINER) if csid else hops
+    return SRH_FIXED + SID_LEN * segments + tlv_len
+
+def load_bench(filename):
+    results = {}
+    try:
+        with open(filename, 'r') as f:
+            for r in json.load(f):
+                if r.get("error"):
+                    print(f"Warning: {r['object']} {r['case']} failed: {r['error']}", file=sys.stderr)
+                    continue
+                algo = os.path.basename(r["object"]).removeprefix("seg6_pot_tlv_").removesuffix(".o")
+                results[(algo, r["case"])] = r["mean_ns"]
+    except FileNotFoundError:
+        return None
+    except Exception as e:
+        print(f"An error occurred reading {filename}: {e}", file=sys.stderr)
+        return None
+    return results
+
+if __name__ == "__main__":
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    srh = load_bench(os.path.join(results_dir, "test_run_srh.json"))
+    csid = load_bench(os.path.join(results_dir, "test_run_csid.json"))
+    if not srh or not csid:
+        print(f"Error: No valid test run data found in {results_dir}. Cannot generate plot.", file=sys.stderr)
+        sys.exit(1)
+
+    algos = sorted({algo for algo, _ in srh} & {algo for algo, _ in csid})
+
+    print("Header overhead in bytes (SRH + PoT TLV):")
+    print("algo         hops  srh  csid")
+    for algo in algos:
+        for hops in (3, 6, 8):
+            print(f"{algo:<12} {hops:>4} {srh_overhead(hops, TLV_LEN[algo], False):>4} {srh_overhead(hops, TLV_LEN[algo], True):>5}")
+
+    print("Generating plots...")
+    fig, (ax_bytes, ax_ns) = plt.subplots(1, 2, figsize=(16, 6))
+
+    colors = plt.cm.tab10(np.linspace(0, 1, 10))
+    for i, algo in enumerate(algos):
+        hops = np.arange(1, MAX_CSIDS + 1)
+        plain = [srh_overhead(h, TLV_LEN[algo], False) if h <= MAX_SIDS else np.nan for h in hops]
+        compressed = [srh_overhead(h, TLV_LEN[algo], True) for h in hops]
+        ax_bytes.plot(hops, plain, marker='o', color=colors[i], label=f"{algo} SRH")
+        ax_bytes.plot(hops, compressed, marker='s', linestyle='--', color=colors[i], label=f"{algo} C-SID")
+    ax_bytes.set_xlabel("SIDs in the Path", fontsize=12)
+    ax_bytes.set_ylabel("SRH + PoT TLV (bytes)", fontsize=12)
+    ax_bytes.set_title("Header Overhead per Packet", fontsize=14, fontweight='bold')
+    ax_bytes.legend(fontsize=8, ncol=2)
+    ax_bytes.grid(linestyle='--', linewidth=0.5, alpha=0.7)
+
+    x = np.arange(len(CASES))
+    width = 0.8 / (2 * len(algos))
+    for i, algo in enumerate(algos):
+        for j, (label, data, hatch) in enumerate([("SRH", srh, None), ("C-SID", csid, '//')]):
+            values = [data.get((algo, case), np.nan) for case in CASES]
+            offset = (2 * i + j - len(algos)) * width + width / 2
+            ax_ns.bar(x + offset, values, width, color=colors[i], hatch=hatch, edgecolor='black',
+                      label=f"{algo} {label}")
+    ax_ns.set_xticks(x, CASES)
+    ax_ns.set_ylabel("Mean Time per Packet (ns)", fontsize=12)
+    ax_ns.set_title("Datapath Cost, 3 SIDs (BPF_PROG_TEST_RUN)", fontsize=14, fontweight='bold')
+    ax_ns.legend(fontsize=8, ncol=2)
+    ax_ns.grid(axis='y', linestyle='--', linewidth=0.5, alpha=0.7)
+
+    fig.suptitle("Compressed SIDs against Uncompressed SRH", fontsize=16, fontweight='bold')
+    fig.tight_layout()
+
+    try:
+        plot_save_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, "csid-overhead.png")
+        plt.savefig(plot_save_path, dpi=300)
+        print(f"Plot saved to {plot_save_path}")
+    except Exception as e:
+        print(f"Error saving plot: {e}", file=sys.stderr)
+
+    print("Evaluation complete.")
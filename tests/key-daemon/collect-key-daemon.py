@@ -0,0 +1,140 @@
+import subprocess
+import secrets
+import signal
+import socket
+import struct
+import sys
+import time
+import argparse
+import os
+import ipaddress
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "topology", "scripts"))
+from netns_lab import pinned_keys
+
+OP_KEY_SET = 1
+
+def key_set(sid, key):
+    return struct.pack("!B", OP_KEY_SET) + ipaddress.IPv6Address(sid).packed + key
+
+def recv_exact(conn, n):
+    data = b""
+    while len(data) < n:
+        chunk = conn.recv(n - len(data))
+        if not chunk:
+            raise ConnectionError("daemon closed the connection")
+        data += chunk
+    return data
+
+def send_batch(conn, ops):
+    """Sends one batch and waits for its reply, returns the apply time reported by the daemon"""
+    frame = b"".join(ops)
+    conn.sendall(struct.pack("!I", len(frame)) + frame)
+    length = struct.unpack("!I", recv_exact(conn, 4))[0]
+    reply = recv_exact(conn, length)
+    status, applied, apply_ns = struct.unpack_from("!B3xIQ", reply)
+    if status != 0:
+        raise RuntimeError(f"batch rejected: {reply[16:].decode(errors='replace')}")
+    return applied, apply_ns
+
+def collect_key_daemon(args, conn, sids, batch):
+    """Rotates the keys of sids at args.rate updates per second, batch updates per frame"""
+    period = batch / args.rate
+    deadline = time.perf_counter() + args.duration
+    next_send = time.perf_counter()
+    rtt_values, apply_values = [], []
+    updates = 0
+
+    start = time.perf_counter()
+    while time.perf_counter() < deadline:
+        ops = [key_set(sids[(updates + i) % len(sids)], secrets.token_bytes(32)) for i in range(batch)]
+
+        sent = time.perf_counter()
+        applied, apply_ns = send_batch(conn, ops)
+        rtt_values.append((time.perf_counter() - sent) * 1e9)
+        apply_values.append(apply_ns)
+        updates += applied
+
+        # Paced, a slow daemon lowers the achieved rate instead of queueing
+        next_send += period
+        pause = next_send - time.perf_counter()
+        if pause > 0:
+            time.sleep(pause)
+        else:
+            next_send = time.perf_counter()
+    elapsed = time.perf_counter() - start
+
+    print(f"Batch of {batch}: {updates / elapsed:.0f} updates/s over {len(apply_values)} batches, "
+          f"median apply {sorted(apply_values)[len(apply_values) // 2] / 1e3:.1f} us")
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    output_filename = os.path.join(args.output_dir, f"key_daemon_batch-{batch}.txt")
+    print(f"Saving {len(apply_values)} samples to {output_filename}...")
+    with open(output_filename, 'w') as f:
+        f.write(f"# rate {updates / elapsed}\n")
+        for rtt, apply_ns in zip(rtt_values, apply_values):
+            f.write(f"{rtt} {apply_ns}\n")
+
+if __name__ == "__main__":
+    SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+    REPO_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+    BUILD_DIR = os.path.join(REPO_DIR, "cmd", "build")
+    ALLOWED_LABELS = ["blake3", "halfsiphash", "siphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+    DEFAULT_BATCHES = [1, 10, 100, 1000]
+    DEFAULT_RATE = 10000
+    DEFAULT_DURATION = 10
+    DEFAULT_SOCKET = "/run/seg6-pot-tlv.sock"
+
+    parser = argparse.ArgumentParser(description="Drive the key daemon like a controller and collect its apply latency.")
+    parser.add_argument("label",
+                        help="Algorithm of the build loaded on the LAB.",
+                        choices=ALLOWED_LABELS)
+    parser.add_argument("-b", "--batches",
+                        nargs="+",
+                        type=int,
+                        default=DEFAULT_BATCHES,
+                        help=f"Key updates per batch (default: {DEFAULT_BATCHES})")
+    parser.add_argument("-r", "--rate",
+                        type=int,
+                        default=DEFAULT_RATE,
+                        help=f"Key updates per second (default: {DEFAULT_RATE})")
+    parser.add_argument("-d", "--duration",
+                        type=int,
+                        default=DEFAULT_DURATION,
+                        help=f"Duration of each batch size in seconds (default: {DEFAULT_DURATION})")
+    parser.add_argument("-s", "--socket",
+                        default=DEFAULT_SOCKET,
+                        help=f"Unix socket of the daemon (default: {DEFAULT_SOCKET})")
+    parser.add_argument("-o", "--output-dir",
+                        default=os.path.join(SCRIPT_DIR, "results"),
+                        help="Directory to save the output files (default: script's results directory)")
+
+    args = parser.parse_args()
+    loader = os.path.join(BUILD_DIR, f"seg6-pot-tlv-{args.label}")
+
+    # Rotated keys break the traffic of the LAB, the original ones are put back at the end
+    original = pinned_keys(loader)
+    if not original:
+        print("Error: no keys pinned, set up the LAB first.", file=sys.stderr)
+        sys.exit(1)
+    sids = sorted(original)
+
+    daemon = subprocess.Popen([loader, "--daemon", args.socket])
+    try:
+        for _ in range(50):
+            if os.path.exists(args.socket):
+                break
+            time.sleep(0.1)
+
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conn:
+            conn.connect(args.socket)
+            try:
+                for batch in args.batches:
+                    collect_key_daemon(args, conn, sids, batch)
+            finally:
+                send_batch(conn, [key_set(sid, bytes.fromhex(key)) for sid, key in original.items()])
+    finally:
+        daemon.send_signal(signal.SIGINT)
+        daemon.wait()
+
+    print("Key daemon data collection complete.")
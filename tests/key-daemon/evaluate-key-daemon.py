@@ -0,0 +1,88 @@
+import os
+import re
+import sys
+import numpy as np
+import matplotlib.pyplot as plt
+
+def load_daemon_data(filename):
+    rate, rtt_values, apply_values = None, [], []
+    try:
+        with open(filename, 'r') as f:
+            for line in f:
+                if line.startswith("# rate "):
+                    rate = float(line.split()[2])
+                    continue
+                try:
+                    rtt, apply_ns = line.split()
+                    rtt_values.append(float(rtt))
+                    apply_values.append(float(apply_ns))
+                except ValueError:
+                    print(f"Warning: Skipping invalid line in {filename}: {line.strip()}", file=sys.stderr)
+    except FileNotFoundError:
+        return None
+    except Exception as e:
+        print(f"An error occurred reading {filename}: {e}", file=sys.stderr)
+        return None
+    return rate, rtt_values, apply_values
+
+if __name__ == "__main__":
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    points = {}
+    if os.path.isdir(results_dir):
+        for entry in os.listdir(results_dir):
+            match = re.fullmatch(r"key_daemon_batch-(\d+)\.txt", entry)
+            if not match:
+                continue
+            data_file = os.path.join(results_dir, entry)
+            data = load_daemon_data(data_file)
+            if data and data[2]:
+                print(f"Loaded {len(data[2])} batches from {data_file}")
+                points[int(match.group(1))] = data
+
+    if not points:
+        print(f"Error: No valid key daemon data found in {results_dir}. Cannot generate plot.", file=sys.stderr)
+        sys.exit(1)
+
+    batches = sorted(points)
+    x = np.arange(len(batches))
+
+    print("Generating plots...")
+    fig, (ax_lat, ax_rate) = plt.subplots(1, 2, figsize=(14, 6))
+
+    for i, (name, idx, color) in enumerate([("Apply (daemon)", 2, '#4c72b0'), ("Round trip (controller)", 1, '#dd8452')]):
+        p50 = [np.percentile(points[b][idx], 50) / 1e3 for b in batches]
+        p99 = [np.percentile(points[b][idx], 99) / 1e3 for b in batches]
+        offset = (i - 0.5) * 0.4
+        ax_lat.bar(x + offset, p50, 0.4, color=color, edgecolor='black', label=f"{name} p50")
+        ax_lat.scatter(x + offset, p99, color='black', marker='_', s=200, zorder=3,
+                       label="p99" if i == 0 else None)
+    ax_lat.set_xticks(x, [str(b) for b in batches])
+    ax_lat.set_xlabel("Key Updates per Batch", fontsize=12)
+    ax_lat.set_ylabel("Latency per Batch (us)", fontsize=12)
+    ax_lat.set_title("Batch Latency", fontsize=14, fontweight='bold')
+    ax_lat.legend()
+    ax_lat.grid(axis='y', linestyle='--', linewidth=0.5, alpha=0.7)
+
+    rates = [(points[b][0] or 0) / 1e3 for b in batches]
+    bars = ax_rate.bar(x, rates, 0.6, color='#55a868', edgecolor='black')
+    for bar, rate in zip(bars, rates):
+        ax_rate.text(bar.get_x() + bar.get_width() / 2, rate, f"{rate:.1f}k", ha='center', va='bottom', fontsize=9)
+    ax_rate.set_xticks(x, [str(b) for b in batches])
+    ax_rate.set_xlabel("Key Updates per Batch", fontsize=12)
+    ax_rate.set_ylabel("Achieved Key Updates per Second (thousands)", fontsize=12)
+    ax_rate.set_title("Achieved Update Rate", fontsize=14, fontweight='bold')
+    ax_rate.grid(axis='y', linestyle='--', linewidth=0.5, alpha=0.7)
+
+    fig.suptitle("Key Daemon Batched Updates", fontsize=16, fontweight='bold')
+    fig.tight_layout()
+
+    try:
+        plot_save_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, "key-daemon.png")
+        plt.savefig(plot_save_path, dpi=300)
+        print(f"Plot saved to {plot_save_path}")
+    except Exception as e:
+        print(f"Error saving plot: {e}", file=sys.stderr)
+
+    print("Evaluation complete.")
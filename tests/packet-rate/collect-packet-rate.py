@@ -0,0 +1,146 @@
+import subprocess
+import sys
+import time
+import argparse
+import os
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "topology", "scripts"))
+from netns_lab import run_ns, link_info
+
+def read_counter(counter):
+    netns, iface, direction = counter
+    return link_info(netns, iface)["stats64"][direction]["packets"]
+
+def parse_counter(spec):
+    parts = spec.split(":")
+    if len(parts) != 3 or parts[2] not in ("rx", "tx"):
+        raise argparse.ArgumentTypeError(f"counter must be <netns>:<iface>:<rx|tx>, got {spec}")
+    return tuple(parts)
+
+def collect_packet_rate(pktgen_cmd, counter, duration, interval=0.1, output_filename="packet_rate_data.txt"):
+    rate_values = []
+
+    print(' '.join(pktgen_cmd))
+    process = subprocess.Popen(pktgen_cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+
+    try:
+        # Skip the ramp-up interval
+        time.sleep(interval)
+        last_count = read_counter(counter)
+        last_time = time.monotonic()
+
+        while process.poll() is None:
+            time.sleep(interval)
+            count = read_counter(counter)
+            now = time.monotonic()
+
+            # The generator may stop in the middle of this interval
+            if process.poll() is not None:
+                break
+
+            pps = (count - last_count) / (now - last_time)
+            rate_values.append(pps)
+            print(f"Interval {len(rate_values)}: {pps / 1e6:.3f} Mpps")
+            last_count, last_time = count, now
+    except subprocess.CalledProcessError as e:
+        print(f"Error reading counter {':'.join(counter)}: {e.stderr}", file=sys.stderr)
+        process.kill()
+
+    stdout, _ = process.communicate()
+    print(stdout.strip())
+    if process.returncode != 0:
+        print(f"Error running the packet generator. Return code: {process.returncode}", file=sys.stderr)
+
+    if not rate_values:
+        print("No packet rate values collected.", file=sys.stderr)
+        return
+
+    output_dir = os.path.dirname(output_filename)
+    if output_dir and not os.path.exists(output_dir):
+        os.makedirs(output_dir)
+
+    print(f"\nSaving {len(rate_values)} packet rate values to {output_filename}...")
+    with open(output_filename, 'w') as f:
+        for val in rate_values:
+            f.write(f"{val}\n")
+    print("Packet rate data collection complete.")
+
+if __name__ == "__main__":
+    REPO_DIR = os.path.abspath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+    DEFAULT_PKTGEN = os.path.join(REPO_DIR, "cmd", "build", "seg6-pot-pktgen")
+    DEFAULT_DURATION = 10
+    DEFAULT_PAYLOAD = 64
+    DEFAULT_FLOWS = 16
+    ALLOWED_LABELS = ["baseline", "blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+
+    # Defaults for the network namespace LAB: the generator takes the place of the
+    # previous hop and the forwarded packets are counted on the node under test
+    ROLES = {
+        "headend": {"netns": "pot-h1", "iface": "ens4", "dut": ("pot-r1", "ens4"), "counter": "pot-r1:ens5:tx"},
+        "transit": {"netns": "pot-r1", "iface": "ens5", "dut": ("pot-r2", "ens4"), "counter": "pot-r2:ens5:tx"},
+        "egress":  {"netns": "pot-r3", "iface": "ens5", "dut": ("pot-r4", "ens5"), "counter": "pot-r4:ens6:tx"},
+    }
+
+    parser = argparse.ArgumentParser(description="Collect the packet rate of one PoT role and save it to a labeled file.")
+    parser.add_argument("label",
+                        help="Label for the dataset.",
+                        choices=ALLOWED_LABELS)
+    parser.add_argument("-r", "--role",
+                        default="transit",
+                        choices=ROLES.keys(),
+                        help="Role under test (default: transit)")
+    parser.add_argument("-d", "--duration",
+                        type=int,
+                        default=DEFAULT_DURATION,
+                        help=f"Duration of the test in seconds (default: {DEFAULT_DURATION})")
+    parser.add_argument("-p", "--payload",
+                        type=int,
+                        default=DEFAULT_PAYLOAD,
+                        help=f"Inner UDP payload size in bytes (default: {DEFAULT_PAYLOAD})")
+    parser.add_argument("-f", "--flows",
+                        type=int,
+                        default=DEFAULT_FLOWS,
+                        help=f"Number of flows (default: {DEFAULT_FLOWS})")
+    parser.add_argument("-s", "--sids",
+                        help="Segment list in path order (default: the LAB path)")
+    parser.add_argument("--tlv",
+                        help="Pre-insert this TLV (hex), e.g. captured from a valid path to exercise the egress strip")
+    parser.add_argument("--netns",
+                        help="Network namespace of the generator (default: from the role)")
+    parser.add_argument("--iface",
+                        help="Transmit interface of the generator (default: from the role)")
+    parser.add_argument("--dst-mac",
+                        help="MAC of the ingress interface of the node under test (default: from the role)")
+    parser.add_argument("--counter",
+                        type=parse_counter,
+                        help="Packets counted as processed, <netns>:<iface>:<rx|tx> (default: from the role)")
+    parser.add_argument("--pktgen",
+                        default=DEFAULT_PKTGEN,
+                        help=f"Packet generator binary (default: {DEFAULT_PKTGEN})")
+    parser.add_argument("-o", "--output-dir",
+                        default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "results"),
+                        help="Directory to save the output file (default: script's results directory)")
+
+    args = parser.parse_args()
+    role = ROLES[args.role]
+
+    netns = args.netns if args.netns is not None else role["netns"]
+    iface = args.iface or role["iface"]
+    counter = args.counter or parse_counter(role["counter"])
+    dst_mac = args.dst_mac or link_info(*role["dut"])["address"]
+
+    # The baseline runs without programs attached, so its packets carry no TLV
+    algo = "" if args.label == "baseline" else args.label
+
+    pktgen_cmd = [args.pktgen, "--iface", iface, "--dst-mac", dst_mac, "--role", args.role,
+                  "--duration", f"{args.duration}s", "--payload", str(args.payload),
+                  "--flows", str(args.flows), "--algo", algo]
+    if args.sids:
+        pktgen_cmd += ["--sids", args.sids]
+    if args.tlv:
+        pktgen_cmd += ["--tlv", args.tlv]
+
+    output_filename = f"packet_rate_data_{args.role}_{args.label}.txt"
+    output_path = os.path.join(args.output_dir, output_filename)
+
+    collect_packet_rate(run_ns(netns, pktgen_cmd), counter, args.duration, output_filename=output_path)
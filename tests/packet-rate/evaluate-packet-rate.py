@@ -0,0 +1,75 @@
+import os
+import sys
+import numpy as np
+import matplotlib.pyplot as plt
+
+def load_packet_rate_data(filename):
+    rate_values = []
+    try:
+        with open(filename, 'r') as f:
+            for line in f:
+                try:
+                    rate_values.append(float(line.strip()) / 1e6)
+                except ValueError:
+                    print(f"Warning: Skipping invalid line in {filename}: {line.strip()}", file=sys.stderr)
+    except FileNotFoundError:
+        return None
+    except Exception as e:
+        print(f"An error occurred reading {filename}: {e}", file=sys.stderr)
+        return None
+    return rate_values
+
+if __name__ == "__main__":
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    roles = ["headend", "transit", "egress"]
+    labels = ["baseline", "blake3", "halfsiphash", "siphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+    pretty_labels = ["SRv6", "BLAKE3", "HalfSipHash", "SipHash", "Poly1305", "HMAC-SHA1", "HMAC-SHA256"]
+    colors = ['#4c72b0', '#55a868', '#c44e52', '#8172b3', '#ccb974', '#64b5cd', '#8c8c8c']
+
+    datasets = {}
+    for role in roles:
+        for i, label in enumerate(labels):
+            data_file = os.path.join(results_dir, f"packet_rate_data_{role}_{label}.txt")
+            data = load_packet_rate_data(data_file)
+            if data:
+                print(f"Loaded {len(data)} values from {data_file}")
+                datasets.setdefault(role, []).append((pretty_labels[i], colors[i], data))
+
+    if not datasets:
+        print(f"Error: No valid packet rate data found in {results_dir}. Cannot generate plot.", file=sys.stderr)
+        sys.exit(1)
+
+    print("Generating box plots...")
+    fig, axes = plt.subplots(1, len(datasets), figsize=(6 * len(datasets), 6), squeeze=False)
+
+    for ax, (role, series) in zip(axes[0], datasets.items()):
+        box = ax.boxplot([data for _, _, data in series], patch_artist=True,
+                         labels=[name for name, _, _ in series], showfliers=False)
+        for patch, (_, color, _) in zip(box['boxes'], series):
+            patch.set_facecolor(color)
+            patch.set_alpha(0.8)
+
+        y_min, y_max = ax.get_ylim()
+        y_offset = (y_max - y_min) * 0.02
+        for i, (median_line, (_, _, data)) in enumerate(zip(box['medians'], series), start=1):
+            ax.text(i, median_line.get_ydata()[0] + y_offset, f"{np.median(data):.2f}",
+                    ha='center', va='bottom', fontsize=9, fontweight='bold')
+
+        ax.set_title(role.capitalize(), fontsize=14, fontweight='bold')
+        ax.set_ylabel("Packet Rate (Mpps)", fontsize=12)
+        ax.tick_params(axis='x', labelrotation=30)
+        ax.grid(True, axis='y', linestyle='--', linewidth=0.5, alpha=0.7)
+
+    fig.suptitle("Packet Rate For Each PoT Role And Crypto Algorithm", fontsize=16, fontweight='bold')
+    plt.tight_layout()
+
+    try:
+        plot_save_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, "packet-rate.png")
+        plt.savefig(plot_save_path, dpi=300)
+        print(f"Box plot saved to {plot_save_path}")
+    except Exception as e:
+        print(f"Error saving plot: {e}", file=sys.stderr)
+
+    print("Evaluation complete.")
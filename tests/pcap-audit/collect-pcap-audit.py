@@ -0,0 +1,114 @@
+import subprocess
+import sys
+import argparse
+import os
+import time
+
+READ_CHUNK = 8 << 20
+
+def drop_caches():
+    subprocess.run(["sync"], check=True)
+    with open("/proc/sys/vm/drop_caches", "w") as f:
+        f.write("3\n")
+
+def read_rate(capture, cold):
+    if cold:
+        drop_caches()
+    start = time.monotonic()
+    with open(capture, "rb", buffering=0) as f:
+        while f.read(READ_CHUNK):
+            pass
+    return os.path.getsize(capture) / (time.monotonic() - start)
+
+def audit_rate(auditor, label, keys, capture, threads, cold):
+    if cold:
+        drop_caches()
+    cmd = [auditor, "-a", label, "-k", keys, "-j", str(threads), "-l", "0", capture]
+    start = time.monotonic()
+    result = subprocess.run(cmd, stdout=subprocess.DEVNULL)
+    elapsed = time.monotonic() - start
+
+    # Exits with 1 when packets failed, the synthetic capture always has some
+    if result.returncode not in (0, 1):
+        raise subprocess.CalledProcessError(result.returncode, cmd)
+    return os.path.getsize(capture) / elapsed
+
+def collect_pcap_audit(auditor, label, keys, capture, packets, payload, threads_list, runs, cold, output_dir):
+    os.makedirs(output_dir, exist_ok=True)
+
+    if not os.path.exists(capture):
+        cmd = [auditor, "-a", label, "-k", keys, "-g", capture, "-n", str(packets), "-p", str(payload)]
+        print(' '.join(cmd))
+        subprocess.run(cmd, check=True)
+    print(f"Capture {capture}: {os.path.getsize(capture) / 1e9:.2f} GB")
+
+    # One rate in bytes/s per line, e.g. ./results/pcap_audit_blake3_4.txt
+    with open(os.path.join(output_dir, "pcap_read.txt"), "w") as f:
+        for run in range(runs):
+            rate = read_rate(capture, cold)
+            print(f"Read run {run + 1}/{runs}: {rate / 1e6:.1f} MB/s")
+            f.write(f"{rate:.0f}\n")
+
+    for threads in threads_list:
+        output_file = os.path.join(output_dir, f"pcap_audit_{label}_{threads}.txt")
+        with open(output_file, "w") as f:
+            for run in range(runs):
+                try:
+                    rate = audit_rate(auditor, label, keys, capture, threads, cold)
+                except subprocess.CalledProcessError as e:
+                    print(f"Error auditing with {threads} thread(s). Return code: {e.returncode}", file=sys.stderr)
+                    return
+                print(f"Audit {label} on {threads} thread(s), run {run + 1}/{runs}: {rate / 1e6:.1f} MB/s")
+                f.write(f"{rate:.0f}\n")
+
+    print("Pcap audit data collection complete.")
+
+if __name__ == "__main__":
+    SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+    REPO_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+    DEFAULT_THREADS = [1, 2, 4, 8]
+    DEFAULT_PACKETS = 1000000
+    DEFAULT_PAYLOAD = 1024
+    DEFAULT_RUNS = 5
+    ALLOWED_LABELS = ["blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+
+    parser = argparse.ArgumentParser(description="Collect the offline PoT verification rate of a synthetic capture for each number of threads.")
+    parser.add_argument("label",
+                        help="Algorithm of the capture.",
+                        choices=ALLOWED_LABELS)
+    parser.add_argument("-k", "--keys",
+                        default=os.path.join(SCRIPT_DIR, "keys.txt"),
+                        help="SID and key file, its SIDs are the path of the synthetic capture (default: ./keys.txt)")
+    parser.add_argument("-c", "--capture",
+                        help="Capture to audit, generated when missing (default: /tmp/pot-audit-<label>.pcap)")
+    parser.add_argument("-n", "--packets",
+                        type=int,
+                        default=DEFAULT_PACKETS,
+                        help=f"Packets of the generated capture, each recorded once per hop (default: {DEFAULT_PACKETS})")
+    parser.add_argument("-p", "--payload",
+                        type=int,
+                        default=DEFAULT_PAYLOAD,
+                        help=f"Inner UDP payload of the generated capture (default: {DEFAULT_PAYLOAD})")
+    parser.add_argument("-j", "--threads",
+                        type=int,
+                        nargs="+",
+                        default=DEFAULT_THREADS,
+                        help=f"Numbers of verification threads (default: {DEFAULT_THREADS})")
+    parser.add_argument("-r", "--runs",
+                        type=int,
+                        default=DEFAULT_RUNS,
+                        help=f"Runs of each measurement (default: {DEFAULT_RUNS})")
+    parser.add_argument("--cold",
+                        action="store_true",
+                        help="Drop the page cache before each run to read from disk, root is required")
+    parser.add_argument("-o", "--output-dir",
+                        default=os.path.join(SCRIPT_DIR, "results"),
+                        help="Directory to save the output files (default: script's results directory)")
+
+    args = parser.parse_args()
+
+    auditor = os.path.join(REPO_DIR, "cmd", "build", "seg6-pot-audit")
+    capture = args.capture or f"/tmp/pot-audit-{args.label}.pcap"
+
+    collect_pcap_audit(auditor, args.label, args.keys, capture, args.packets, args.payload,
+                       sorted(set(args.threads)), args.runs, args.cold, args.output_dir)
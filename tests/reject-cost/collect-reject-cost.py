@@ -0,0 +1,156 @@
+import subprocess
+import signal
+import sys
+import time
+import argparse
+import os
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "topology", "scripts"))
+from netns_lab import run_ns, link_info, pinned_keys, valid_tlv
+
+def softirq_seconds():
+    """Softirq time of every CPU, where XDP runs on the veth LAB"""
+    with open("/proc/stat") as f:
+        fields = f.readline().split()
+    return int(fields[7]) / os.sysconf("SC_CLK_TCK")
+
+def flood(kind, tlv):
+    """Segment list and TLV of each kind of packet, all of them but valid are rejected"""
+    tlv = bytearray(tlv)
+    path = list(PATH)
+    if kind == "witness":
+        tlv[-1] ^= 0xff
+    elif kind == "type":
+        tlv[0] ^= 0xff
+    elif kind == "length":
+        tlv[1] -= 8
+    elif kind == "ext":
+        tlv += bytes(8)
+    elif kind == "key":
+        path[2] = UNKNOWN_SID
+    return path, tlv.hex()
+
+def collect_reject_cost(args, kind, tlv, interval=1.0):
+    path, tlv_hex = flood(kind, tlv)
+    dst_mac = link_info(DUT_NETNS, DUT_IFACE)["address"]
+    pktgen_cmd = [args.pktgen, "--iface", GEN_IFACE, "--dst-mac", dst_mac, "--role", "egress",
+                  "--duration", f"{args.duration}s", "--payload", str(args.payload),
+                  "--flows", str(args.flows), "--sids", ",".join(path), "--tlv", tlv_hex]
+
+    print(' '.join(pktgen_cmd))
+    process = subprocess.Popen(run_ns(GEN_NETNS, pktgen_cmd), stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+
+    cost_values = []
+    time.sleep(interval)
+    last_packets = link_info(DUT_NETNS, DUT_IFACE)["stats64"]["rx"]["packets"]
+    last_cpu = softirq_seconds()
+
+    while process.poll() is None:
+        time.sleep(interval)
+        packets = link_info(DUT_NETNS, DUT_IFACE)["stats64"]["rx"]["packets"]
+        cpu = softirq_seconds()
+
+        # The generator may stop in the middle of this interval
+        if process.poll() is not None:
+            break
+
+        if packets > last_packets:
+            ns = (cpu - last_cpu) * 1e9 / (packets - last_packets)
+            cost_values.append(ns)
+            print(f"Interval {len(cost_values)}: {(packets - last_packets) / interval / 1e6:.3f} Mpps, {ns:.0f} ns/packet")
+        last_packets, last_cpu = packets, cpu
+
+    stdout, _ = process.communicate()
+    print(stdout.strip())
+
+    if not cost_values:
+        print(f"No CPU cost values collected for {kind}.", file=sys.stderr)
+        return
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    output_filename = os.path.join(args.output_dir, f"reject_cost_{args.tag}_{args.label}_{kind}.txt")
+    print(f"\nSaving {len(cost_values)} CPU cost values to {output_filename}...")
+    with open(output_filename, 'w') as f:
+        for val in cost_values:
+            f.write(f"{val}\n")
+
+if __name__ == "__main__":
+    SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+    REPO_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+    BUILD_DIR = os.path.join(REPO_DIR, "cmd", "build")
+    DEFAULT_KINDS = ["valid", "witness", "type", "length", "ext", "key"]
+    DEFAULT_DURATION = 10
+    DEFAULT_PAYLOAD = 64
+    DEFAULT_FLOWS = 16
+    ALLOWED_LABELS = ["blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+
+    # The generator takes the place of r3 and floods the End.DT6 SID of r4
+    GEN_NETNS, GEN_IFACE = "pot-r3", "ens5"
+    DUT_NETNS, DUT_IFACE = "pot-r4", "ens5"
+    PATH = ["2001:db8:ff:1::1", "2001:db8:ff:2::1", "2001:db8:ff:3::1", "2001:db8:ff:4::1"]
+    UNKNOWN_SID = "2001:db8:fd:1::1"
+
+    parser = argparse.ArgumentParser(description="Collect the egress CPU time spent on each packet of an invalid PoT flood.")
+    parser.add_argument("label",
+                        help="Algorithm of the build loaded on the LAB.",
+                        choices=ALLOWED_LABELS)
+    parser.add_argument("-k", "--kinds",
+                        nargs="+",
+                        default=DEFAULT_KINDS,
+                        choices=DEFAULT_KINDS,
+                        help=f"Packets to flood with (default: {DEFAULT_KINDS})")
+    parser.add_argument("-t", "--tag",
+                        default="current",
+                        help="Name of the build under test, e.g. before and after a change (default: current)")
+    parser.add_argument("--limit",
+                        type=int,
+                        help="Set this --limit on the loader for the run, then remove it")
+    parser.add_argument("--capture",
+                        type=int,
+                        metavar="RATE",
+                        help="Keep --capture running at RATE snapshots per second and CPU for the run")
+    parser.add_argument("-d", "--duration",
+                        type=int,
+                        default=DEFAULT_DURATION,
+                        help=f"Duration of each flood in seconds (default: {DEFAULT_DURATION})")
+    parser.add_argument("-p", "--payload",
+                        type=int,
+                        default=DEFAULT_PAYLOAD,
+                        help=f"Inner UDP payload size in bytes (default: {DEFAULT_PAYLOAD})")
+    parser.add_argument("-f", "--flows",
+                        type=int,
+                        default=DEFAULT_FLOWS,
+                        help=f"Number of flows (default: {DEFAULT_FLOWS})")
+    parser.add_argument("--pktgen",
+                        default=os.path.join(BUILD_DIR, "seg6-pot-pktgen"),
+                        help="Packet generator binary (default: cmd/build/seg6-pot-pktgen)")
+    parser.add_argument("-o", "--output-dir",
+                        default=os.path.join(SCRIPT_DIR, "results"),
+                        help="Directory to save the output files (default: script's results directory)")
+
+    args = parser.parse_args()
+    loader = os.path.join(BUILD_DIR, f"seg6-pot-tlv-{args.label}")
+    auditor = os.path.join(BUILD_DIR, "seg6-pot-audit")
+
+    keys = pinned_keys(loader)
+    tlv = valid_tlv(auditor, args.label, [(sid, keys[sid]) for sid in PATH])
+
+    if args.limit is not None:
+        subprocess.run([loader, "--limit", str(args.limit)], check=True)
+    capture = None
+    if args.capture is not None:
+        os.makedirs(args.output_dir, exist_ok=True)
+        capture_file = os.path.join(args.output_dir, f"reject_cost_{args.tag}_{args.label}.pcapng")
+        capture = subprocess.Popen([loader, "--capture", capture_file, "--capture-rate", str(args.capture)])
+        time.sleep(1)
+    try:
+        for kind in args.kinds:
+            collect_reject_cost(args, kind, tlv)
+    finally:
+        if capture:
+            capture.send_signal(signal.SIGINT)
+            capture.wait()
+        if args.limit is not None:
+            subprocess.run([loader, "--limit", "0"], check=True)
+
+    print("Reject cost data collection complete.")
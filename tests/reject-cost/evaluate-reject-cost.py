@@ -0,0 +1,82 @@
+import os
+import re
+import sys
+import numpy as np
+import matplotlib.pyplot as plt
+
+def load_cost_data(filename):
+    cost_values = []
+    try:
+        with open(filename, 'r') as f:
+            for line in f:
+                try:
+                    cost_values.append(float(line.strip()))
+                except ValueError:
+                    print(f"Warning: Skipping invalid line in {filename}: {line.strip()}", file=sys.stderr)
+    except FileNotFoundError:
+        return None
+    except Exception as e:
+        print(f"An error occurred reading {filename}: {e}", file=sys.stderr)
+        return None
+    return cost_values
+
+if __name__ == "__main__":
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    labels = ["blake3", "halfsiphash", "siphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+    pretty_labels = ["BLAKE3", "HalfSipHash", "SipHash", "Poly1305", "HMAC-SHA1", "HMAC-SHA256"]
+    kinds = ["valid", "witness", "type", "length", "ext", "key"]
+    pretty_kinds = ["Valid", "Bad witness", "Bad TLV type", "Bad TLV length", "Bad hdr_ext_len", "Unknown SID"]
+    colors = ['#4c72b0', '#dd8452', '#55a868', '#c44e52', '#8172b3', '#ccb974', '#64b5cd', '#8c8c8c']
+
+    # One series per build and algorithm, e.g. "BLAKE3 before"
+    series = {}
+    if os.path.isdir(results_dir):
+        for entry in sorted(os.listdir(results_dir)):
+            match = re.fullmatch(rf"reject_cost_(.+)_({'|'.join(map(re.escape, labels))})_({'|'.join(kinds)})\.txt", entry)
+            if not match:
+                continue
+            tag, label, kind = match.groups()
+            data_file = os.path.join(results_dir, entry)
+            data = load_cost_data(data_file)
+            if data:
+                print(f"Loaded {len(data)} values from {data_file}")
+                name = f"{pretty_labels[labels.index(label)]} {tag}"
+                series.setdefault(name, {})[kind] = (np.median(data), np.std(data))
+
+    if not series:
+        print(f"Error: No valid reject cost data found in {results_dir}. Cannot generate plot.", file=sys.stderr)
+        sys.exit(1)
+
+    print("Generating bar plot...")
+    plt.figure(figsize=(12, 6))
+
+    x = np.arange(len(kinds))
+    width = 0.8 / len(series)
+    for i, (name, points) in enumerate(series.items()):
+        medians = [points[kind][0] if kind in points else 0 for kind in kinds]
+        errors = [points[kind][1] if kind in points else 0 for kind in kinds]
+        offset = (i - (len(series) - 1) / 2) * width
+        bars = plt.bar(x + offset, medians, width, yerr=errors, capsize=4,
+                       color=colors[i % len(colors)], edgecolor='black', label=name)
+        for bar, median in zip(bars, medians):
+            if median:
+                plt.text(bar.get_x() + bar.get_width() / 2, median, f"{median:.0f}",
+                         ha='center', va='bottom', fontsize=8)
+
+    plt.xticks(x, pretty_kinds)
+    plt.ylabel("Softirq CPU per Packet (ns, median)", fontsize=12)
+    plt.title("Egress CPU Cost of Rejected PoT Packets", fontsize=16, fontweight='bold')
+    plt.legend()
+    plt.grid(axis='y', linestyle='--', linewidth=0.5, alpha=0.7)
+    plt.tight_layout()
+
+    try:
+        plot_save_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, "reject-cost.png")
+        plt.savefig(plot_save_path, dpi=300)
+        print(f"Bar plot saved to {plot_save_path}")
+    except Exception as e:
+        print(f"Error saving plot: {e}", file=sys.stderr)
+
+    print("Evaluation complete.")
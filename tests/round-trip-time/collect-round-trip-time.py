@@ -5,7 +5,7 @@ import time
 import argparse
 import os
 
-def collect_rtt(target_ip, count=100, output_filename="rtt_data.txt"):
+def collect_rtt(target_ip, count=100, output_filename="rtt_data.txt", min_rtt=2.8, max_rtt=6.0):
     print(f"Pinging {target_ip} {count} times...")
     command = ["ping", "-i", "0.1", "-c", str(count), target_ip]
     rtt_values = []
@@ -22,9 +22,9 @@ def collect_rtt(target_ip, count=100, output_filename="rtt_data.txt"):
             if match:
                 try:
                     rtt = float(match.group(1))
-                    if rtt > 6:
+                    if rtt > max_rtt:
                         continue
-                    if rtt < 2.8:
+                    if rtt < min_rtt:
                         continue
                     rtt_values.append(rtt)
                 except ValueError:
@@ -57,7 +57,9 @@ def collect_rtt(target_ip, count=100, output_filename="rtt_data.txt"):
 if __name__ == "__main__":
     DEFAULT_TARGET_IP = "2001:db8:60:1::2"
     DEFAULT_NUM_PINGS = 300
-    ALLOWED_LABELS = ["baseline", "blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1"]
+    DEFAULT_MIN_RTT = 2.8
+    DEFAULT_MAX_RTT = 6.0
+    ALLOWED_LABELS = ["baseline", "blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1", "hmac-sha256"]
 
     parser = argparse.ArgumentParser(description="Collect ping RTT data and save to a labeled file.")
     parser.add_argument("label",
@@ -70,6 +72,14 @@ if __name__ == "__main__":
                         type=int,
                         default=DEFAULT_NUM_PINGS,
                         help=f"Number of pings to send (default: {DEFAULT_NUM_PINGS})")
+    parser.add_argument("--min-rtt",
+                        type=float,
+                        default=DEFAULT_MIN_RTT,
+                        help=f"Discard samples below this RTT in ms (default: {DEFAULT_MIN_RTT}, tuned for the QEMU lab)")
+    parser.add_argument("--max-rtt",
+                        type=float,
+                        default=DEFAULT_MAX_RTT,
+                        help=f"Discard samples above this RTT in ms (default: {DEFAULT_MAX_RTT}, tuned for the QEMU lab)")
     parser.add_argument("-o", "--output-dir",
                         default=os.path.dirname(os.path.abspath(__file__)),
                         help="Directory to save the output file (default: script's directory)")
@@ -79,4 +89,4 @@ if __name__ == "__main__":
     output_filename = f"rtt_data_{args.label}.txt"
     output_path = os.path.join(args.output_dir, output_filename)
 
-    collect_rtt(args.target, args.count, output_path)
+    collect_rtt(args.target, args.count, output_path, args.min_rtt, args.max_rtt)
@@ -25,9 +25,12 @@ def load_rtt_data(filename):
 if __name__ == "__main__":
     script_dir = os.path.dirname(os.path.abspath(__file__))
     
-    labels = ["baseline", "blake3", "halfsiphash", "siphash", "poly1305", "hmac-sha1"]
-    pretty_labels = ["SRv6", "BLAKE3", "HalfSipHash", "SipHash", "Poly1305", "HMAC-SHA1"]
-    data_files = [os.path.join(script_dir + '/results', f"rtt_data_{label}.txt") for label in labels]
+    # An alternative results directory can be given, e.g. results/netns from the netns testbed
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    labels = ["baseline", "blake3", "halfsiphash", "siphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+    pretty_labels = ["SRv6", "BLAKE3", "HalfSipHash", "SipHash", "Poly1305", "HMAC-SHA1", "HMAC-SHA256"]
+    data_files = [os.path.join(results_dir, f"rtt_data_{label}.txt") for label in labels]
 
     plot_filename = "round-trip-time.png"
     plot_title = "Round-Trip Time Comparison For Each PoT TLV Crypto Algorithm"
@@ -55,7 +58,7 @@ if __name__ == "__main__":
     plt.figure(figsize=(10, 6))
     box = plt.boxplot(all_data, patch_artist=True, labels=valid_labels, showfliers=False)
 
-    colors = ['#4c72b0', '#55a868', '#c44e52', '#8172b3', '#ccb974']
+    colors = ['#4c72b0', '#55a868', '#c44e52', '#8172b3', '#ccb974', '#64b5cd', '#8c8c8c']
     for patch, color in zip(box['boxes'], colors[:len(all_data)]):
         patch.set_facecolor(color)
         patch.set_alpha(0.8)
@@ -83,7 +86,7 @@ if __name__ == "__main__":
     plt.tight_layout()
 
     try:
-        plot_save_path = os.path.join(script_dir, plot_filename)
+        plot_save_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, plot_filename)
         plt.savefig(plot_save_path, dpi=300)
         print(f"Box plot saved to {plot_save_path}")
     except Exception as e:
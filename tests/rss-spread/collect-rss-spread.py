@@ -0,0 +1,115 @@
+import subprocess
+import re
+import sys
+import time
+import argparse
+import os
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "topology", "scripts"))
+from netns_lab import run_ns
+
+def read_cpu_times():
+    # Busy and total jiffies per CPU, the namespaces share the host CPUs
+    times = {}
+    with open("/proc/stat", 'r') as f:
+        for line in f:
+            match = re.match(r"cpu(\d+)\s+(.*)", line)
+            if not match:
+                continue
+            fields = [int(v) for v in match.group(2).split()]
+            idle = fields[3] + fields[4]
+            times[int(match.group(1))] = (sum(fields) - idle, sum(fields))
+    return times
+
+def read_queue_packets(netns, iface):
+    # veth counts the frames its XDP program saw on each RX queue
+    result = subprocess.run(run_ns(netns, ["ethtool", "-S", iface]),
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, check=True)
+    packets = {}
+    for line in result.stdout.splitlines():
+        match = re.match(r"\s*rx_queue_(\d+)_xdp_packets:\s*(\d+)", line)
+        if match:
+            packets[int(match.group(1))] = int(match.group(2))
+    return packets
+
+def write_values(filename, values):
+    with open(filename, 'w') as f:
+        for val in values:
+            f.write(f"{val}\n")
+
+def collect_rss_spread(pktgen_cmd, dut, label, output_dir):
+    netns, iface = dut
+    queues_before = read_queue_packets(netns, iface)
+    cpus_before = read_cpu_times()
+
+    print(' '.join(pktgen_cmd))
+    result = subprocess.run(pktgen_cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    print(result.stdout.strip())
+    if result.returncode != 0:
+        print(f"Error running the packet generator. Return code: {result.returncode}", file=sys.stderr)
+        return
+
+    queues_after = read_queue_packets(netns, iface)
+    cpus_after = read_cpu_times()
+
+    utilisation = []
+    for cpu in sorted(cpus_after):
+        busy = cpus_after[cpu][0] - cpus_before[cpu][0]
+        total = cpus_after[cpu][1] - cpus_before[cpu][1]
+        utilisation.append(100.0 * busy / total if total else 0.0)
+    packets = [queues_after[q] - queues_before.get(q, 0) for q in sorted(queues_after)]
+
+    for cpu, util in enumerate(utilisation):
+        print(f"CPU {cpu}: {util:.1f}%")
+    for queue, count in enumerate(packets):
+        print(f"{netns}:{iface} RX queue {queue}: {count} packets")
+
+    if not os.path.exists(output_dir):
+        os.makedirs(output_dir)
+
+    # One value per CPU and per queue, in index order
+    cpu_file = os.path.join(output_dir, f"cpu_util_data_{label}.txt")
+    queue_file = os.path.join(output_dir, f"queue_packets_data_{label}.txt")
+    print(f"\nSaving to {cpu_file} and {queue_file}...")
+    write_values(cpu_file, utilisation)
+    write_values(queue_file, packets)
+    print("RSS spread data collection complete.")
+
+if __name__ == "__main__":
+    REPO_DIR = os.path.abspath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+    DEFAULT_PKTGEN = os.path.join(REPO_DIR, "cmd", "build", "seg6-pot-pktgen")
+    DEFAULT_DURATION = 10
+    DEFAULT_FLOWS = 256
+    ALLOWED_LABELS = ["default", "flowlabel"]
+
+    parser = argparse.ArgumentParser(description="Collect the per-core utilisation and per-queue spread behind the head-end.")
+    parser.add_argument("label",
+                        help="Label for the dataset, the head-end built without or with FLOWLABEL=1.",
+                        choices=ALLOWED_LABELS)
+    parser.add_argument("-a", "--algo",
+                        default="blake3",
+                        help="Algorithm loaded in the LAB (default: blake3)")
+    parser.add_argument("-d", "--duration",
+                        type=int,
+                        default=DEFAULT_DURATION,
+                        help=f"Duration of the test in seconds (default: {DEFAULT_DURATION})")
+    parser.add_argument("-f", "--flows",
+                        type=int,
+                        default=DEFAULT_FLOWS,
+                        help=f"Number of inner flows (default: {DEFAULT_FLOWS})")
+    parser.add_argument("--pktgen",
+                        default=DEFAULT_PKTGEN,
+                        help=f"Packet generator binary (default: {DEFAULT_PKTGEN})")
+    parser.add_argument("-o", "--output-dir",
+                        default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "results"),
+                        help="Directory to save the output files (default: script's results directory)")
+
+    args = parser.parse_args()
+
+    # Plain IPv6 from h1, r1 encapsulates it and r2 is the first PoT node behind it
+    dst_mac = subprocess.run(["ip", "-n", "pot-r1", "-br", "link", "show", "dev", "ens4"],
+                             stdout=subprocess.PIPE, text=True, check=True).stdout.split()[2]
+    pktgen_cmd = run_ns("pot-h1", [args.pktgen, "--iface", "ens4", "--dst-mac", dst_mac, "--role", "headend",
+                                   "--duration", f"{args.duration}s", "--flows", str(args.flows), "--algo", args.algo])
+
+    collect_rss_spread(pktgen_cmd, ("pot-r2", "ens4"), args.label, args.output_dir)
@@ -0,0 +1,74 @@
+import os
+import sys
+import numpy as np
+import matplotlib.pyplot as plt
+
+def load_values(filename):
+    values = []
+    try:
+        with open(filename, 'r') as f:
+            for line in f:
+                try:
+                    values.append(float(line.strip()))
+                except ValueError:
+                    print(f"Warning: Skipping invalid line in {filename}: {line.strip()}", file=sys.stderr)
+    except FileNotFoundError:
+        return None
+    except Exception as e:
+        print(f"An error occurred reading {filename}: {e}", file=sys.stderr)
+        return None
+    return values
+
+if __name__ == "__main__":
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    labels = ["default", "flowlabel"]
+    pretty_labels = ["Flow label untouched", "Flow label from inner flow"]
+    colors = ['#c44e52', '#55a868']
+    panels = [("cpu_util_data", "CPU", "Utilisation (%)"),
+              ("queue_packets_data", "RX Queue (r2 ens4)", "Packets")]
+
+    datasets = {}
+    for prefix, _, _ in panels:
+        for i, label in enumerate(labels):
+            data_file = os.path.join(results_dir, f"{prefix}_{label}.txt")
+            data = load_values(data_file)
+            if data:
+                print(f"Loaded {len(data)} values from {data_file}")
+                datasets.setdefault(prefix, []).append((pretty_labels[i], colors[i], data))
+
+    if not datasets:
+        print(f"Error: No valid RSS spread data found in {results_dir}. Cannot generate plot.", file=sys.stderr)
+        sys.exit(1)
+
+    print("Generating bar plots...")
+    shown = [panel for panel in panels if panel[0] in datasets]
+    fig, axes = plt.subplots(1, len(shown), figsize=(8 * len(shown), 6), squeeze=False)
+
+    for ax, (prefix, xlabel, ylabel) in zip(axes[0], shown):
+        series = datasets[prefix]
+        width = 0.8 / len(series)
+        for i, (name, color, data) in enumerate(series):
+            x = np.arange(len(data)) + i * width
+            ax.bar(x, data, width, label=name, color=color, alpha=0.8)
+
+        count = max(len(data) for _, _, data in series)
+        ax.set_xticks(np.arange(count) + width * (len(series) - 1) / 2)
+        ax.set_xticklabels([str(i) for i in range(count)])
+        ax.set_xlabel(xlabel, fontsize=12)
+        ax.set_ylabel(ylabel, fontsize=12)
+        ax.legend()
+        ax.grid(True, axis='y', linestyle='--', linewidth=0.5, alpha=0.7)
+
+    fig.suptitle("SRv6 PoT Load Spread Behind The Head-End", fontsize=16, fontweight='bold')
+    plt.tight_layout()
+
+    try:
+        plot_save_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, "rss-spread.png")
+        plt.savefig(plot_save_path, dpi=300)
+        print(f"Bar plot saved to {plot_save_path}")
+    except Exception as e:
+        print(f"Error saving plot: {e}", file=sys.stderr)
+
+    print("Evaluation complete.")
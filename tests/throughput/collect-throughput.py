@@ -66,9 +66,10 @@ if __name__ == "__main__":
     DEFAULT_TARGET_IP = "2001:db8:60:1::2"
     DEFAULT_DURATION = 10
     DEFAULT_NUM_TESTS = 5
-    ALLOWED_LABELS = ["baseline", "blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1"]
+    ALLOWED_LABELS = ["baseline", "blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1", "hmac-sha256"]
     MAXIMUM_SEGMENT_SIZES = {
         "blake3": 1296,
+        "hmac-sha256": 1296,
         "hmac-sha1": 1304,
         "poly1305": 1312,
         "siphash": 1320,
@@ -26,16 +26,21 @@ def load_throughput_data(filename):
 if __name__ == "__main__":
     script_dir = os.path.dirname(os.path.abspath(__file__))
 
-    labels = ["baseline", "halfsiphash", "siphash", "blake3", "poly1305", "hmac-sha1"]
-    pretty_labels = ["SRv6", "HalfSipHash", "SipHash", "BLAKE3", "Poly1305", "HMAC-SHA1"]
-    data_files = [os.path.join(script_dir + '/results', f"throughput_data_{label}.txt") for label in labels]
+    # An alternative results directory can be given, e.g. results/netns from the netns testbed
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    labels = ["baseline", "halfsiphash", "siphash", "blake3", "poly1305", "hmac-sha1", "hmac-sha256"]
+    pretty_labels = ["SRv6", "HalfSipHash", "SipHash", "BLAKE3", "Poly1305", "HMAC-SHA1", "HMAC-SHA256"]
+    data_files = [os.path.join(results_dir, f"throughput_data_{label}.txt") for label in labels]
 
     all_data = []
-    for fn in data_files:
+    valid_labels = []
+    for i, fn in enumerate(data_files):
         print(f"Loading data from {fn}...")
         data = load_throughput_data(fn)
         if data:
             all_data.append(data)
+            valid_labels.append(pretty_labels[i])
         else:
             print(f"Skipping {fn}", file=sys.stderr)
 
@@ -78,14 +83,17 @@ if __name__ == "__main__":
     ax.xaxis.grid(True, linestyle='--', linewidth=0.7, alpha=0.7)
     ax.set_axisbelow(True)
 
-    ax.set_yticks(range(1, len(pretty_labels) + 1))
-    ax.set_yticklabels(pretty_labels, fontsize=13)
-    ax.xaxis.set_major_locator(MultipleLocator(250))
+    ax.set_yticks(range(1, len(valid_labels) + 1))
+    ax.set_yticklabels(valid_labels, fontsize=13)
+
+    # Keep the 250 Mbps grid of the QEMU lab, but avoid thousands of ticks on faster testbeds
+    x_max = max(np.max(data) for data in all_data)
+    ax.xaxis.set_major_locator(MultipleLocator(max(250, 250 * np.ceil(x_max / 250 / 40))))
     ax.set_xlabel("TCP Throughput (Mbps)", fontsize=14, labelpad=10)
     ax.set_title("Throughput Distribution For Each PoT TLV Crypto Algorithm", fontsize=16, weight='bold', pad=15)
 
     plt.tight_layout()
-    out_path = os.path.join(script_dir, "throughput.png")
+    out_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, "throughput.png")
     plt.savefig(out_path, dpi=300)
     print(f"Scientific violin plot saved to {out_path}")
     print("Evaluation complete.")
@@ -0,0 +1,137 @@
+import subprocess
+import json
+import sys
+import time
+import argparse
+import os
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "topology", "scripts"))
+from netns_lab import run_ns
+
+IPERF_PORT = "5202"
+
+def run_stream(netns_script, label, target_ip, duration, bitrate, size, upgrade_interval):
+    server = subprocess.Popen(run_ns("pot-h2", ["iperf3", "-s", "-1", "-p", IPERF_PORT]),
+                              stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    time.sleep(0.5)
+
+    client_cmd = ["iperf3", "-c", target_ip, "-p", IPERF_PORT, "-u", "-b", bitrate, "-l", str(size),
+                  "-t", str(duration), "--json"]
+    print(' '.join(client_cmd))
+    client = subprocess.Popen(run_ns("pot-h1", client_cmd), stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+
+    # Swap the programs of every router again and again while the stream runs
+    upgrades = 0
+    if upgrade_interval:
+        time.sleep(upgrade_interval)
+        while client.poll() is None:
+            result = subprocess.run([netns_script, "upgrade", label], stdout=subprocess.DEVNULL)
+            if result.returncode != 0:
+                print(f"Error upgrading to {label}. Return code: {result.returncode}", file=sys.stderr)
+                break
+            upgrades += 1
+            time.sleep(upgrade_interval)
+
+    stdout, stderr = client.communicate()
+    server.wait()
+
+    try:
+        data = json.loads(stdout)
+    except json.JSONDecodeError as json_err:
+        print(f"Failed parsing JSON output: {json_err}", file=sys.stderr)
+        print(f"Stderr: {stderr}", file=sys.stderr)
+        return None
+    if "error" in data:
+        print(f"iperf3 error: {data['error']}", file=sys.stderr)
+        return None
+
+    summary = data["end"]["sum"]
+    print(f"{upgrades} upgrades, lost {summary['lost_packets']} of {summary['packets']} packets")
+    return summary["lost_packets"]
+
+def collect_upgrade_loss(netns_script, label, target_ip, runs, duration, bitrate, size, upgrade_interval, output_dir):
+    env = dict(os.environ, PIN="1")
+    print(f"Loading {label} with pinned links...")
+    subprocess.run([netns_script, "setup", label], env=env, check=True)
+
+    # The steady runs tell the loss of the path itself apart from the one of the upgrades
+    phases = {"steady": 0, "upgrade": upgrade_interval}
+    results = {}
+    for phase, interval in phases.items():
+        results[phase] = []
+        for i in range(runs):
+            print(f"{phase} run {i+1}/{runs}:")
+            lost = run_stream(netns_script, label, target_ip, duration, bitrate, size, interval)
+            if lost is not None:
+                results[phase].append(lost)
+            time.sleep(1)
+
+    subprocess.run([netns_script, "cleanup"])
+
+    if not os.path.exists(output_dir):
+        os.makedirs(output_dir)
+
+    for phase, values in results.items():
+        output_filename = os.path.join(output_dir, f"upgrade_loss_{phase}_{label}.txt")
+        print(f"Saving {len(values)} lost packet counts to {output_filename}...")
+        with open(output_filename, 'w') as f:
+            for val in values:
+                f.write(f"{val}\n")
+
+    if len(results["upgrade"]) < runs:
+        print("Some upgrade runs failed.", file=sys.stderr)
+        return False
+    if any(results["upgrade"]):
+        print(f"FAIL: packets lost while upgrading: {results['upgrade']}", file=sys.stderr)
+        return False
+    print("PASS: no packet lost while upgrading.")
+    return True
+
+if __name__ == "__main__":
+    SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+    REPO_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+    DEFAULT_TARGET = "2001:db8:60:1::2"
+    DEFAULT_RUNS = 5
+    DEFAULT_DURATION = 10
+    DEFAULT_BITRATE = "100M"
+    DEFAULT_SIZE = 1200
+    DEFAULT_INTERVAL = 0.5
+    ALLOWED_LABELS = ["blake3", "siphash", "halfsiphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+
+    parser = argparse.ArgumentParser(description="Count the packets lost by a UDP stream across the LAB while the pinned programs of every router are upgraded.")
+    parser.add_argument("label",
+                        help="Algorithm loaded and upgraded to.",
+                        choices=ALLOWED_LABELS)
+    parser.add_argument("-t", "--target",
+                        default=DEFAULT_TARGET,
+                        help=f"Address of h2 (default: {DEFAULT_TARGET})")
+    parser.add_argument("-r", "--runs",
+                        type=int,
+                        default=DEFAULT_RUNS,
+                        help=f"Number of runs with and without upgrades (default: {DEFAULT_RUNS})")
+    parser.add_argument("-d", "--duration",
+                        type=int,
+                        default=DEFAULT_DURATION,
+                        help=f"Duration of each run in seconds (default: {DEFAULT_DURATION})")
+    parser.add_argument("-b", "--bitrate",
+                        default=DEFAULT_BITRATE,
+                        help=f"UDP bitrate of the stream (default: {DEFAULT_BITRATE})")
+    parser.add_argument("-s", "--size",
+                        type=int,
+                        default=DEFAULT_SIZE,
+                        help=f"UDP payload size in bytes (default: {DEFAULT_SIZE})")
+    parser.add_argument("-i", "--interval",
+                        type=float,
+                        default=DEFAULT_INTERVAL,
+                        help=f"Seconds between two upgrades (default: {DEFAULT_INTERVAL})")
+    parser.add_argument("-o", "--output-dir",
+                        default=os.path.join(SCRIPT_DIR, "results"),
+                        help="Directory to save the output files (default: script's results directory)")
+
+    args = parser.parse_args()
+
+    netns_script = os.path.join(REPO_DIR, "topology", "scripts", "netns.sh")
+
+    ok = collect_upgrade_loss(netns_script, args.label, args.target, args.runs, args.duration,
+                              args.bitrate, args.size, args.interval, args.output_dir)
+    sys.exit(0 if ok else 1)
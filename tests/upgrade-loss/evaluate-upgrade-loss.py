@@ -0,0 +1,72 @@
+import os
+import sys
+import numpy as np
+import matplotlib.pyplot as plt
+
+def load_values(filename):
+    values = []
+    try:
+        with open(filename, 'r') as f:
+            for line in f:
+                try:
+                    values.append(int(line.strip()))
+                except ValueError:
+                    print(f"Warning: Skipping invalid line in {filename}: {line.strip()}", file=sys.stderr)
+    except FileNotFoundError:
+        return None
+    except Exception as e:
+        print(f"An error occurred reading {filename}: {e}", file=sys.stderr)
+        return None
+    return values
+
+if __name__ == "__main__":
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    results_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, 'results')
+
+    labels = ["blake3", "halfsiphash", "siphash", "poly1305", "hmac-sha1", "hmac-sha256"]
+    pretty_labels = ["BLAKE3", "HalfSipHash", "SipHash", "Poly1305", "HMAC-SHA1", "HMAC-SHA256"]
+    phases = [("steady", "Without upgrades", '#8c8c8c'), ("upgrade", "Upgrading", '#c44e52')]
+
+    names = []
+    series = {phase: [] for phase, _, _ in phases}
+    for i, label in enumerate(labels):
+        loaded = {}
+        for phase, _, _ in phases:
+            data_file = os.path.join(results_dir, f"upgrade_loss_{phase}_{label}.txt")
+            data = load_values(data_file)
+            if data:
+                print(f"Loaded {len(data)} values from {data_file}")
+                loaded[phase] = sum(data)
+        if loaded:
+            names.append(pretty_labels[i])
+            for phase, _, _ in phases:
+                series[phase].append(loaded.get(phase, 0))
+
+    if not names:
+        print(f"Error: No valid upgrade loss data found in {results_dir}. Cannot generate plot.", file=sys.stderr)
+        sys.exit(1)
+
+    print("Generating bar plot...")
+    plt.figure(figsize=(10, 6))
+
+    width = 0.8 / len(phases)
+    x = np.arange(len(names))
+    for i, (phase, pretty, color) in enumerate(phases):
+        bars = plt.bar(x + i * width, series[phase], width, label=pretty, color=color, alpha=0.8)
+        plt.bar_label(bars, fontsize=8)
+
+    plt.xticks(x + width * (len(phases) - 1) / 2, names)
+    plt.ylabel("Lost Packets (all runs)", fontsize=12)
+    plt.title("Packet Loss During Atomic Program Upgrades", fontsize=16, fontweight='bold')
+    plt.legend()
+    plt.grid(True, axis='y', linestyle='--', linewidth=0.5, alpha=0.7)
+    plt.tight_layout()
+
+    try:
+        plot_save_path = os.path.join(script_dir if len(sys.argv) < 2 else results_dir, "upgrade-loss.png")
+        plt.savefig(plot_save_path, dpi=300)
+        print(f"Bar plot saved to {plot_save_path}")
+    except Exception as e:
+        print(f"Error saving plot: {e}", file=sys.stderr)
+
+    print("Evaluation complete.")
@@ -0,0 +1,466 @@
+#!/bin/bash
+set -uo pipefail
+
+# This script reproduces the QEMU SRv6 lab on a single host with network
+# namespaces and veth pairs, so the benchmarks run in minutes and without the
+# VM and bridge noise. Interface names, addresses, SIDs and keys are the same
+# used by the Ansible playbooks.
+#
+# Topology:
+#
+#        r2 -- r3
+#        |      |
+# h1 -- r1     r4 --- h2
+#
+# Usage:
+#   netns.sh up                     Create the namespaces, links and SRv6 routes
+#   netns.sh setup <algorithm>      Attach seg6-pot-tlv-<algorithm> and load the keys
+#   netns.sh upgrade <algorithm>    Swap seg6-pot-tlv-<algorithm> into the pinned links, needs PIN=1
+#   netns.sh cleanup                Detach every seg6-pot-tlv instance
+#   netns.sh evaluate [algorithm..] Collect RTT and throughput for the baseline and each algorithm
+#   netns.sh down                   Remove everything created by this script
+#
+# FASTPATH=1 makes r2 and r3 run the SRv6 End behaviour, and r1 and r4 the
+# validation plus End.DT6, of their SIDs in XDP and redirect the packets
+# instead of passing them to the kernel.
+#
+# STEER_CPUS=<list> (e.g. 0-3) spreads the validation of every instance over
+# these CPUs by the inner flow hash.
+#
+# QUEUES=<n> creates the veth pairs with n queues on `up`, so the flows can be
+# spread the same way RSS does on a multi-queue NIC.
+#
+# MODE=auto|xdp|xdp-generic|tc picks how the validator is attached, veth runs
+# XDP natively so auto resolves to xdp here.
+#
+# PIN=1 loads each router once for all its interfaces and pins the programs
+# and links under PIN_DIR/<node> instead of keeping a process per interface.
+#
+# GSO=on|off turns GRO and GSO/TSO on or off on the head-ends, on `up`, so the
+# TLV is inserted into large GSO packets or into every MTU sized one.
+#
+# Ensure you run this script as root.
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_DIR="$(cd "${SCRIPT_DIR}/../.." && pwd)"
+
+BIN_DIR="${BIN_DIR:-${REPO_DIR}/cmd/build}"
+RUN_DIR="${RUN_DIR:-/run/seg6-pot-tlv-netns}"
+NS_PREFIX="${NS_PREFIX:-pot-}"
+FASTPATH="${FASTPATH:-0}"
+STEER_CPUS="${STEER_CPUS:-}"
+QUEUES="${QUEUES:-1}"
+GSO="${GSO:-}"
+MODE="${MODE:-auto}"
+PIN="${PIN:-0}"
+PIN_DIR="${PIN_DIR:-/sys/fs/bpf/seg6_pot_netns}"
+KEY_MAP="/sys/fs/bpf/seg6_pot_keys"
+KEYSET_MAP="/sys/fs/bpf/seg6_pot_keyset"
+TENANTS_MAP="/sys/fs/bpf/seg6_pot_tenants"
+TENANT_DIR="/sys/fs/bpf/seg6_pot_tenant"
+
+NODES=("h1" "r1" "r2" "r3" "r4" "h2")
+ALLOWED_ALGOS=("blake3" "siphash" "halfsiphash" "poly1305" "hmac-sha1" "hmac-sha256")
+
+# SRv6 interfaces running seg6-pot-tlv on each router, as in setup.yml
+declare -A POT_IFACES=(
+    ["r1"]="ens5"
+    ["r2"]="ens4 ens5"
+    ["r3"]="ens4 ens5"
+    ["r4"]="ens5"
+)
+
+declare -A POT_KEYS=(
+    ["2001:db8:ff:1::1"]="00112233445566778899aabbccddeeff00112233445566778899aabbccddee11"
+    ["2001:db8:ff:2::1"]="00112233445566778899aabbccddeeff00112233445566778899aabbccddee22"
+    ["2001:db8:ff:3::1"]="00112233445566778899aabbccddeeff00112233445566778899aabbccddee33"
+    ["2001:db8:ff:4::1"]="00112233445566778899aabbccddeeff00112233445566778899aabbccddee44"
+)
+
+# SIDs handled by the XDP fast-path when FASTPATH=1, End.DT6 uses table local
+declare -A FASTPATH_SIDS=(
+    ["2001:db8:ff:1::1"]="end.dt6"
+    ["2001:db8:ff:2::1"]="end"
+    ["2001:db8:ff:3::1"]="end"
+    ["2001:db8:ff:4::1"]="end.dt6"
+)
+
+# -------------------------
+# Helpers
+# -------------------------
+# `ip netns exec` remounts /sys, which hides the bpffs where the key map is
+# pinned, so commands only switch the network namespace
+in_ns() {
+    local NODE=$1
+    shift
+    nsenter --net="/run/netns/${NS_PREFIX}${NODE}" "$@"
+}
+
+create_ns() {
+    local NODE=$1
+    if ! ip netns list | grep -qw "${NS_PREFIX}${NODE}"; then
+        ip netns add "${NS_PREFIX}${NODE}"
+        echo "Namespace ${NS_PREFIX}${NODE} created."
+    else
+        echo "Namespace ${NS_PREFIX}${NODE} already exists."
+    fi
+
+    # Set before any link is created so every interface inherits them
+    in_ns "$NODE" sysctl -qw net.ipv6.conf.all.seg6_enabled=1
+    in_ns "$NODE" sysctl -qw net.ipv6.conf.default.seg6_enabled=1
+    in_ns "$NODE" sysctl -qw net.ipv6.conf.all.forwarding=1
+    in_ns "$NODE" sysctl -qw net.ipv6.conf.default.accept_dad=0
+    in_ns "$NODE" ip link set dev lo up
+}
+
+# Function to create a veth pair between two nodes, keeping the VM names
+create_link() {
+    local NODE_A=$1 IF_A=$2 NODE_B=$3 IF_B=$4
+    if in_ns "$NODE_A" ip link show "$IF_A" &>/dev/null; then
+        echo "Link ${NODE_A}:${IF_A} -- ${NODE_B}:${IF_B} already exists."
+        return
+    fi
+    ip link add "$IF_A" numtxqueues "$QUEUES" numrxqueues "$QUEUES" netns "${NS_PREFIX}${NODE_A}" \
+        type veth peer name "$IF_B" numtxqueues "$QUEUES" numrxqueues "$QUEUES" netns "${NS_PREFIX}${NODE_B}"
+    in_ns "$NODE_A" ip link set dev "$IF_A" up
+    in_ns "$NODE_B" ip link set dev "$IF_B" up
+    echo "Link ${NODE_A}:${IF_A} -- ${NODE_B}:${IF_B} created."
+}
+
+# Function to turn the router SID into an SRv6 End/End.DT6 behaviour
+create_sid() {
+    local NODE=$1 SID=$2 ACTION=$3
+    in_ns "$NODE" ip -6 addr add "${SID}/128" dev lo 2>/dev/null
+    in_ns "$NODE" ip -6 route replace local "${SID}/128" dev lo encap seg6local action $ACTION
+    in_ns "$NODE" ip -6 route del local "${SID}/128" dev lo 2>/dev/null
+    in_ns "$NODE" ip sr tunsrc set "$SID"
+}
+
+# Function to choose whether the head-ends see aggregated GSO packets
+set_offloads() {
+    local NODE IN OUT
+    for NODE in r1 r4; do
+        [ "$NODE" = "r1" ] && IN="ens4" OUT="ens5" || IN="ens6" OUT="ens5"
+        in_ns "$NODE" ethtool -K "$IN" gro "$GSO" > /dev/null || exit 1
+        in_ns "$NODE" ethtool -K "$OUT" gso "$GSO" tso "$GSO" > /dev/null || exit 1
+    done
+    echo "GRO and GSO/TSO turned ${GSO} on the head-ends."
+}
+
+validate_algo() {
+    local ALGO=$1
+    if [[ ! " ${ALLOWED_ALGOS[@]} " =~ " ${ALGO} " ]]; then
+        echo "Error: Invalid algorithm '$ALGO'."
+        echo "Available algorithms: ${ALLOWED_ALGOS[*]}"
+        exit 1
+    fi
+    if [ ! -x "${BIN_DIR}/seg6-pot-tlv-${ALGO}" ]; then
+        echo "Error: Binary '${BIN_DIR}/seg6-pot-tlv-${ALGO}' not found."
+        echo "Make sure you have compiled the ${ALGO} version using 'make ${ALGO}'."
+        exit 1
+    fi
+}
+
+# -------------------------
+# Topology
+# -------------------------
+topology_up() {
+    for NODE in "${NODES[@]}"; do
+        create_ns "$NODE"
+    done
+
+    create_link "h1" "ens4" "r1" "ens4"
+    create_link "r1" "ens5" "r2" "ens4"
+    create_link "r1" "ens6" "r4" "ens4"
+    create_link "r2" "ens5" "r3" "ens4"
+    create_link "r3" "ens5" "r4" "ens5"
+    create_link "r4" "ens6" "h2" "ens4"
+
+    # Interface addresses
+    in_ns h1 ip -6 addr replace 2001:db8:10:1::2/64 dev ens4
+    in_ns r1 ip -6 addr replace 2001:db8:10:1::1/64 dev ens4
+    in_ns r1 ip -6 addr replace 2001:db8:20:1::1/64 dev ens5
+    in_ns r1 ip -6 addr replace 2001:db8:50:1::2/64 dev ens6
+    in_ns r2 ip -6 addr replace 2001:db8:20:1::2/64 dev ens4
+    in_ns r2 ip -6 addr replace 2001:db8:30:1::1/64 dev ens5
+    in_ns r3 ip -6 addr replace 2001:db8:30:1::2/64 dev ens4
+    in_ns r3 ip -6 addr replace 2001:db8:40:1::1/64 dev ens5
+    in_ns r4 ip -6 addr replace 2001:db8:50:1::1/64 dev ens4
+    in_ns r4 ip -6 addr replace 2001:db8:40:1::2/64 dev ens5
+    in_ns r4 ip -6 addr replace 2001:db8:60:1::1/64 dev ens6
+    in_ns h2 ip -6 addr replace 2001:db8:60:1::2/64 dev ens4
+
+    # Static routes for the non-SRv6 networks
+    in_ns r1 ip -6 route replace 2001:db8:30:1::/64 via 2001:db8:20:1::2 dev ens5
+    in_ns r1 ip -6 route replace 2001:db8:40:1::/64 via 2001:db8:20:1::2 dev ens5
+    in_ns r1 ip -6 route replace 2001:db8:60:1::/64 via 2001:db8:50:1::1 dev ens6
+    in_ns r2 ip -6 route replace 2001:db8:10:1::/64 via 2001:db8:20:1::1 dev ens4
+    in_ns r2 ip -6 route replace 2001:db8:40:1::/64 via 2001:db8:30:1::2 dev ens5
+    in_ns r2 ip -6 route replace 2001:db8:50:1::/64 via 2001:db8:20:1::1 dev ens4
+    in_ns r2 ip -6 route replace 2001:db8:60:1::/64 via 2001:db8:30:1::2 dev ens5
+    in_ns r3 ip -6 route replace 2001:db8:10:1::/64 via 2001:db8:30:1::1 dev ens4
+    in_ns r3 ip -6 route replace 2001:db8:20:1::/64 via 2001:db8:30:1::1 dev ens4
+    in_ns r3 ip -6 route replace 2001:db8:50:1::/64 via 2001:db8:40:1::2 dev ens5
+    in_ns r3 ip -6 route replace 2001:db8:60:1::/64 via 2001:db8:40:1::2 dev ens5
+    in_ns r4 ip -6 route replace 2001:db8:10:1::/64 via 2001:db8:40:1::1 dev ens5
+    in_ns r4 ip -6 route replace 2001:db8:20:1::/64 via 2001:db8:40:1::1 dev ens5
+    in_ns r4 ip -6 route replace 2001:db8:30:1::/64 via 2001:db8:40:1::1 dev ens5
+
+    # SRv6 SIDs, End.DT6 on the edges and End on the transit routers
+    create_sid r1 2001:db8:ff:1::1 "End.DT6 table local"
+    create_sid r2 2001:db8:ff:2::1 "End"
+    create_sid r3 2001:db8:ff:3::1 "End"
+    create_sid r4 2001:db8:ff:4::1 "End.DT6 table local"
+    in_ns r1 ip -6 route replace table local 2001:db8:10:1::/64 dev ens4
+    in_ns r4 ip -6 route replace table local 2001:db8:60:1::/64 dev ens6
+
+    # Routes to the remote SIDs
+    in_ns r1 ip -6 route replace 2001:db8:ff:2::1/128 via 2001:db8:20:1::2 dev ens5
+    in_ns r1 ip -6 route replace 2001:db8:ff:3::1/128 via 2001:db8:20:1::2 dev ens5
+    in_ns r1 ip -6 route replace 2001:db8:ff:4::1/128 via 2001:db8:50:1::1 dev ens6
+    in_ns r2 ip -6 route replace 2001:db8:ff:1::1/128 via 2001:db8:20:1::1 dev ens4
+    in_ns r2 ip -6 route replace 2001:db8:ff:3::1/128 via 2001:db8:30:1::2 dev ens5
+    in_ns r2 ip -6 route replace 2001:db8:ff:4::1/128 via 2001:db8:30:1::2 dev ens5
+    in_ns r3 ip -6 route replace 2001:db8:ff:1::1/128 via 2001:db8:30:1::1 dev ens4
+    in_ns r3 ip -6 route replace 2001:db8:ff:2::1/128 via 2001:db8:30:1::1 dev ens4
+    in_ns r3 ip -6 route replace 2001:db8:ff:4::1/128 via 2001:db8:40:1::2 dev ens5
+    in_ns r4 ip -6 route replace 2001:db8:ff:1::1/128 via 2001:db8:40:1::1 dev ens5
+    in_ns r4 ip -6 route replace 2001:db8:ff:2::1/128 via 2001:db8:40:1::1 dev ens5
+    in_ns r4 ip -6 route replace 2001:db8:ff:3::1/128 via 2001:db8:40:1::1 dev ens5
+
+    # SRv6 steering, forward h1->h2: R1 -> R2 -> R3 -> R4 and the reverse path
+    in_ns r1 ip -6 route replace 2001:db8:60:1::/64 encap seg6 mode encap \
+        segs 2001:db8:ff:2::1,2001:db8:ff:3::1,2001:db8:ff:4::1 dev ens5 src 2001:db8:10:1::1
+    in_ns r4 ip -6 route replace 2001:db8:10:1::/64 encap seg6 mode encap \
+        segs 2001:db8:ff:3::1,2001:db8:ff:2::1,2001:db8:ff:1::1 dev ens5 src 2001:db8:60:1::1
+
+    # Hosts
+    in_ns h1 ip -6 route replace default via 2001:db8:10:1::1 dev ens4
+    in_ns h2 ip -6 route replace default via 2001:db8:60:1::1 dev ens4
+
+    if [ -n "$GSO" ]; then
+        set_offloads
+    fi
+
+    echo "Topology is up."
+}
+
+topology_down() {
+    pot_cleanup
+    for NODE in "${NODES[@]}"; do
+        if ip netns list | grep -qw "${NS_PREFIX}${NODE}"; then
+            ip netns del "${NS_PREFIX}${NODE}"
+            echo "Namespace ${NS_PREFIX}${NODE} removed."
+        fi
+    done
+    # The key set holds the key map in use, a stale one would outlive a new key map
+    rm -f "$KEY_MAP" "$KEYSET_MAP" "$TENANTS_MAP"
+    rm -rf "$RUN_DIR" "$PIN_DIR" "$TENANT_DIR"
+}
+
+# -------------------------
+# seg6-pot-tlv
+# -------------------------
+pot_cleanup() {
+    # Only the seg6-pot-tlv instances, <node>.<iface>.pid, iperf3 keeps running
+    for PIDFILE in "${RUN_DIR}"/r?.*.pid; do
+        [ -f "$PIDFILE" ] || continue
+        kill "$(cat "$PIDFILE")" 2>/dev/null
+        while kill -0 "$(cat "$PIDFILE")" 2>/dev/null; do
+            sleep 0.1
+        done
+        rm -f "$PIDFILE"
+    done
+
+    # Removing the pins detaches the pinned links, any algorithm binary can do it
+    for NODE in "${!POT_IFACES[@]}"; do
+        if [ -d "${PIN_DIR}/${NODE}" ]; then
+            local BIN
+            BIN="$(ls "${BIN_DIR}"/seg6-pot-tlv-* 2>/dev/null | head -n 1)"
+            if [ -n "$BIN" ]; then
+                "$BIN" --unload --pin-dir "${PIN_DIR}/${NODE}" > /dev/null
+            else
+                rm -rf "${PIN_DIR:?}/${NODE}"
+            fi
+        fi
+    done
+}
+
+# Function to run one seg6-pot-tlv instance in background and wait for the attach
+attach_pot() {
+    local NODE=$1 IFACE=$2 BIN=$3
+    local NAME="${NODE}.${IFACE}"
+
+    in_ns "$NODE" nohup "$BIN" --load "$IFACE" --mode "$MODE" ${STEER_CPUS:+--cpus "$STEER_CPUS"} \
+        > "${RUN_DIR}/${NAME}.log" 2>&1 &
+    echo $! > "${RUN_DIR}/${NAME}.pid"
+
+    for _ in $(seq 1 50); do
+        if grep -q "Validator attached" "${RUN_DIR}/${NAME}.log"; then
+            echo "seg6-pot-tlv attached on ${NODE}:${IFACE}."
+            return 0
+        fi
+        if ! kill -0 "$(cat "${RUN_DIR}/${NAME}.pid")" 2>/dev/null; then
+            break
+        fi
+        sleep 0.1
+    done
+
+    echo "Error: seg6-pot-tlv failed to attach on ${NODE}:${IFACE}, see ${RUN_DIR}/${NAME}.log"
+    exit 1
+}
+
+# Function to attach one seg6-pot-tlv object to every SRv6 interface of a router and pin it
+pin_pot() {
+    local NODE=$1 BIN=$2
+    local IFACES="${POT_IFACES[$NODE]}"
+
+    in_ns "$NODE" "$BIN" --load "${IFACES// /,}" --mode "$MODE" ${STEER_CPUS:+--cpus "$STEER_CPUS"} \
+        --pin --pin-dir "${PIN_DIR}/${NODE}" > "${RUN_DIR}/${NODE}.log" 2>&1
+    if [ $? -ne 0 ]; then
+        echo "Error: seg6-pot-tlv failed to attach on ${NODE}, see ${RUN_DIR}/${NODE}.log"
+        exit 1
+    fi
+    echo "seg6-pot-tlv pinned on ${NODE}:${IFACES// /,}."
+}
+
+pot_setup() {
+    local ALGO=$1
+    local BIN="${BIN_DIR}/seg6-pot-tlv-${ALGO}"
+    validate_algo "$ALGO"
+
+    pot_cleanup
+    mkdir -p "$RUN_DIR"
+
+    echo "Using algorithm: ${ALGO}"
+    for NODE in r1 r2 r3 r4; do
+        if [ "$PIN" = "1" ]; then
+            pin_pot "$NODE" "$BIN"
+            continue
+        fi
+        for IFACE in ${POT_IFACES[$NODE]}; do
+            attach_pot "$NODE" "$IFACE" "$BIN"
+        done
+    done
+
+    # Every router pins the same map by name, loading the keys once is enough
+    for SID in "${!POT_KEYS[@]}"; do
+        "$BIN" --sid "$SID" --key "${POT_KEYS[$SID]}" || exit 1
+    done
+
+    for SID in "${!FASTPATH_SIDS[@]}"; do
+        if [ "$FASTPATH" = "1" ]; then
+            "$BIN" --local-sid "$SID" --action "${FASTPATH_SIDS[$SID]}" --table 255 || exit 1
+        else
+            "$BIN" --local-sid "$SID" --action none 2>/dev/null
+        fi
+    done
+
+    # Redirected frames only reach a veth peer running XDP or with GRO enabled
+    if [ "$FASTPATH" = "1" ]; then
+        in_ns h1 ethtool -K ens4 gro on > /dev/null
+        in_ns h2 ethtool -K ens4 gro on > /dev/null
+    fi
+}
+
+# Function to swap another build into the pinned links of every router while traffic flows
+pot_upgrade() {
+    local ALGO=$1
+    local BIN="${BIN_DIR}/seg6-pot-tlv-${ALGO}"
+    validate_algo "$ALGO"
+
+    for NODE in r1 r2 r3 r4; do
+        if [ ! -d "${PIN_DIR}/${NODE}" ]; then
+            echo "Error: nothing pinned on ${NODE}, run 'PIN=1 $0 setup <algorithm>' first."
+            exit 1
+        fi
+        in_ns "$NODE" "$BIN" --upgrade --pin-dir "${PIN_DIR}/${NODE}" ${STEER_CPUS:+--cpus "$STEER_CPUS"} \
+            >> "${RUN_DIR}/${NODE}.log" 2>&1 || exit 1
+    done
+    echo "seg6-pot-tlv upgraded to ${ALGO}."
+}
+
+# -------------------------
+# Evaluation
+# -------------------------
+collect() {
+    local LABEL=$1
+    in_ns h1 python3 "${REPO_DIR}/tests/round-trip-time/collect-round-trip-time.py" "$LABEL" \
+        --min-rtt 0 --max-rtt inf -o "${RTT_RESULTS}"
+    in_ns h1 python3 "${REPO_DIR}/tests/throughput/collect-throughput.py" "$LABEL" \
+        -o "${THROUGHPUT_RESULTS}"
+
+    # Egress needs a TLV captured from a valid path, see tests/packet-rate/README.md
+    if [ -x "${BIN_DIR}/seg6-pot-pktgen" ]; then
+        for ROLE in headend transit; do
+            python3 "${REPO_DIR}/tests/packet-rate/collect-packet-rate.py" "$LABEL" --role "$ROLE" --pktgen "${BIN_DIR}/seg6-pot-pktgen" \
+                -o "${PACKET_RATE_RESULTS}"
+        done
+    fi
+}
+
+evaluate() {
+    local ALGOS=("$@")
+    if [ ${#ALGOS[@]} -eq 0 ]; then
+        ALGOS=("${ALLOWED_ALGOS[@]}")
+    fi
+    for ALGO in "${ALGOS[@]}"; do
+        validate_algo "$ALGO"
+    done
+
+    RTT_RESULTS="${RTT_RESULTS:-${REPO_DIR}/tests/round-trip-time/results/netns}"
+    THROUGHPUT_RESULTS="${THROUGHPUT_RESULTS:-${REPO_DIR}/tests/throughput/results/netns}"
+    PACKET_RATE_RESULTS="${PACKET_RATE_RESULTS:-${REPO_DIR}/tests/packet-rate/results/netns}"
+
+    topology_up
+    mkdir -p "$RUN_DIR"
+    in_ns h2 iperf3 -s -D --pidfile "${RUN_DIR}/iperf3.pid" || exit 1
+
+    pot_cleanup
+    collect baseline
+
+    for ALGO in "${ALGOS[@]}"; do
+        pot_setup "$ALGO"
+        collect "$ALGO"
+    done
+
+    pot_cleanup
+    kill "$(cat "${RUN_DIR}/iperf3.pid")" 2>/dev/null
+
+    echo "Results saved to ${RTT_RESULTS}, ${THROUGHPUT_RESULTS} and ${PACKET_RATE_RESULTS}."
+}
+
+case "${1:-}" in
+    up)
+        topology_up
+        ;;
+    setup)
+        if [ -z "${2:-}" ]; then
+            echo "Usage: $0 setup <algorithm>"
+            echo "Available algorithms: ${ALLOWED_ALGOS[*]}"
+            exit 1
+        fi
+        pot_setup "$2"
+        ;;
+    upgrade)
+        if [ -z "${2:-}" ]; then
+            echo "Usage: PIN=1 $0 upgrade <algorithm>"
+            exit 1
+        fi
+        pot_upgrade "$2"
+        ;;
+    cleanup)
+        pot_cleanup
+        ;;
+    evaluate)
+        shift
+        evaluate "$@"
+        ;;
+    down)
+        topology_down
+        ;;
+    *)
+        echo "Usage: $0 {up|setup <algorithm>|upgrade <algorithm>|cleanup|evaluate [algorithm...]|down}"
+        exit 1
+        ;;
+esac
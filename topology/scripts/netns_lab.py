@@ -0,0 +1,53 @@
+"""Helpers shared by the collectors of tests/ that drive the LAB of netns.sh"""
+import subprocess
+import struct
+import json
+import os
+import tempfile
+
+def run_ns(netns, command):
+    if not netns:
+        return command
+    # nsenter keeps /sys/fs/bpf visible, unlike `ip netns exec`
+    return ["nsenter", f"--net=/run/netns/{netns}"] + command
+
+def link_info(netns, iface):
+    command = ["ip", "-s", "-j", "link", "show", "dev", iface]
+    if netns:
+        command = ["ip", "-n", netns] + command[1:]
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, check=True)
+    return json.loads(result.stdout)[0]
+
+def pinned_keys(loader):
+    result = subprocess.run([loader, "--keys"], stdout=subprocess.PIPE, text=True, check=True)
+    keys = {}
+    for line in result.stdout.splitlines()[1:]:
+        sid, key = line.split()
+        keys[sid] = key
+    return keys
+
+def valid_tlv(auditor, label, keys):
+    """TLV of a packet about to reach the last SID, as written by the transit nodes of the path"""
+    with tempfile.TemporaryDirectory() as tmp:
+        key_file = os.path.join(tmp, "keys.txt")
+        capture = os.path.join(tmp, "path.pcap")
+        with open(key_file, "w") as f:
+            for sid, key in keys:
+                f.write(f"{sid} {key}\n")
+        subprocess.run([auditor, "-a", label, "-k", key_file, "-g", capture, "-n", "1", "-f", "1", "-r", "0"],
+                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True)
+
+        with open(capture, "rb") as f:
+            data = f.read()
+
+    off = 24
+    while off < len(data):
+        caplen = struct.unpack_from("<I", data, off + 8)[0]
+        frame = data[off + 16:off + 16 + caplen]
+        off += 16 + caplen
+
+        srh = frame[14 + 40:]
+        if srh[3] == 0:
+            tlv = srh[8 + 16 * len(keys):]
+            return bytes(tlv[:2 + tlv[1]])
+    raise RuntimeError("no packet at the last SID in the generated capture")